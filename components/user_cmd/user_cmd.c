@@ -0,0 +1,302 @@
+#include "user_cmd.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include "user_nvs.h"
+#include "user_parser.h"
+#include "user_prof.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "user cmd"
+#define KEY_NAMES_SIZE 64 // 日志中键名列表的长度上限
+
+// 颜色类命令可被取代、可为控制命令让位；带版本号的期望状态也按颜色类排序
+#define CMD_KEYS_COLOR (NVS_KEYS_COLOR | NVS_KEY_VERSION | NVS_KEY_VALID)
+
+typedef enum
+{
+    SLOT_FREE = 0,
+    SLOT_FILLING,
+    SLOT_READY,
+    SLOT_BUSY,
+} slot_state_t;
+
+typedef struct
+{
+    uint8_t state;
+    uint8_t control;
+    uint8_t source;
+    uint16_t len;
+    uint32_t seq;
+    uint32_t keys;
+    int8_t large; // 借用的大缓冲区编号，-1 表示使用自带缓冲区
+    char *data;
+    char buf[CMD_SLOT_SIZE];
+} cmd_slot_t;
+
+static cmd_slot_t s_slots[CMD_SLOT_NUM];
+// 超过 CMD_SLOT_SIZE 的消息（如较长的灯效）从这里借用缓冲区
+static char s_large[CMD_LARGE_NUM][CONFIG_ROOMLIGHT_CMD_MAX_SIZE];
+static uint8_t s_large_used[CMD_LARGE_NUM];
+static uint32_t s_seq;
+static TaskHandle_t s_dispatch_task;
+static cmd_stats_t s_stats;
+
+static void stats_inc(uint32_t *counter) {
+    portENTER_CRITICAL();
+    (*counter)++;
+    portEXIT_CRITICAL();
+}
+
+// 在临界区内调用：释放槽位及其借用的大缓冲区
+static void slot_free_locked(cmd_slot_t *slot) {
+    if (slot->large >= 0) {
+        s_large_used[slot->large] = 0;
+        slot->large = -1;
+    }
+    slot->state = SLOT_FREE;
+}
+
+// 在临界区内调用：找空闲槽位，没有时为控制命令腾出最旧的颜色命令
+static cmd_slot_t *slot_alloc(int control) {
+    cmd_slot_t *victim = NULL;
+
+    for (int i = 0; i < CMD_SLOT_NUM; i++) {
+        if (s_slots[i].state == SLOT_FREE) {
+            return &s_slots[i];
+        }
+        if (control && s_slots[i].state == SLOT_READY && !s_slots[i].control &&
+            (victim == NULL || s_slots[i].seq < victim->seq)) {
+            victim = &s_slots[i];
+        }
+    }
+    if (victim != NULL) {
+        s_stats.evicted++;
+    }
+    return victim;
+}
+
+// 在临界区内调用：新的颜色命令覆盖了旧命令的全部键时，旧命令不再需要执行。
+// 带版本号的命令不能被取代，否则版本号不会被记录，重发时会覆盖更新的状态。
+static void slot_supersede(uint32_t keys) {
+    for (int i = 0; i < CMD_SLOT_NUM; i++) {
+        if (s_slots[i].state == SLOT_READY && !s_slots[i].control &&
+            !(s_slots[i].keys & NVS_KEY_VERSION) &&
+            (s_slots[i].keys & ~keys) == 0) {
+            slot_free_locked(&s_slots[i]);
+            s_stats.superseded++;
+        }
+    }
+}
+
+// 分配槽位和缓冲区，返回槽位编号
+static int slot_begin(cmd_source_t source, int len, int control) {
+    int large = -1;
+
+    if (len <= 0 || len > CONFIG_ROOMLIGHT_CMD_MAX_SIZE) {
+        ESP_LOGW(TAG, "Command from source %d too long: %d", source, len);
+        stats_inc(&s_stats.invalid);
+        return -1;
+    }
+
+    portENTER_CRITICAL();
+    if (len > CMD_SLOT_SIZE) {
+        for (int i = 0; i < CMD_LARGE_NUM; i++) {
+            if (!s_large_used[i]) {
+                s_large_used[i] = 1;
+                large = i;
+                break;
+            }
+        }
+    }
+    cmd_slot_t *slot = NULL;
+    if (len <= CMD_SLOT_SIZE || large >= 0) {
+        slot = slot_alloc(control);
+    }
+    if (slot != NULL) {
+        if (slot->large >= 0) {
+            s_large_used[slot->large] = 0; // 被挤掉的颜色命令
+        }
+        slot->state = SLOT_FILLING;
+        slot->large = large;
+    } else {
+        if (large >= 0) {
+            s_large_used[large] = 0;
+        }
+        s_stats.dropped++;
+    }
+    portEXIT_CRITICAL();
+
+    if (slot == NULL) {
+        ESP_LOGW(TAG, "Command queue full, dropping command");
+        return -1;
+    }
+    slot->data = large >= 0 ? s_large[large] : slot->buf;
+    slot->len = len;
+    slot->source = source;
+    slot->control = control;
+    return slot - s_slots;
+}
+
+static int keys_control(uint32_t keys) {
+    return (keys & ~CMD_KEYS_COLOR) != 0;
+}
+
+int cmd_queue_begin(cmd_source_t source, int total_len, const char *first,
+                    int first_len) {
+    int control = 0;
+    if (first != NULL && first_len > 0) {
+        control = keys_control(parse_packet_keys_prefix(first, first_len));
+    }
+    return slot_begin(source, total_len, control);
+}
+
+esp_err_t cmd_queue_append(int handle, int offset, const char *data, int len) {
+    if (handle < 0 || handle >= CMD_SLOT_NUM) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    cmd_slot_t *slot = &s_slots[handle];
+    if (slot->state != SLOT_FILLING || offset < 0 || offset + len > slot->len) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(slot->data + offset, data, len);
+    return ESP_OK;
+}
+
+void cmd_queue_abort(int handle) {
+    if (handle >= 0 && handle < CMD_SLOT_NUM &&
+        s_slots[handle].state == SLOT_FILLING) {
+        portENTER_CRITICAL();
+        s_stats.incomplete++;
+        slot_free_locked(&s_slots[handle]);
+        portEXIT_CRITICAL();
+    }
+}
+
+// keys 为整条消息的键，0 表示语法错误
+static esp_err_t slot_commit(cmd_slot_t *slot, uint32_t keys) {
+    if (keys == 0) {
+        ESP_LOGW(TAG, "Invalid command from source %d", slot->source);
+        portENTER_CRITICAL();
+        s_stats.invalid++;
+        slot_free_locked(slot);
+        portEXIT_CRITICAL();
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    portENTER_CRITICAL();
+    slot->keys = keys;
+    slot->control = keys_control(keys);
+    if (!slot->control) {
+        slot_supersede(keys);
+    }
+    slot->seq = ++s_seq;
+    slot->state = SLOT_READY;
+    s_stats.posted++;
+    portEXIT_CRITICAL();
+
+    if (s_dispatch_task != NULL) {
+        xTaskNotifyGive(s_dispatch_task);
+    }
+    return ESP_OK;
+}
+
+esp_err_t cmd_queue_commit(int handle) {
+    if (handle < 0 || handle >= CMD_SLOT_NUM ||
+        s_slots[handle].state != SLOT_FILLING) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cmd_slot_t *slot = &s_slots[handle];
+    return slot_commit(slot, parse_packet_keys(slot->data, slot->len));
+}
+
+esp_err_t cmd_queue_post(cmd_source_t source, const char *data, int len) {
+    uint32_t keys = parse_packet_keys(data, len);
+    if (keys == 0) {
+        ESP_LOGW(TAG, "Invalid command from source %d, len %d", source, len);
+        stats_inc(&s_stats.invalid);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 控制命令在队列满时可以挤掉颜色命令；已解析过的键直接用于提交
+    int handle = slot_begin(source, len, keys_control(keys));
+    if (handle < 0) {
+        return ESP_ERR_NO_MEM;
+    }
+    cmd_queue_append(handle, 0, data, len);
+    return slot_commit(&s_slots[handle], keys);
+}
+
+// 按入队顺序处理，保证后到的命令覆盖先到的；优先级只在队列满时决定挤掉谁
+static cmd_slot_t *slot_next(void) {
+    cmd_slot_t *next = NULL;
+
+    portENTER_CRITICAL();
+    for (int i = 0; i < CMD_SLOT_NUM; i++) {
+        cmd_slot_t *slot = &s_slots[i];
+        if (slot->state != SLOT_READY) {
+            continue;
+        }
+        if (next == NULL || slot->seq < next->seq) {
+            next = slot;
+        }
+    }
+    if (next != NULL) {
+        next->state = SLOT_BUSY;
+    }
+    portEXIT_CRITICAL();
+    return next;
+}
+
+static void key_name_cb(const char *key, int key_len, const char *value,
+                        int value_len, void *arg) {
+    char *names = arg;
+    int used = strlen(names);
+    int room = KEY_NAMES_SIZE - used;
+
+    // 放不下时截断，日志只用于排查
+    if (room > 2) {
+        snprintf(names + used, room, "%s%.*s", used ? "," : "", key_len, key);
+    }
+}
+
+void cmd_queue_dispatch(void) {
+    cmd_slot_t *slot;
+    while ((slot = slot_next()) != NULL) {
+        // 只记录键名，命令中可能带有 Wi-Fi 密码和局域网密钥
+        char names[KEY_NAMES_SIZE] = "";
+        parser_scan(slot->data, slot->len, key_name_cb, names);
+        ESP_LOGI(TAG, "Dispatch %s command from source %d, %d bytes: %s",
+                 slot->control ? "control" : "color", slot->source, slot->len,
+                 names);
+        parse_data_packet(slot->data, slot->len, &nvs_data);
+        portENTER_CRITICAL();
+        s_stats.dispatched++;
+        slot_free_locked(slot);
+        portEXIT_CRITICAL();
+    }
+}
+
+static void cmd_dispatch_task(void *pvParameters) {
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        prof_wakeup(PROF_TASK_CMD);
+        cmd_queue_dispatch();
+    }
+}
+
+void cmd_queue_init(void) {
+    for (int i = 0; i < CMD_SLOT_NUM; i++) {
+        s_slots[i].large = -1;
+    }
+    xTaskCreate(cmd_dispatch_task, "cmd_dispatch", 4096, NULL, 6,
+                &s_dispatch_task);
+}
+
+void cmd_queue_get_stats(cmd_stats_t *stats) {
+    portENTER_CRITICAL();
+    *stats = s_stats;
+    portEXIT_CRITICAL();
+}
@@ -0,0 +1,51 @@
+#ifndef USER_CMD_H
+#define USER_CMD_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+/*
+ * 命令队列
+ * MQTT、TCP、局域网 UDP 等输入只把数据包拷贝进预分配的槽位，由独立的分发任务解析和写 flash，
+ * 避免阻塞网络任务。命令按入队顺序处理；队列满时控制命令（重启、配网、恢复出厂）
+ * 可以挤掉最旧的颜色命令。
+ */
+
+#define CMD_SLOT_NUM 6
+#define CMD_SLOT_SIZE 256
+#define CMD_LARGE_NUM 2 // 大消息缓冲区个数，大小为 CONFIG_ROOMLIGHT_CMD_MAX_SIZE
+
+typedef enum
+{
+    CMD_SRC_MQTT = 0,
+    CMD_SRC_TCP,
+    CMD_SRC_LOCAL,
+    CMD_SRC_LAN,
+} cmd_source_t;
+
+typedef struct
+{
+    uint32_t posted;     // 入队成功
+    uint32_t dispatched; // 已处理
+    uint32_t superseded; // 被后来的同类颜色命令取代
+    uint32_t evicted;    // 队列满时为控制命令让位的颜色命令
+    uint32_t dropped;    // 队列满而丢弃
+    uint32_t invalid;    // 语法错误或超长
+    uint32_t incomplete; // 分片未收齐就被放弃
+} cmd_stats_t;
+
+void cmd_queue_init(void);
+esp_err_t cmd_queue_post(cmd_source_t source, const char *data, int len);
+// 分片消息：先按总长度申请槽位，再按偏移写入各分片，收齐后提交。
+// first 为偏移 0 的分片，用其中的键决定队列满时能否挤掉颜色命令，可为 NULL；
+// 提交时按完整消息重新分类
+int cmd_queue_begin(cmd_source_t source, int total_len, const char *first,
+                    int first_len);
+esp_err_t cmd_queue_append(int handle, int offset, const char *data, int len);
+esp_err_t cmd_queue_commit(int handle);
+void cmd_queue_abort(int handle);
+// 按入队顺序处理所有就绪的命令，由分发任务调用
+void cmd_queue_dispatch(void);
+void cmd_queue_get_stats(cmd_stats_t *stats);
+
+#endif // USER_CMD_H
@@ -0,0 +1,307 @@
+#include "user_effect.h"
+#include <string.h>
+
+/*
+ * 缓动曲线表，EFFECT_EASE_STEPS + 1 个点，Q15 (0..32768)
+ * 由 (1 - cos(pi * t)) / 2 等公式离线生成，点之间线性插值
+ */
+static const uint16_t ease_tables[EASE_MAX][EFFECT_EASE_STEPS + 1] = {
+    [EASE_IN] = {
+        0, 8, 32, 72, 128, 200, 288, 392, 512, 648,
+        800, 968, 1152, 1352, 1568, 1800, 2048, 2312, 2592, 2888,
+        3200, 3528, 3872, 4232, 4608, 5000, 5408, 5832, 6272, 6728,
+        7200, 7688, 8192, 8712, 9248, 9800, 10368, 10952, 11552, 12168,
+        12800, 13448, 14112, 14792, 15488, 16200, 16928, 17672, 18432, 19208,
+        20000, 20808, 21632, 22472, 23328, 24200, 25088, 25992, 26912, 27848,
+        28800, 29768, 30752, 31752, 32768,
+    },
+    [EASE_OUT] = {
+        0, 1016, 2016, 3000, 3968, 4920, 5856, 6776, 7680, 8568,
+        9440, 10296, 11136, 11960, 12768, 13560, 14336, 15096, 15840, 16568,
+        17280, 17976, 18656, 19320, 19968, 20600, 21216, 21816, 22400, 22968,
+        23520, 24056, 24576, 25080, 25568, 26040, 26496, 26936, 27360, 27768,
+        28160, 28536, 28896, 29240, 29568, 29880, 30176, 30456, 30720, 30968,
+        31200, 31416, 31616, 31800, 31968, 32120, 32256, 32376, 32480, 32568,
+        32640, 32696, 32736, 32760, 32768,
+    },
+    [EASE_IN_OUT] = {
+        0, 0, 4, 14, 32, 62, 108, 172, 256, 364,
+        500, 666, 864, 1098, 1372, 1688, 2048, 2456, 2916, 3430,
+        4000, 4630, 5324, 6084, 6912, 7812, 8788, 9842, 10976, 12194,
+        13500, 14896, 16384, 17872, 19268, 20574, 21792, 22926, 23980, 24956,
+        25856, 26684, 27444, 28138, 28768, 29338, 29852, 30312, 30720, 31080,
+        31396, 31670, 31904, 32102, 32268, 32404, 32512, 32596, 32660, 32706,
+        32736, 32754, 32764, 32768, 32768,
+    },
+    [EASE_SINE] = {
+        0, 20, 79, 177, 315, 491, 705, 958, 1247, 1573,
+        1935, 2331, 2761, 3224, 3719, 4244, 4799, 5381, 5990, 6624,
+        7282, 7961, 8661, 9379, 10114, 10864, 11628, 12403, 13188, 13980,
+        14778, 15580, 16384, 17188, 17990, 18788, 19580, 20365, 21140, 21904,
+        22654, 23389, 24107, 24807, 25486, 26144, 26778, 27387, 27969, 28524,
+        29049, 29544, 30007, 30437, 30833, 31195, 31521, 31810, 32063, 32277,
+        32453, 32591, 32689, 32748, 32768,
+    },
+};
+
+// t 为 Q10 进度 (0..1024)，返回 Q15 缓动值
+static int32_t ease_apply(uint8_t ease, uint32_t t) {
+    if (t >= 1024) {
+        return 32768;
+    }
+    switch (ease) {
+    case EASE_LINEAR:
+        return t << 5;
+    case EASE_STEP:
+        return 0;
+    default: {
+        const uint16_t *tab = ease_tables[ease];
+        uint32_t i = t >> 4, frac = t & 15;
+        return tab[i] + (((int32_t)tab[i + 1] - tab[i]) * (int32_t)frac >> 4);
+    }
+    }
+}
+
+static uint16_t lerp16(uint16_t from, uint16_t to, int32_t e) {
+    return from + (((int32_t)to - from) * e >> 15);
+}
+
+static int rgb_equal(const effect_rgb_t *a, const effect_rgb_t *b) {
+    return a->r == b->r && a->g == b->g && a->b == b->b;
+}
+
+void effect_init(effect_engine_t *e, effect_rgb_t initial) {
+    memset(e, 0, sizeof(*e));
+    e->current = initial;
+}
+
+int effect_start(effect_engine_t *e, const effect_timeline_t *tl,
+                 uint32_t now_ms) {
+    uint32_t total = 0;
+    if (tl->count == 0 || tl->count > EFFECT_MAX_KEYFRAMES) {
+        return -1;
+    }
+    for (int i = 0; i < tl->count; i++) {
+        total += tl->frames[i].duration_ms;
+    }
+    if (tl->loop && total == 0) {
+        return -1;
+    }
+    e->tl = *tl;
+    e->index = 0;
+    e->start_ms = now_ms;
+    e->loop_ms = total;
+    // 从当前输出颜色过渡到第一帧，效果之间可随时打断
+    e->from = e->current;
+    e->state = EFFECT_RUNNING;
+    return 0;
+}
+
+int effect_crossfade(effect_engine_t *e, effect_rgb_t target,
+                     uint16_t duration_ms, uint8_t ease, uint32_t now_ms) {
+    effect_timeline_t tl = {
+        .count = 1,
+        .loop = 0,
+        .frames = {{.duration_ms = duration_ms, .ease = ease, .color = target}},
+    };
+    return effect_start(e, &tl, now_ms);
+}
+
+void effect_stop(effect_engine_t *e) {
+    e->state = EFFECT_IDLE;
+}
+
+uint32_t effect_render(effect_engine_t *e, uint32_t now_ms, effect_rgb_t *out) {
+    const effect_keyframe_t *kf;
+    uint32_t elapsed;
+
+    if (e->state != EFFECT_RUNNING) {
+        *out = e->current;
+        return 0;
+    }
+    // 起点在未来（对齐到网格或时钟回调），先保持当前颜色
+    int32_t ahead = (int32_t)(e->start_ms - now_ms);
+    if (ahead > 0) {
+        *out = e->current;
+        return ahead;
+    }
+
+    // 跳过已经结束的关键帧
+    while (1) {
+        kf = &e->tl.frames[e->index];
+        elapsed = now_ms - e->start_ms;
+        if (elapsed < kf->duration_ms) {
+            break;
+        }
+        e->from = kf->color;
+        e->start_ms += kf->duration_ms;
+        if (++e->index >= e->tl.count) {
+            if (!e->tl.loop) {
+                e->index = e->tl.count - 1;
+                e->current = kf->color;
+                e->state = EFFECT_HOLD;
+                *out = e->current;
+                return 0;
+            }
+            e->index = 0;
+            // 回到第一帧时整圈跳过落后的时间，长时间未渲染后恢复时
+            // 最多再走一圈关键帧
+            uint32_t behind = now_ms - e->start_ms;
+            e->start_ms += behind - behind % e->loop_ms;
+        }
+    }
+
+    uint32_t remain = kf->duration_ms - elapsed;
+    if (rgb_equal(&e->from, &kf->color) || kf->ease == EASE_STEP) {
+        // 颜色不变的保持段，直接等到段末
+        e->current = e->from;
+        *out = e->current;
+        return remain;
+    }
+
+    int32_t t = ease_apply(kf->ease, (elapsed << 10) / kf->duration_ms);
+    e->current.r = lerp16(e->from.r, kf->color.r, t);
+    e->current.g = lerp16(e->from.g, kf->color.g, t);
+    e->current.b = lerp16(e->from.b, kf->color.b, t);
+    *out = e->current;
+    return remain < EFFECT_FRAME_MS ? remain : EFFECT_FRAME_MS;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// 解析 len 个十六进制字符
+static int parse_hex(const char *s, int len, uint32_t *value) {
+    *value = 0;
+    for (int i = 0; i < len; i++) {
+        int d = hex_digit(s[i]);
+        if (d < 0) {
+            return -1;
+        }
+        *value = (*value << 4) | d;
+    }
+    return 0;
+}
+
+// 超出 uint32_t 时返回 -1，避免回绕后通过调用者的范围检查
+static int parse_uint(const char *s, int len, uint32_t *value) {
+    *value = 0;
+    if (len == 0) {
+        return -1;
+    }
+    for (int i = 0; i < len; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return -1;
+        }
+        uint32_t d = s[i] - '0';
+        if (*value > (UINT32_MAX - d) / 10) {
+            return -1;
+        }
+        *value = *value * 10 + d;
+    }
+    return 0;
+}
+
+effect_rgb_t effect_rgb_from565(uint16_t c) {
+    effect_rgb_t rgb = {
+        .r = ((c >> 11) & 0x1f) * 65535 / 31,
+        .g = ((c >> 5) & 0x3f) * 65535 / 63,
+        .b = (c & 0x1f) * 65535 / 31,
+    };
+    return rgb;
+}
+
+// rrggbb 或 rrrrggggbbbb
+int effect_parse_color(const char *s, int len, effect_rgb_t *color) {
+    uint32_t r, g, b;
+
+    if (len == 6) {
+        if (parse_hex(s, 2, &r) < 0 || parse_hex(s + 2, 2, &g) < 0 ||
+            parse_hex(s + 4, 2, &b) < 0) {
+            return -1;
+        }
+        r *= 257;
+        g *= 257;
+        b *= 257;
+    } else if (len == 12) {
+        if (parse_hex(s, 4, &r) < 0 || parse_hex(s + 4, 4, &g) < 0 ||
+            parse_hex(s + 8, 4, &b) < 0) {
+            return -1;
+        }
+    } else {
+        return -1;
+    }
+    color->r = r;
+    color->g = g;
+    color->b = b;
+    return 0;
+}
+
+/*
+ * 格式：[*]ms/rrggbb[/ease];ms/rrggbb[/ease];...
+ * 开头的 '*' 表示循环；颜色也可写成 rrrrggggbbbb 的 16 位形式
+ */
+int effect_parse(const char *s, int len, effect_timeline_t *tl) {
+    int pos = 0;
+    memset(tl, 0, sizeof(*tl));
+
+    if (len > 0 && s[0] == '*') {
+        tl->loop = 1;
+        pos = 1;
+    }
+
+    while (pos < len) {
+        const char *field[3];
+        int field_len[3] = {0};
+        int n = 0;
+
+        if (tl->count >= EFFECT_MAX_KEYFRAMES) {
+            return -1;
+        }
+        field[0] = s + pos;
+        while (pos < len && s[pos] != ';') {
+            if (s[pos] == '/') {
+                if (++n >= 3) {
+                    return -1;
+                }
+                field[n] = s + pos + 1;
+            } else {
+                field_len[n]++;
+            }
+            pos++;
+        }
+        pos++;
+        if (n < 1) {
+            return -1;
+        }
+
+        effect_keyframe_t *kf = &tl->frames[tl->count];
+        uint32_t v;
+        if (parse_uint(field[0], field_len[0], &v) < 0 || v > 0xffff) {
+            return -1;
+        }
+        kf->duration_ms = v;
+
+        if (effect_parse_color(field[1], field_len[1], &kf->color) < 0) {
+            return -1;
+        }
+
+        kf->ease = EASE_LINEAR;
+        if (n == 2) {
+            if (parse_uint(field[2], field_len[2], &v) < 0 || v >= EASE_MAX) {
+                return -1;
+            }
+            kf->ease = v;
+        }
+        tl->count++;
+    }
+    return tl->count > 0 ? tl->count : -1;
+}
@@ -0,0 +1,78 @@
+#ifndef USER_EFFECT_H
+#define USER_EFFECT_H
+
+/*
+ * 关键帧灯效引擎
+ * 纯 C 实现，不依赖 FreeRTOS，时间由调用者以毫秒传入
+ */
+
+#include <stdint.h>
+
+#define EFFECT_MAX_KEYFRAMES 16
+#define EFFECT_FRAME_MS 20   // 渐变过程中的刷新间隔
+#define EFFECT_EASE_STEPS 64 // 缓动表分段数
+
+typedef enum
+{
+    EASE_LINEAR = 0,
+    EASE_IN,
+    EASE_OUT,
+    EASE_IN_OUT,
+    EASE_SINE, // 呼吸
+    EASE_STEP, // 保持起始颜色，段末跳变
+    EASE_MAX,
+} effect_ease_t;
+
+typedef enum
+{
+    EFFECT_IDLE = 0,
+    EFFECT_RUNNING,
+    EFFECT_HOLD, // 非循环效果结束，保持最后一帧
+} effect_state_t;
+
+// 每通道 16 位
+typedef struct
+{
+    uint16_t r;
+    uint16_t g;
+    uint16_t b;
+} effect_rgb_t;
+
+// 在 duration_ms 内从上一帧颜色过渡到 color
+typedef struct
+{
+    uint16_t duration_ms;
+    uint8_t ease;
+    effect_rgb_t color;
+} effect_keyframe_t;
+
+typedef struct
+{
+    uint8_t count;
+    uint8_t loop;
+    effect_keyframe_t frames[EFFECT_MAX_KEYFRAMES];
+} effect_timeline_t;
+
+typedef struct
+{
+    effect_timeline_t tl;
+    uint8_t state;
+    uint8_t index;
+    uint32_t start_ms;
+    uint32_t loop_ms; // 循环一圈的总时长
+    effect_rgb_t from;
+    effect_rgb_t current;
+} effect_engine_t;
+
+void effect_init(effect_engine_t *e, effect_rgb_t initial);
+int effect_start(effect_engine_t *e, const effect_timeline_t *tl, uint32_t now_ms);
+int effect_crossfade(effect_engine_t *e, effect_rgb_t target,
+                     uint16_t duration_ms, uint8_t ease, uint32_t now_ms);
+void effect_stop(effect_engine_t *e);
+// 返回距离下一帧的毫秒数，0 表示颜色不再变化
+uint32_t effect_render(effect_engine_t *e, uint32_t now_ms, effect_rgb_t *out);
+int effect_parse(const char *s, int len, effect_timeline_t *tl);
+int effect_parse_color(const char *s, int len, effect_rgb_t *color);
+effect_rgb_t effect_rgb_from565(uint16_t c);
+
+#endif // USER_EFFECT_H
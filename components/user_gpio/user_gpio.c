@@ -3,8 +3,11 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "user_cmd.h"
 #include "user_nvs.h"
+#include "user_gpio.h"
 #include "user_mqtt.h"
+#include "user_prof.h"
 
 #define GPIO_INPUT_IO_16 16
 #define GPIO_INPUT_PIN_SEL (1ULL << GPIO_INPUT_IO_16)
@@ -13,22 +16,37 @@
 static const char *TAG = "GPIO_Task";
 
 #define factory_reset "ssid:default,pass:default,user:default,room:default"
+// GPIO16 没有中断，只能轮询：松开时慢速轮询，按下后加快以计算长按时间
+#define GPIO_IDLE_POLL_MS 200
+#define GPIO_HELD_POLL_MS 100
+#define GPIO_RESET_HOLD_MS 2000 // 长按恢复出厂
+
 void gpio_task(void *arg) {
-    static int count = 0;
+    TickType_t pressed_at = 0;
+    int pressed = 0;
+    int reset_sent = 0;
+
     while (1) {
         if (gpio_get_level(GPIO_INPUT_IO_16)) {
-            count++;
-            if(count == 1)
+            if (!pressed) {
+                pressed = 1;
+                pressed_at = xTaskGetTickCount();
                 publish_roomlight_update(MQTT_UpdateTopic, "keydown");
-            if (count > 20) {
-                parse_data_packet(factory_reset, strlen(factory_reset),
-                                  &nvs_data);
-                parse_data_packet("reboot:1", strlen("reboot:1"), &nvs_data);
+            } else if (!reset_sent && xTaskGetTickCount() - pressed_at >=
+                                          pdMS_TO_TICKS(GPIO_RESET_HOLD_MS)) {
+                reset_sent = 1;
+                ESP_LOGW(TAG, "Key held, factory reset");
+                cmd_queue_post(CMD_SRC_LOCAL, factory_reset,
+                               strlen(factory_reset));
+                cmd_queue_post(CMD_SRC_LOCAL, "reboot:1", strlen("reboot:1"));
             }
         } else {
-            count = 0;
+            pressed = 0;
+            reset_sent = 0;
         }
-        vTaskDelay(pdMS_TO_TICKS(100)); // 100 ms
+        vTaskDelay(pdMS_TO_TICKS(pressed ? GPIO_HELD_POLL_MS
+                                         : GPIO_IDLE_POLL_MS));
+        prof_wakeup(PROF_TASK_INPUT);
     }
 }
 
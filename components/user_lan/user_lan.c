@@ -0,0 +1,206 @@
+#include "user_lan.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "mbedtls/md.h"
+#include "user_cmd.h"
+#include "user_config.h"
+#include "user_nvs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "user lan"
+
+static uint32_t s_nonce;
+static uint32_t s_last_seq;
+static lan_stats_t s_stats;
+
+// HMAC-SHA256(key, "<nonce>\n<seq>\n<payload>")，取前 8 字节转成十六进制
+static int lan_compute_tag(const uint8_t *key, uint32_t seq,
+                           const char *payload, int len,
+                           char tag[LAN_TAG_LEN + 1]) {
+    mbedtls_md_context_t ctx;
+    uint8_t digest[32];
+    char header[24];
+    int header_len = snprintf(header, sizeof(header), "%08x\n%u\n", s_nonce, seq);
+    int ret;
+
+    mbedtls_md_init(&ctx);
+    ret = mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    if (ret == 0) {
+        ret = mbedtls_md_hmac_starts(&ctx, key, CONFIG_LAN_KEY_SIZE);
+    }
+    if (ret == 0) {
+        ret = mbedtls_md_hmac_update(&ctx, (const uint8_t *)header, header_len);
+    }
+    if (ret == 0) {
+        ret = mbedtls_md_hmac_update(&ctx, (const uint8_t *)payload, len);
+    }
+    if (ret == 0) {
+        ret = mbedtls_md_hmac_finish(&ctx, digest);
+    }
+    mbedtls_md_free(&ctx);
+    if (ret != 0) {
+        return -1;
+    }
+    for (int i = 0; i < LAN_TAG_LEN / 2; i++) {
+        sprintf(tag + 2 * i, "%02x", digest[i]);
+    }
+    return 0;
+}
+
+// 逐字节比较完，耗时与第一个不同字节的位置无关
+static int lan_tag_equal(const char *a, const char *b) {
+    uint8_t diff = 0;
+    for (int i = 0; i < LAN_TAG_LEN; i++) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+static int lan_discover_reply(char *reply, int size) {
+    return snprintf(reply, size,
+                    "sn:%02x%02x%02x%02x%02x%02x,room:%s,fw:%s,nonce:%08x,"
+                    "port:%d,seq:%u",
+                    mac[0], mac[1], mac[2], mac[3], mac[4], mac[5],
+                    nvs_data.roomID, esp_ota_get_app_description()->version,
+                    s_nonce, LAN_PORT, s_last_seq);
+}
+
+// 校验 "C <seq> <tag>\n<payload>" 并入队，返回 NULL 表示成功，否则为错误原因
+static const char *lan_handle_command(char *buf, int len, uint32_t *seq_out) {
+    uint8_t key[CONFIG_LAN_KEY_SIZE];
+    char expect[LAN_TAG_LEN + 1];
+    char *end;
+
+    char *nl = memchr(buf, '\n', len);
+    if (nl == NULL || buf[1] != ' ') {
+        return "format";
+    }
+    *nl = '\0';
+    uint32_t seq = strtoul(buf + 2, &end, 10);
+    *seq_out = seq;
+    if (end == buf + 2 || *end != ' ' || strlen(end + 1) != LAN_TAG_LEN) {
+        return "format";
+    }
+    const char *tag = end + 1;
+    const char *payload = nl + 1;
+    int payload_len = buf + len - payload;
+
+    if (!config_get_lan_key(key)) {
+        return "no_key";
+    }
+    int ret = lan_compute_tag(key, seq, payload, payload_len, expect);
+    memset(key, 0, sizeof(key));
+    if (ret != 0 || !lan_tag_equal(tag, expect)) {
+        return "auth";
+    }
+    if (seq <= s_last_seq) {
+        s_stats.replayed++;
+        return "replay";
+    }
+    // 局域网只开放调光，配网、重启等控制命令仍需走云端或配网通道
+    uint32_t keys = parse_packet_keys(payload, payload_len);
+    if (!(keys & NVS_KEY_VALID) || (keys & ~(NVS_KEYS_COLOR | NVS_KEY_VALID))) {
+        return "denied";
+    }
+    // 签名通过就推进 seq，入队失败时客户端应换新 seq 重发
+    s_last_seq = seq;
+    esp_err_t err = cmd_queue_post(CMD_SRC_LAN, payload, payload_len);
+    if (err != ESP_OK) {
+        return err == ESP_ERR_NO_MEM ? "busy" : "invalid";
+    }
+    return NULL;
+}
+
+int lan_handle_request(char *buf, int len, char *reply, int size) {
+    int reply_len;
+
+    if (len == 4 && memcmp(buf, "disc", 4) == 0) {
+        s_stats.discovered++;
+        reply_len = lan_discover_reply(reply, size);
+    } else if (len >= 2 && buf[0] == 'C') {
+        uint32_t seq = 0;
+        const char *reason = lan_handle_command(buf, len, &seq);
+        if (reason == NULL) {
+            s_stats.accepted++;
+            reply_len = snprintf(reply, size, "A %u ok", seq);
+        } else {
+            s_stats.rejected++;
+            ESP_LOGW(TAG, "Command %u rejected: %s", seq, reason);
+            reply_len = snprintf(reply, size, "A %u err %s", seq, reason);
+        }
+    } else {
+        s_stats.rejected++;
+        return 0;
+    }
+    return reply_len > 0 && reply_len < size ? reply_len : 0;
+}
+
+static int lan_bind(void) {
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(LAN_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        return -1;
+    }
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
+        close(sock);
+        return -1;
+    }
+    ESP_LOGI(TAG, "Listening on UDP port %d", LAN_PORT);
+    return sock;
+}
+
+static void lan_task(void *pvParameters) {
+    static char buf[LAN_RX_SIZE + 1];
+    char reply[LAN_REPLY_SIZE];
+    int sock;
+
+    while ((sock = lan_bind()) < 0) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    while (1) {
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        int len = recvfrom(sock, buf, LAN_RX_SIZE, 0, (struct sockaddr *)&from,
+                           &from_len);
+        if (len < 0) {
+            ESP_LOGE(TAG, "recvfrom failed: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        buf[len] = '\0';
+        int reply_len = lan_handle_request(buf, len, reply, sizeof(reply));
+        if (reply_len > 0) {
+            sendto(sock, reply, reply_len, 0, (struct sockaddr *)&from,
+                   sizeof(from));
+        }
+    }
+}
+
+// 第一次获得 IP 后调用，重复调用无效
+void lan_start(void) {
+    static int started;
+
+    if (started) {
+        return;
+    }
+    started = 1;
+    s_nonce = esp_random();
+    xTaskCreate(lan_task, "lan_ctrl", 3072, NULL, 6, NULL);
+}
+
+void lan_get_stats(lan_stats_t *stats) {
+    *stats = s_stats;
+}
@@ -0,0 +1,41 @@
+#ifndef USER_LAN_H
+#define USER_LAN_H
+
+#include <stdint.h>
+
+/*
+ * 局域网 UDP 控制
+ * 联网后在 LAN_PORT 上收发单个数据报，不经过云端，用于低延迟调光。
+ *
+ * 发现：请求 "disc"，回复
+ *       "sn:<mac>,room:<roomID>,fw:<ver>,nonce:<N>,port:<P>,seq:<S>"，
+ *       可以发往广播地址。nonce 每次启动随机生成，S 为已接受的最大 seq。
+ * 控制："C <seq> <tag>\n<payload>"，payload 为原有的 "key:value,..." 格式，
+ *       只允许颜色类命令。tag 为 HMAC-SHA256(key, "<nonce>\n<seq>\n<payload>")
+ *       的前 8 字节，16 个小写十六进制字符。seq 必须大于本次启动后已接受的最大值。
+ *       回复 "A <seq> ok" 或 "A <seq> err <reason>"。
+ *       所有客户端共用同一个 seq 计数：客户端从发现回复的 S + 1 开始递增，
+ *       收到 "err replay" 说明其他客户端用过更大的 seq，重新发现后继续。
+ * 密钥只能经 MQTT 以 "lankey:<64 个十六进制字符>" 设置（配网 TCP 服务拒绝），
+ * 未设置时拒绝所有控制命令。
+ */
+
+#define LAN_PORT 3334
+#define LAN_RX_SIZE 512
+#define LAN_REPLY_SIZE 160
+#define LAN_TAG_LEN 16
+
+typedef struct
+{
+    uint32_t discovered; // 发现请求
+    uint32_t accepted;   // 通过校验并入队
+    uint32_t rejected;   // 格式、签名或权限错误
+    uint32_t replayed;   // seq 未递增
+} lan_stats_t;
+
+void lan_start(void);
+void lan_get_stats(lan_stats_t *stats);
+// 处理一个请求数据报（buf 以 '\0' 结尾，可能被改写），返回回复长度，0 表示不回复
+int lan_handle_request(char *buf, int len, char *reply, int size);
+
+#endif // USER_LAN_H
@@ -1,13 +1,23 @@
 #include "user_mqtt.h"
+#include "user_mqtt_session.h"
 #include "esp_event.h"
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_ota_ops.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "esp_tls.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "mqtt_client.h"
 #include "nvs_flash.h"
+#include "user_cmd.h"
+#include "user_net.h"
 #include "user_nvs.h"
+#include "user_prof.h"
+#include "user_publish.h"
+#include "user_shadow.h"
+#include "user_topic.h"
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -31,24 +41,242 @@ extern const uint8_t
 extern const uint8_t
     mqtt_eclipse_org_pem_end[] asm("_binary_mqtt_eclipse_org_pem_end");
 
+// 超过 MQTT 缓冲区的消息会分成多个 MQTT_EVENT_DATA 到达，按偏移拼接
+static int s_rx_handle = -1;
+
+static void mqtt_receive_fragment(esp_mqtt_event_handle_t event) {
+    if (event->current_data_offset == 0) {
+        cmd_queue_abort(s_rx_handle);
+        s_rx_handle = cmd_queue_begin(CMD_SRC_MQTT, event->total_data_len,
+                                      event->data, event->data_len);
+    }
+    if (s_rx_handle < 0) {
+        return;
+    }
+    if (cmd_queue_append(s_rx_handle, event->current_data_offset, event->data,
+                         event->data_len) != ESP_OK) {
+        cmd_queue_abort(s_rx_handle);
+        s_rx_handle = -1;
+        return;
+    }
+    if (event->current_data_offset + event->data_len >= event->total_data_len) {
+        cmd_queue_commit(s_rx_handle);
+        s_rx_handle = -1;
+    }
+}
+
+static void mqtt_reconnect_cb(void *arg) {
+    esp_mqtt_client_reconnect(client);
+}
+
+static void mqtt_handle_ctrl(esp_mqtt_event_handle_t event) {
+    mqtt_receive_fragment(event);
+}
+
+static void mqtt_publish_wakeups(void);
+
+static void mqtt_handle_get(esp_mqtt_event_handle_t event) {
+    if (event->current_data_offset == 0) {
+        shadow_report_full();
+        mqtt_publish_wakeups();
+    }
+}
+
+// 主题只出现在第一个分片里，后续分片沿用同一个处理函数
+static topic_handler_t s_rx_route;
+
+// 路由表由 MQTT 任务查询，roomID/userID 变化时由 shadow 任务重建。
+// MQTT 任务分发事件时持有客户端的 API 锁并会获取路由锁，
+// 所以持有路由锁时不能调用 esp_mqtt_client_* 接口。
+static SemaphoreHandle_t s_topic_lock;
+static int s_connected;
+// broker 会话中已订阅的房间、用户组主题，持久会话下换组时需要退订。
+// 只在 shadow 任务中访问，不需要加锁
+static char s_group_subscribed[2][TOPIC_SIZE];
+
+static void mqtt_route_data(esp_mqtt_event_handle_t event) {
+    if (event->current_data_offset == 0) {
+        if (mqtt_is_duplicate(event)) {
+            s_rx_route = NULL;
+            return;
+        }
+        xSemaphoreTake(s_topic_lock, portMAX_DELAY);
+        s_rx_route = topic_route_find(event->topic, event->topic_len);
+        xSemaphoreGive(s_topic_lock);
+        if (s_rx_route == NULL) {
+            ESP_LOGW(TAG, "No route for topic %.*s", event->topic_len,
+                     event->topic);
+        }
+    }
+    if (s_rx_route != NULL) {
+        s_rx_route(event);
+    }
+}
+
+static void mqtt_device_sn(char sn[13]) {
+    sprintf(sn, "%02x%02x%02x%02x%02x%02x", mac[0], mac[1], mac[2], mac[3],
+            mac[4], mac[5]);
+}
+
+// 第一次连接时上报启动各阶段耗时
+static void mqtt_publish_boot_profile(void) {
+    static int published;
+    char sn[13];
+    char topic[TOPIC_SIZE];
+    char record[128];
+
+    if (published) {
+        return;
+    }
+    mqtt_device_sn(sn);
+    if (topic_build(topic, sizeof(topic), TOPIC_SCOPE_DEVICE, sn, "boot") > 0 &&
+        prof_format(record, sizeof(record), esp_reset_reason()) > 0 &&
+        publish_message(topic, record, PUB_CLASS_TELEMETRY) == ESP_OK) {
+        published = 1;
+    }
+}
+
+// 各任务自上次查询以来的平均唤醒频率，随 get 请求一起上报
+static void mqtt_publish_wakeups(void) {
+    char sn[13];
+    char topic[TOPIC_SIZE];
+    char record[160];
+
+    mqtt_device_sn(sn);
+    if (topic_build(topic, sizeof(topic), TOPIC_SCOPE_DEVICE, sn, "wake") > 0 &&
+        prof_format_wakeups(record, sizeof(record)) > 0) {
+        publish_message(topic, record, PUB_CLASS_TELEMETRY);
+    }
+}
+
+// 只路由按当前 sn/roomID/userID 生成的主题和旧版控制主题，
+// 会话中残留的旧组主题不会被执行
+static void mqtt_build_routes(void) {
+    static const char *const scope[2] = {TOPIC_SCOPE_ROOM, TOPIC_SCOPE_USER};
+    const char *id[2] = {nvs_data.roomID, nvs_data.userID};
+    char sn[13];
+    char topic[TOPIC_SIZE];
+
+    mqtt_device_sn(sn);
+    topic_route_clear();
+    if (topic_build(topic, sizeof(topic), TOPIC_SCOPE_DEVICE, sn, "ctrl") > 0) {
+        topic_route_add(topic, mqtt_handle_ctrl);
+    }
+    if (topic_build(topic, sizeof(topic), TOPIC_SCOPE_DEVICE, sn, "get") > 0) {
+        topic_route_add(topic, mqtt_handle_get);
+    }
+    topic_route_add(MQTT_SubscribeTopic, mqtt_handle_ctrl);
+    for (int i = 0; i < 2; i++) {
+        if (topic_build(topic, sizeof(topic), scope[i], id[i], "ctrl") > 0) {
+            topic_route_add(topic, mqtt_handle_ctrl);
+        }
+    }
+}
+
+// 让 broker 的组订阅与 topics 一致：先退订旧主题再订阅新主题。
+// 退订失败时保留记录，下次连接后重试；resubscribe 在连接后重新订阅全部主题。
+// 不持有路由锁调用
+static void mqtt_sync_groups(char topics[2][TOPIC_SIZE], int resubscribe) {
+    int msg_id;
+
+    for (int i = 0; i < 2; i++) {
+        const char *topic = topics[i];
+        int changed = strcmp(topic, s_group_subscribed[i]) != 0;
+        if (changed && s_group_subscribed[i][0] != '\0') {
+            msg_id = esp_mqtt_client_unsubscribe(client, s_group_subscribed[i]);
+            ESP_LOGI(TAG, "Unsubscribe %s, msg_id=%d", s_group_subscribed[i],
+                     msg_id);
+            if (msg_id < 0) {
+                continue;
+            }
+            s_group_subscribed[i][0] = '\0';
+        }
+        if ((changed || resubscribe) && topic[0] != '\0') {
+            msg_id = esp_mqtt_client_subscribe(client, topic, 1);
+            ESP_LOGI(TAG, "Subscribe %s, msg_id=%d", topic, msg_id);
+            if (msg_id >= 0) {
+                strcpy(s_group_subscribed[i], topic);
+            }
+        }
+    }
+}
+
+// 订阅本设备主题和旧版控制主题，并建立路由表
+static void mqtt_subscribe_topics(esp_mqtt_client_handle_t client) {
+    char sn[13];
+    char topic[TOPIC_SIZE];
+    int msg_id;
+
+    mqtt_device_sn(sn);
+    xSemaphoreTake(s_topic_lock, portMAX_DELAY);
+    s_connected = 1;
+    mqtt_build_routes();
+    xSemaphoreGive(s_topic_lock);
+
+    if (topic_build(topic, sizeof(topic), TOPIC_SCOPE_DEVICE, sn, "#") > 0) {
+        msg_id = esp_mqtt_client_subscribe(client, topic, 1);
+        ESP_LOGI(TAG, "Subscribe %s, msg_id=%d", topic, msg_id);
+    }
+    // 旧版后台仍按原来的 QoS 0 发往这个主题
+    msg_id = esp_mqtt_client_subscribe(client, MQTT_SubscribeTopic, 0);
+    ESP_LOGI(TAG, "Subscribe %s, msg_id=%d", MQTT_SubscribeTopic, msg_id);
+    // 组主题由 shadow 任务在 shadow_on_connected 之后订阅
+}
+
+void mqtt_update_groups(int resubscribe) {
+    static const char *const scope[2] = {TOPIC_SCOPE_ROOM, TOPIC_SCOPE_USER};
+    char topics[2][TOPIC_SIZE];
+
+    if (s_topic_lock == NULL) {
+        return;
+    }
+    // 锁内只重建路由并取出期望的组主题，订阅变化在释放锁之后进行
+    xSemaphoreTake(s_topic_lock, portMAX_DELAY);
+    mqtt_build_routes();
+    const char *id[2] = {nvs_data.roomID, nvs_data.userID};
+    for (int i = 0; i < 2; i++) {
+        if (topic_build(topics[i], TOPIC_SIZE, scope[i], id[i], "ctrl") < 0) {
+            topics[i][0] = '\0';
+        }
+    }
+    int connected = s_connected;
+    xSemaphoreGive(s_topic_lock);
+
+    // 未连接时只更新路由，连接后会带 resubscribe 再调用一次
+    if (connected) {
+        mqtt_sync_groups(topics, resubscribe);
+    }
+}
+
 static esp_err_t mqtt_event_handler_cb(esp_mqtt_event_handle_t event) {
     esp_mqtt_client_handle_t client = event->client;
-    int msg_id;
 
     switch (event->event_id) {
+    case MQTT_EVENT_BEFORE_CONNECT:
+        prof_mark(PROF_MQTT_CONNECTING);
+        break;
     case MQTT_EVENT_CONNECTED:
-        dev_state = DEV_MQTT_CONNECTED;
-        ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED");
-        msg_id = esp_mqtt_client_subscribe(client, MQTT_SubscribeTopic, 0);
-        ESP_LOGI(TAG, "sent subscribe successful, msg_id=%d", msg_id);
-        char data[80];
-        sprintf(data, "userID:%s,roomID:%s", nvs_data.userID,
-                nvs_data.roomID);
-        publish_roomlight_update(MQTT_UpdateTopic, data);
+        prof_mark(PROF_MQTT_CONNECTED);
+        net_post_event(NET_EVT_MQTT_CONNECTED);
+        ESP_LOGI(TAG, "MQTT_EVENT_CONNECTED, session present %d",
+                 event->session_present);
+        mqtt_reconnect_reset();
+        mqtt_subscribe_topics(client);
+        shadow_on_connected();
+        mqtt_publish_boot_profile();
+        publish_set_connected(client);
         break;
     case MQTT_EVENT_DISCONNECTED:
-        dev_state = DEV_MQTT_CONNECTING;
+        net_post_event(NET_EVT_MQTT_DISCONNECTED);
         ESP_LOGI(TAG, "MQTT_EVENT_DISCONNECTED");
+        xSemaphoreTake(s_topic_lock, portMAX_DELAY);
+        s_connected = 0;
+        xSemaphoreGive(s_topic_lock);
+        publish_set_connected(NULL);
+        cmd_queue_abort(s_rx_handle);
+        s_rx_handle = -1;
+        s_rx_route = NULL;
+        mqtt_schedule_reconnect();
         break;
     case MQTT_EVENT_SUBSCRIBED:
         ESP_LOGI(TAG, "MQTT_EVENT_SUBSCRIBED, msg_id=%d", event->msg_id);
@@ -58,15 +286,16 @@ static esp_err_t mqtt_event_handler_cb(esp_mqtt_event_handle_t event) {
         break;
     case MQTT_EVENT_PUBLISHED:
         ESP_LOGI(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+        publish_on_ack(event->msg_id);
         break;
     case MQTT_EVENT_DATA:
-        ESP_LOGI(TAG, "MQTT_EVENT_DATA");
-        printf("TOPIC=%.*s\r\n", event->topic_len, event->topic);
-        printf("DATA=%.*s\r\n", event->data_len, event->data);
-        parse_data_packet(event->data, event->data_len, &nvs_data);
+        // 只记录长度，主题带序列号，消息中可能有 Wi-Fi 密码和局域网密钥
+        ESP_LOGD(TAG, "MQTT_EVENT_DATA topic_len=%d offset=%d total=%d",
+                 event->topic_len, event->current_data_offset,
+                 event->total_data_len);
+        mqtt_route_data(event);
         break;
     case MQTT_EVENT_ERROR:
-        dev_state = DEV_MQTT_CONNECTING;
         ESP_LOGI(TAG, "MQTT_EVENT_ERROR");
         if (event->error_handle->error_type == MQTT_ERROR_TYPE_ESP_TLS) {
             ESP_LOGI(TAG, "Last error code reported from esp-tls: 0x%x",
@@ -97,6 +326,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
 }
 
 void mqtt_app_start(void) {
+    prof_mark(PROF_MQTT_START);
     ESP_LOGI(TAG, "[APP] Startup..");
     ESP_LOGI(TAG, "[APP] Free memory: %d bytes", esp_get_free_heap_size());
     ESP_LOGI(TAG, "[APP] IDF version: %s", esp_get_idf_version());
@@ -121,10 +351,16 @@ void mqtt_app_start(void) {
         .client_id = user_client_ID,
         .username = user_name,
         .password = device_secret,
+        // client_id 由 MAC 生成保持不变，broker 据此保留会话和订阅
+        .disable_clean_session = true,
+        .disable_auto_reconnect = true,
         // .cert_pem = (const char *)mqtt_eclipse_org_pem_start,
     };
 
     ESP_LOGI(TAG, "[APP] Free memory: %d bytes", esp_get_free_heap_size());
+    s_topic_lock = xSemaphoreCreateMutex();
+    shadow_init();
+    ESP_ERROR_CHECK(mqtt_reconnect_init(mqtt_reconnect_cb));
     client = esp_mqtt_client_init(&mqtt_cfg);
     esp_mqtt_client_register_event(client, ESP_EVENT_ANY_ID, mqtt_event_handler,
                                    client);
@@ -132,16 +368,7 @@ void mqtt_app_start(void) {
 }
 
 
+// 兼容旧接口：按事件类消息交给发布队列，按顺序限速发送
 void publish_roomlight_update(const char *topic , const char *data) {
-    if (client == NULL) {
-        ESP_LOGE(TAG, "MQTT client is not initialized");
-        return;
-    }
-
-    int msg_id = esp_mqtt_client_publish(client, topic, data, 0, 1, 0);
-    if (msg_id == -1) {
-        ESP_LOGE(TAG, "Failed to publish message");
-    } else {
-        ESP_LOGI(TAG, "Published message, msg_id=%d", msg_id);
-    }
-}
\ No newline at end of file
+    publish_message(topic, data, PUB_CLASS_EVENT);
+}
@@ -2,14 +2,21 @@
 #define USER_MQTT_H
 
     
+// 旧版固件的控制主题，迁移期间继续订阅，收到的命令按设备控制主题处理
 #define MQTT_SubscribeTopic "roomlight/sn/ctrl"
 #define MQTT_UpdateTopic "roomlight/update"
+#define MQTT_BACKOFF_MIN_MS 1000  // 重连退避初始值
+#define MQTT_BACKOFF_MAX_MS 60000 // 重连退避上限
+#define MQTT_DEDUP_NUM 8          // 记住的最近 QoS 1 报文数
 
 // TOPIC1   CTRL    TOPIC2   CTRLACK
 // TOPIC3   SYN     TOPIC4   SYNACK
 // TOPIC5   DATA    TOPIC6   DATAACK
 void mqtt_app_start(void);
 void publish_roomlight_update(const char *topic , const char *data);
+// 由 shadow 任务在 roomID/userID 变化后或 MQTT 连接后调用：重建路由，
+// 退订旧的组主题并订阅新主题；resubscribe 非 0 时重新订阅全部组主题
+void mqtt_update_groups(int resubscribe);
 
 typedef struct 
 {
@@ -0,0 +1,82 @@
+#include "user_mqtt_session.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "user_mqtt.h"
+
+#define TAG "mqtt session"
+
+// 持久会话下 broker 会重发未确认的 QoS 1 消息，按报文 ID 和内容摘要去重。
+// broker 会循环复用报文 ID，只比较 ID 可能误判。
+typedef struct
+{
+    int msg_id;
+    uint32_t digest;
+} mqtt_seen_t;
+
+static mqtt_seen_t s_seen[MQTT_DEDUP_NUM];
+static int s_seen_next;
+static uint32_t s_duplicates;
+
+int mqtt_is_duplicate(esp_mqtt_event_handle_t event) {
+    if (event->msg_id == 0) {
+        return 0; // QoS 0 没有报文 ID
+    }
+    uint32_t digest = 2166136261u ^ event->total_data_len;
+    for (int i = 0; i < event->topic_len; i++) {
+        digest = (digest ^ (uint8_t)event->topic[i]) * 16777619u;
+    }
+    for (int i = 0; i < event->data_len; i++) {
+        digest = (digest ^ (uint8_t)event->data[i]) * 16777619u;
+    }
+    for (int i = 0; i < MQTT_DEDUP_NUM; i++) {
+        if (s_seen[i].msg_id == event->msg_id && s_seen[i].digest == digest) {
+            s_duplicates++;
+            ESP_LOGW(TAG, "Duplicate msg_id=%d dropped (%u total)",
+                     event->msg_id, s_duplicates);
+            return 1;
+        }
+    }
+    s_seen[s_seen_next].msg_id = event->msg_id;
+    s_seen[s_seen_next].digest = digest;
+    s_seen_next = (s_seen_next + 1) % MQTT_DEDUP_NUM;
+    return 0;
+}
+
+uint32_t mqtt_duplicate_count(void) {
+    return s_duplicates;
+}
+
+// 断线后按指数退避重连，不再重启设备，会话和 outbox 得以保留
+static esp_timer_handle_t s_reconnect_timer;
+static int s_reconnect_attempts;
+
+uint32_t mqtt_backoff_ms(int attempt) {
+    int shift = attempt < 16 ? attempt : 16;
+    uint32_t delay = MQTT_BACKOFF_MIN_MS << shift;
+    if (delay > MQTT_BACKOFF_MAX_MS) {
+        delay = MQTT_BACKOFF_MAX_MS;
+    }
+    // 随机抖动，避免大量设备同时重连
+    return delay / 2 + esp_random() % (delay / 2 + 1);
+}
+
+esp_err_t mqtt_reconnect_init(esp_timer_cb_t cb) {
+    const esp_timer_create_args_t timer_args = {
+        .callback = cb,
+        .name = "mqtt_reconnect",
+    };
+    return esp_timer_create(&timer_args, &s_reconnect_timer);
+}
+
+uint32_t mqtt_schedule_reconnect(void) {
+    uint32_t delay = mqtt_backoff_ms(s_reconnect_attempts);
+    s_reconnect_attempts++;
+    ESP_LOGI(TAG, "Reconnect attempt %d in %u ms", s_reconnect_attempts, delay);
+    esp_timer_stop(s_reconnect_timer);
+    esp_timer_start_once(s_reconnect_timer, delay * 1000ULL);
+    return delay;
+}
+
+void mqtt_reconnect_reset(void) {
+    s_reconnect_attempts = 0;
+}
@@ -0,0 +1,27 @@
+#ifndef USER_MQTT_SESSION_H
+#define USER_MQTT_SESSION_H
+
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "mqtt_client.h"
+#include <stdint.h>
+
+/*
+ * 持久会话的接收去重和断线重连退避
+ * 不依赖 socket 和 MQTT 客户端，可以在主机上测试
+ */
+
+// 对消息的第一个分片调用，是 broker 重发的 QoS 1 消息时返回 1 并计数
+int mqtt_is_duplicate(esp_mqtt_event_handle_t event);
+uint32_t mqtt_duplicate_count(void);
+
+// 第 attempt 次（从 0 开始）重连前的等待：指数增长并封顶，再取 [d/2, d] 内的随机值
+uint32_t mqtt_backoff_ms(int attempt);
+// 退避到期时在 esp_timer 任务中调用 cb
+esp_err_t mqtt_reconnect_init(esp_timer_cb_t cb);
+// 按已尝试的次数启动退避定时器，返回等待的毫秒数
+uint32_t mqtt_schedule_reconnect(void);
+// 连接成功后调用，退避从初始值重新开始
+void mqtt_reconnect_reset(void);
+
+#endif // USER_MQTT_SESSION_H
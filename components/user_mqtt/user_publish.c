@@ -0,0 +1,314 @@
+#include "user_publish.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "mqtt_client.h"
+#include "sdkconfig.h"
+#include "user_mqtt.h"
+#include "user_prof.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "user publish"
+
+#define PUB_TOKEN_UNIT 1000 // 令牌以千分之一为单位累加
+
+typedef struct
+{
+    uint8_t used;
+    uint8_t cls;
+    uint32_t seq; // 入队顺序，事件按此先进先出
+    char topic[PUB_TOPIC_SIZE];
+    char data[PUB_DATA_SIZE];
+} pub_entry_t;
+
+typedef struct
+{
+    char key[PUB_FIELD_KEY_SIZE];
+    char value[PUB_FIELD_VALUE_SIZE];
+    uint8_t dirty;
+} pub_field_t;
+
+static const int CLASS_QOS[PUB_CLASS_MAX] = {
+    [PUB_CLASS_EVENT] = 1,
+    [PUB_CLASS_STATE] = 0,
+    [PUB_CLASS_TELEMETRY] = 0,
+};
+
+static pub_entry_t s_entries[PUB_ENTRY_NUM];
+static uint32_t s_entry_seq;
+// 状态字段合并成一条 "key:value,..." 报告发往 MQTT_UpdateTopic
+static pub_field_t s_fields[PUB_FIELD_NUM];
+static int s_fields_dirty;
+static int64_t s_fields_due_ms;
+// 每条报告开头的设备标识 "key:value"，所有设备共用同一个报告主题
+static char s_report_id[PUB_FIELD_KEY_SIZE + PUB_FIELD_VALUE_SIZE];
+
+static SemaphoreHandle_t s_pub_lock;
+static TaskHandle_t s_pub_task;
+static esp_mqtt_client_handle_t s_client;
+static uint32_t s_tokens = PUB_BUCKET_SIZE * PUB_TOKEN_UNIT;
+static int64_t s_refill_ms;
+// 已发出、等待 PUBACK 的 QoS 1 报文 ID，0 表示空闲；满时覆盖最旧的
+static int s_unacked[PUB_ACK_NUM];
+static int s_unacked_next;
+// 统计只在 s_pub_lock 内修改，publish_get_stats 在同一把锁内读取
+static pub_stats_t s_stats;
+
+static int64_t now_ms(void) {
+    return esp_timer_get_time() / 1000;
+}
+
+static void bucket_refill(int64_t now) {
+    int64_t add = (now - s_refill_ms) * CONFIG_ROOMLIGHT_PUBLISH_RATE;
+    s_refill_ms = now;
+    if (add >= PUB_BUCKET_SIZE * PUB_TOKEN_UNIT - s_tokens) {
+        s_tokens = PUB_BUCKET_SIZE * PUB_TOKEN_UNIT;
+    } else {
+        s_tokens += add;
+    }
+}
+
+static void publish_wake(void) {
+    if (s_pub_task != NULL) {
+        xTaskNotifyGive(s_pub_task);
+    }
+}
+
+esp_err_t publish_message(const char *topic, const char *data, pub_class_t cls) {
+    pub_entry_t *slot = NULL;
+
+    // 事件是 QoS 1，每一条都要送达，不与同主题的消息合并
+    xSemaphoreTake(s_pub_lock, portMAX_DELAY);
+    if (cls >= PUB_CLASS_MAX || cls == PUB_CLASS_STATE ||
+        strlen(topic) >= PUB_TOPIC_SIZE || strlen(data) >= PUB_DATA_SIZE) {
+        s_stats.dropped++;
+        xSemaphoreGive(s_pub_lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < PUB_ENTRY_NUM; i++) {
+        if (!s_entries[i].used) {
+            slot = &s_entries[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        s_stats.dropped++;
+        xSemaphoreGive(s_pub_lock);
+        ESP_LOGW(TAG, "Publish buffer full, dropping %s", topic);
+        return ESP_ERR_NO_MEM;
+    }
+    slot->used = 1;
+    slot->cls = cls;
+    slot->seq = s_entry_seq++;
+    strcpy(slot->topic, topic);
+    strcpy(slot->data, data);
+    xSemaphoreGive(s_pub_lock);
+
+    publish_wake();
+    return ESP_OK;
+}
+
+esp_err_t publish_field(const char *key, const char *value) {
+    pub_field_t *field = NULL;
+
+    xSemaphoreTake(s_pub_lock, portMAX_DELAY);
+    if (strlen(key) >= PUB_FIELD_KEY_SIZE ||
+        strlen(value) >= PUB_FIELD_VALUE_SIZE) {
+        s_stats.dropped++;
+        xSemaphoreGive(s_pub_lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < PUB_FIELD_NUM; i++) {
+        if (strcmp(s_fields[i].key, key) == 0) {
+            field = &s_fields[i];
+            break;
+        }
+        if (s_fields[i].key[0] == '\0' && field == NULL) {
+            field = &s_fields[i];
+        }
+    }
+    if (field == NULL) {
+        s_stats.dropped++;
+        xSemaphoreGive(s_pub_lock);
+        ESP_LOGW(TAG, "No room for state field %s", key);
+        return ESP_ERR_NO_MEM;
+    }
+    if (field->dirty) {
+        s_stats.suppressed++;
+    }
+    strcpy(field->key, key);
+    strcpy(field->value, value);
+    field->dirty = 1;
+    if (!s_fields_dirty) {
+        s_fields_dirty = 1;
+        s_fields_due_ms = now_ms() + CONFIG_ROOMLIGHT_PUBLISH_COALESCE_MS;
+    }
+    xSemaphoreGive(s_pub_lock);
+
+    publish_wake();
+    return ESP_OK;
+}
+
+esp_err_t publish_set_report_id(const char *key, const char *value) {
+    if (strlen(key) >= PUB_FIELD_KEY_SIZE ||
+        strlen(value) >= PUB_FIELD_VALUE_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(s_pub_lock, portMAX_DELAY);
+    snprintf(s_report_id, sizeof(s_report_id), "%s:%s", key, value);
+    xSemaphoreGive(s_pub_lock);
+    return ESP_OK;
+}
+
+// 在锁内调用：把变化的字段拼成一条报告，放不下的字段留到下一条，
+// 每一条都以设备标识开头
+static int fields_build(char *buf, int size) {
+    int len = snprintf(buf, size, "%s", s_report_id);
+
+    for (int i = 0; i < PUB_FIELD_NUM; i++) {
+        pub_field_t *field = &s_fields[i];
+        if (!field->dirty) {
+            continue;
+        }
+        int n = snprintf(buf + len, size - len, "%s%s:%s", len ? "," : "",
+                         field->key, field->value);
+        if (n >= size - len) {
+            break;
+        }
+        len += n;
+        field->dirty = 0;
+    }
+    s_fields_dirty = 0;
+    for (int i = 0; i < PUB_FIELD_NUM; i++) {
+        if (s_fields[i].dirty) {
+            s_fields_dirty = 1;
+        }
+    }
+    return len;
+}
+
+TickType_t publish_service(void) {
+    char topic[PUB_TOPIC_SIZE];
+    char data[PUB_DATA_SIZE];
+
+    while (1) {
+        int64_t now = now_ms();
+        int64_t due = INT64_MAX;
+        pub_entry_t *entry = NULL;
+        int qos;
+
+        if (s_client == NULL) {
+            return portMAX_DELAY; // 连接后 publish_set_connected 会唤醒
+        }
+
+        xSemaphoreTake(s_pub_lock, portMAX_DELAY);
+        for (int i = 0; i < PUB_ENTRY_NUM; i++) {
+            if (s_entries[i].used &&
+                (entry == NULL || (int32_t)(s_entries[i].seq - entry->seq) < 0)) {
+                entry = &s_entries[i];
+            }
+        }
+        if (entry != NULL) {
+            due = now; // 队列中的消息立即发送，只受令牌桶限制
+        }
+        int fields = s_fields_dirty && s_fields_due_ms < due;
+        if (fields) {
+            due = s_fields_due_ms;
+        }
+        if (due == INT64_MAX) {
+            xSemaphoreGive(s_pub_lock);
+            return portMAX_DELAY;
+        }
+        if (due > now) {
+            xSemaphoreGive(s_pub_lock);
+            return pdMS_TO_TICKS(due - now) + 1;
+        }
+        bucket_refill(now);
+        if (s_tokens < PUB_TOKEN_UNIT) {
+            s_stats.throttled++;
+            xSemaphoreGive(s_pub_lock);
+            uint32_t wait = (PUB_TOKEN_UNIT - s_tokens) /
+                                CONFIG_ROOMLIGHT_PUBLISH_RATE + 1;
+            return pdMS_TO_TICKS(wait) + 1;
+        }
+        s_tokens -= PUB_TOKEN_UNIT;
+
+        if (fields) {
+            strcpy(topic, MQTT_UpdateTopic);
+            fields_build(data, sizeof(data));
+            qos = CLASS_QOS[PUB_CLASS_STATE];
+        } else {
+            strcpy(topic, entry->topic);
+            strcpy(data, entry->data);
+            qos = CLASS_QOS[entry->cls];
+            entry->used = 0;
+        }
+        xSemaphoreGive(s_pub_lock);
+
+        int msg_id = esp_mqtt_client_publish(s_client, topic, data, 0, qos, 0);
+        xSemaphoreTake(s_pub_lock, portMAX_DELAY);
+        if (msg_id == -1) {
+            s_stats.dropped++;
+        } else {
+            s_stats.sent++;
+            if (qos > 0 && msg_id > 0) {
+                s_unacked[s_unacked_next] = msg_id;
+                s_unacked_next = (s_unacked_next + 1) % PUB_ACK_NUM;
+            }
+        }
+        xSemaphoreGive(s_pub_lock);
+        if (msg_id == -1) {
+            ESP_LOGE(TAG, "Failed to publish message to %s", topic);
+        } else {
+            ESP_LOGI(TAG, "Published %s (qos %d, msg_id=%d): %s", topic, qos,
+                     msg_id, data);
+        }
+    }
+}
+
+static void publish_task(void *pvParameters) {
+    TickType_t wait = portMAX_DELAY;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, wait);
+        prof_wakeup(PROF_TASK_PUBLISH);
+        wait = publish_service();
+    }
+}
+
+void publish_init(void) {
+    s_pub_lock = xSemaphoreCreateMutex();
+    s_refill_ms = now_ms();
+    xTaskCreate(publish_task, "mqtt_publish", 3072, NULL, 5, &s_pub_task);
+}
+
+// 断开期间消息保留在缓冲区里，连上后按令牌桶速率补发
+void publish_set_connected(esp_mqtt_client_handle_t client) {
+    s_client = client;
+    publish_wake();
+}
+
+// 只统计本模块发出的 QoS 1 消息，其他模块的发布和重复的 PUBACK 不计入
+void publish_on_ack(int msg_id) {
+    if (msg_id <= 0) {
+        return;
+    }
+    xSemaphoreTake(s_pub_lock, portMAX_DELAY);
+    for (int i = 0; i < PUB_ACK_NUM; i++) {
+        if (s_unacked[i] == msg_id) {
+            s_unacked[i] = 0;
+            s_stats.acked++;
+            break;
+        }
+    }
+    xSemaphoreGive(s_pub_lock);
+}
+
+void publish_get_stats(pub_stats_t *stats) {
+    xSemaphoreTake(s_pub_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_pub_lock);
+}
@@ -0,0 +1,47 @@
+#ifndef USER_PUBLISH_H
+#define USER_PUBLISH_H
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "mqtt_client.h"
+#include <stdint.h>
+
+#define PUB_ENTRY_NUM 6      // 待发送的事件/遥测消息
+#define PUB_TOPIC_SIZE 48
+#define PUB_DATA_SIZE 256
+#define PUB_FIELD_NUM 12     // 合并进状态报告的字段数
+#define PUB_FIELD_KEY_SIZE 12
+#define PUB_FIELD_VALUE_SIZE 40
+#define PUB_BUCKET_SIZE 4    // 令牌桶容量，即允许的突发条数
+#define PUB_ACK_NUM 8        // 记录的未确认 QoS 1 报文 ID 数
+
+// 消息类别决定 QoS 和合并方式
+typedef enum
+{
+    PUB_CLASS_EVENT = 0, // 按键等事件，QoS 1，先进先出，逐条发送
+    PUB_CLASS_STATE,     // 状态字段，QoS 0，按字段合并为一条报告
+    PUB_CLASS_TELEMETRY, // 遥测，QoS 0，与事件同一队列
+    PUB_CLASS_MAX,
+} pub_class_t;
+
+typedef struct
+{
+    uint32_t sent;       // 交给 MQTT 客户端的消息
+    uint32_t suppressed; // 被合并或覆盖而未单独发送的更新
+    uint32_t acked;      // 收到 PUBACK 且报文 ID 匹配的 QoS 1 消息
+    uint32_t dropped;    // 缓冲区满或超长而丢弃
+    uint32_t throttled;  // 因令牌不足推迟发送的次数
+} pub_stats_t;
+
+void publish_init(void);
+void publish_set_connected(esp_mqtt_client_handle_t client);
+esp_err_t publish_message(const char *topic, const char *data, pub_class_t cls);
+esp_err_t publish_field(const char *key, const char *value);
+// 设置每条状态报告都带上的标识字段，如 sn
+esp_err_t publish_set_report_id(const char *key, const char *value);
+void publish_on_ack(int msg_id);
+void publish_get_stats(pub_stats_t *stats);
+// 发出所有到期的消息，返回下次需要醒来的等待节拍数，由发送任务调用
+TickType_t publish_service(void);
+
+#endif // USER_PUBLISH_H
@@ -0,0 +1,146 @@
+#include "user_shadow.h"
+#include "esp_log.h"
+#include "esp_ota_ops.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "user_config.h"
+#include "user_mqtt.h"
+#include "user_nvs.h"
+#include "user_prof.h"
+#include "user_publish.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "user shadow"
+
+#define SHADOW_NOTIFY_FULL (1UL << 31)      // 上报完整状态
+#define SHADOW_NOTIFY_CONNECTED (1UL << 30) // MQTT 连接后重新订阅组主题
+
+// 设备影子：连接后上报完整的 reported 文档，之后只上报变化的字段。
+// 字段经 publish_field 合并成一条 "key:value,..." 报告，每条报告都以 sn 开头，
+// 共用的 MQTT_UpdateTopic 上由此区分设备。
+typedef void (*shadow_getter_t)(char *buf, int size, int arg);
+
+static void get_nvs_field(char *buf, int size, int field) {
+    snprintf(buf, size, "%s", NVS_FIELD_PTR(&nvs_data, field));
+}
+
+static void get_serial(char *buf, int size, int arg) {
+    snprintf(buf, size, "%02x%02x%02x%02x%02x%02x", mac[0], mac[1], mac[2],
+             mac[3], mac[4], mac[5]);
+}
+
+static void get_version(char *buf, int size, int arg) {
+    snprintf(buf, size, "%u", nvs_desired_version());
+}
+
+static void get_firmware(char *buf, int size, int arg) {
+    snprintf(buf, size, "%s", esp_ota_get_app_description()->version);
+}
+
+static void get_rssi(char *buf, int size, int arg) {
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+        snprintf(buf, size, "%d", ap.rssi);
+    } else {
+        buf[0] = '\0';
+    }
+}
+
+static const struct {
+    const char *key;
+    shadow_getter_t get;
+    int arg;
+} FIELDS[] = {
+    {"userID", get_nvs_field, NVS_FIELD_USERID},
+    {"roomID", get_nvs_field, NVS_FIELD_ROOMID},
+    {NVS_Version, get_version, 0},
+    {"fw", get_firmware, 0},
+    {"rssi", get_rssi, 0},
+    {NVS_LightNormal, get_nvs_field, NVS_FIELD_LIGHT_NORMAL},
+    {NVS_LightPeriod, get_nvs_field, NVS_FIELD_LIGHT_PERIOD},
+    {NVS_LightSwitch1, get_nvs_field, NVS_FIELD_LIGHT_SWITCH1},
+    {NVS_LightSwitch2, get_nvs_field, NVS_FIELD_LIGHT_SWITCH2},
+    {NVS_LightSwitch3, get_nvs_field, NVS_FIELD_LIGHT_SWITCH3},
+};
+#define FIELD_NUM (sizeof(FIELDS) / sizeof(FIELDS[0]))
+
+// 最后一次上报的值，用于计算增量
+static char s_reported[FIELD_NUM][SHADOW_VALUE_SIZE];
+static TaskHandle_t s_shadow_task;
+
+static int shadow_changed(int i, const char *value) {
+    if (FIELDS[i].get == get_rssi && value[0] != '\0' &&
+        s_reported[i][0] != '\0') {
+        // RSSI 抖动不上报
+        return abs(atoi(value) - atoi(s_reported[i])) >= SHADOW_RSSI_STEP;
+    }
+    return strcmp(value, s_reported[i]) != 0;
+}
+
+static void shadow_report(int full) {
+    char value[SHADOW_VALUE_SIZE];
+    int count = 0;
+
+    for (int i = 0; i < FIELD_NUM; i++) {
+        FIELDS[i].get(value, sizeof(value), FIELDS[i].arg);
+        if (!full && !shadow_changed(i, value)) {
+            continue;
+        }
+        if (publish_field(FIELDS[i].key, value) == ESP_OK) {
+            strcpy(s_reported[i], value);
+            count++;
+        }
+    }
+    if (count > 0) {
+        ESP_LOGI(TAG, "Reported %d %s", count,
+                 full ? "fields (full)" : "changed fields");
+    }
+}
+
+static void shadow_task(void *pvParameters) {
+    uint32_t notify;
+    char sn[13];
+
+    get_serial(sn, sizeof(sn), 0);
+    publish_set_report_id("sn", sn);
+    config_subscribe(xTaskGetCurrentTaskHandle());
+    while (1) {
+        notify = 0;
+        xTaskNotifyWait(0, ULONG_MAX, &notify,
+                        pdMS_TO_TICKS(SHADOW_RSSI_PERIOD_MS));
+        prof_wakeup(PROF_TASK_SHADOW);
+        // 订阅在本任务中进行，MQTT 任务分发事件时不会被阻塞
+        if (notify & SHADOW_NOTIFY_CONNECTED) {
+            mqtt_update_groups(1);
+        } else if (notify & (CONFIG_NOTIFY_FIELD(NVS_FIELD_ROOMID) |
+                             CONFIG_NOTIFY_FIELD(NVS_FIELD_USERID))) {
+            mqtt_update_groups(0);
+        }
+        // 完整上报由 MQTT 连接事件触发，不依赖 dev_state 的更新先后
+        if (!(notify & SHADOW_NOTIFY_FULL) && dev_state != DEV_MQTT_CONNECTED) {
+            continue; // 重连后会上报完整状态
+        }
+        shadow_report(notify & SHADOW_NOTIFY_FULL);
+    }
+}
+
+void shadow_init(void) {
+    xTaskCreate(shadow_task, "mqtt_shadow", 2048, NULL, 4, &s_shadow_task);
+}
+
+void shadow_report_full(void) {
+    if (s_shadow_task != NULL) {
+        xTaskNotify(s_shadow_task, SHADOW_NOTIFY_FULL, eSetBits);
+    }
+}
+
+void shadow_on_connected(void) {
+    if (s_shadow_task != NULL) {
+        xTaskNotify(s_shadow_task, SHADOW_NOTIFY_CONNECTED | SHADOW_NOTIFY_FULL,
+                    eSetBits);
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef USER_SHADOW_H
+#define USER_SHADOW_H
+
+#define SHADOW_VALUE_SIZE 32
+#define SHADOW_RSSI_PERIOD_MS 60000 // RSSI 采样周期
+#define SHADOW_RSSI_STEP 4          // RSSI 变化超过该值(dBm)才上报
+
+void shadow_init(void);
+void shadow_report_full(void);
+// MQTT 连接后调用：同步组订阅并上报完整状态
+void shadow_on_connected(void);
+
+#endif // USER_SHADOW_H
@@ -0,0 +1,81 @@
+#include "user_topic.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "user topic"
+
+typedef struct
+{
+    char filter[TOPIC_SIZE];
+    topic_handler_t handler;
+} topic_route_t;
+
+static topic_route_t s_routes[TOPIC_ROUTE_NUM];
+static int s_route_num;
+
+// MQTT 主题过滤器匹配："+" 匹配一级，"#" 只能在末尾，匹配剩余所有层级。
+// topic 不要求以 '\0' 结尾。
+int topic_match(const char *filter, const char *topic, int topic_len) {
+    const char *end = topic + topic_len;
+
+    while (*filter != '\0') {
+        if (filter[0] == '#') {
+            return filter[1] == '\0';
+        }
+        if (filter[0] == '+') {
+            while (topic < end && *topic != '/') {
+                topic++;
+            }
+            filter++;
+        } else {
+            if (topic >= end || *topic != *filter) {
+                return 0;
+            }
+            topic++;
+            filter++;
+        }
+        // "a/#" 同样匹配 "a"
+        if (topic == end && filter[0] == '/' && filter[1] == '#' &&
+            filter[2] == '\0') {
+            return 1;
+        }
+    }
+    return topic == end;
+}
+
+// id 中不能出现层级分隔符或通配符，未配置的 "default" 也视为无效
+int topic_build(char *buf, int size, const char *scope, const char *id,
+                const char *leaf) {
+    if (id[0] == '\0' || strcmp(id, "default") == 0 ||
+        strpbrk(id, "/+#") != NULL) {
+        return -1;
+    }
+    int len = snprintf(buf, size, TOPIC_PREFIX "/%s/%s/%s", scope, id, leaf);
+    return (len < size) ? len : -1;
+}
+
+void topic_route_clear(void) {
+    s_route_num = 0;
+}
+
+esp_err_t topic_route_add(const char *filter, topic_handler_t handler) {
+    if (s_route_num >= TOPIC_ROUTE_NUM || strlen(filter) >= TOPIC_SIZE) {
+        ESP_LOGE(TAG, "No room for route %s", filter);
+        return ESP_ERR_NO_MEM;
+    }
+    strcpy(s_routes[s_route_num].filter, filter);
+    s_routes[s_route_num].handler = handler;
+    s_route_num++;
+    return ESP_OK;
+}
+
+// 按添加顺序匹配，先添加的路由优先
+topic_handler_t topic_route_find(const char *topic, int topic_len) {
+    for (int i = 0; i < s_route_num; i++) {
+        if (topic_match(s_routes[i].filter, topic, topic_len)) {
+            return s_routes[i].handler;
+        }
+    }
+    return NULL;
+}
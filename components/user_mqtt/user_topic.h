@@ -0,0 +1,25 @@
+#ifndef USER_TOPIC_H
+#define USER_TOPIC_H
+
+#include "esp_err.h"
+#include "mqtt_client.h"
+
+#define TOPIC_PREFIX "roomlight"
+#define TOPIC_SIZE 64
+#define TOPIC_ROUTE_NUM 6
+
+// 主题层级：roomlight/<dev|room|user>/<id>/<leaf>
+#define TOPIC_SCOPE_DEVICE "dev"
+#define TOPIC_SCOPE_ROOM "room"
+#define TOPIC_SCOPE_USER "user"
+
+typedef void (*topic_handler_t)(esp_mqtt_event_handle_t event);
+
+int topic_match(const char *filter, const char *topic, int topic_len);
+int topic_build(char *buf, int size, const char *scope, const char *id,
+                const char *leaf);
+void topic_route_clear(void);
+esp_err_t topic_route_add(const char *filter, topic_handler_t handler);
+topic_handler_t topic_route_find(const char *topic, int topic_len);
+
+#endif // USER_TOPIC_H
@@ -0,0 +1,84 @@
+#include "user_net.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "user_nvs.h"
+#include "user_prof.h"
+
+#define TAG "user net"
+
+static QueueHandle_t s_net_queue;
+static net_fsm_t s_fsm;
+static const net_actions_t *s_actions;
+
+// Wi-Fi、IP、MQTT 事件处理函数里调用，只入队不阻塞
+void net_post_event(net_event_t event) {
+    uint8_t ev = event;
+    if (s_net_queue == NULL || xQueueSend(s_net_queue, &ev, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Event %s dropped", net_event_name(event));
+    }
+}
+
+static void net_run_action(net_action_t action) {
+    switch (action) {
+    case NET_ACT_START_AP:
+        s_actions->start_ap();
+        break;
+    case NET_ACT_START_STA:
+        s_actions->start_sta();
+        break;
+    case NET_ACT_RETRY_STA:
+        s_actions->retry_sta();
+        break;
+    case NET_ACT_START_MQTT:
+        s_actions->start_mqtt();
+        break;
+    default:
+        break;
+    }
+}
+
+static void net_task(void *pvParameters) {
+    TickType_t deadline = 0;
+    int armed = 0;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        if (armed) {
+            int32_t left = (int32_t)(deadline - xTaskGetTickCount());
+            wait = left > 0 ? left : 0;
+        }
+
+        uint8_t ev;
+        if (xQueueReceive(s_net_queue, &ev, wait) != pdTRUE) {
+            ev = NET_EVT_TIMEOUT;
+            armed = 0;
+        }
+        prof_wakeup(PROF_TASK_NET);
+
+        net_state_t from = s_fsm.state;
+        net_step_t step = net_fsm_step(&s_fsm, ev);
+        if (step.timer_ms == 0) {
+            armed = 0;
+        } else if (step.timer_ms > 0) {
+            deadline = xTaskGetTickCount() + pdMS_TO_TICKS(step.timer_ms);
+            armed = 1;
+        }
+        ESP_LOGI(TAG, "%s: %s -> %s, timer %d", net_event_name(ev),
+                 net_state_name(from), net_state_name(s_fsm.state),
+                 step.timer_ms);
+
+        // net_state_t 与 dev_state_t 顺序一致，dev_state 只在这里写
+        dev_state_set((dev_state_t)s_fsm.state);
+        net_run_action(step.action);
+    }
+}
+
+void net_start(const net_actions_t *actions, int provisioned) {
+    s_actions = actions;
+    net_fsm_init(&s_fsm);
+    s_net_queue = xQueueCreate(NET_QUEUE_LEN, sizeof(uint8_t));
+    net_post_event(provisioned ? NET_EVT_START : NET_EVT_PROVISION);
+    xTaskCreate(net_task, "net_state", 3072, NULL, 10, NULL);
+}
@@ -0,0 +1,20 @@
+#ifndef USER_NET_H
+#define USER_NET_H
+
+#include "user_net_fsm.h"
+
+#define NET_QUEUE_LEN 16
+
+// 状态机的动作由 main 提供，在联网任务中执行
+typedef struct
+{
+    void (*start_ap)(void);
+    void (*start_sta)(void);
+    void (*retry_sta)(void);
+    void (*start_mqtt)(void);
+} net_actions_t;
+
+void net_start(const net_actions_t *actions, int provisioned);
+void net_post_event(net_event_t event);
+
+#endif // USER_NET_H
@@ -0,0 +1,166 @@
+#include "user_net_fsm.h"
+#include <stddef.h>
+
+#define NET_STATE_ANY NET_STATE_MAX
+
+typedef enum
+{
+    TIMER_KEEP = 0,
+    TIMER_CANCEL,
+    TIMER_CONNECT,  // NET_STA_CONNECT_TIMEOUT_MS
+    TIMER_BACKOFF,  // 按失败次数指数退避
+    TIMER_AP_WINDOW,
+} net_timer_t;
+
+typedef enum
+{
+    GUARD_NONE = 0,
+    GUARD_STA_RETRY,     // 失败次数未用完
+    GUARD_STA_EXHAUSTED, // 失败次数已用完
+    GUARD_PROVISIONED,   // 已配网
+    GUARD_MQTT_UP,       // MQTT 会话仍在线
+} net_guard_t;
+
+#define ROW_COUNT_FAILURE 0x01 // 匹配前先记一次连接失败
+#define ROW_RESET_FAILURES 0x02
+
+typedef struct
+{
+    uint8_t state;
+    uint8_t event;
+    uint8_t flags;
+    uint8_t guard;
+    uint8_t next;
+    uint8_t action;
+    uint8_t timer;
+} net_row_t;
+
+// 按顺序匹配第一条 state/event/guard 都满足的行，没有匹配的事件被忽略
+static const net_row_t ROWS[] = {
+    {NET_STATE_ANY, NET_EVT_PROVISION, 0, GUARD_NONE, NET_STATE_SOFTAP,
+     NET_ACT_START_AP, TIMER_CANCEL},
+    {NET_STATE_ANY, NET_EVT_START, ROW_RESET_FAILURES, GUARD_NONE,
+     NET_STATE_STA_CONNECTING, NET_ACT_START_STA, TIMER_CONNECT},
+
+    {NET_STATE_SOFTAP, NET_EVT_AP_ACTIVITY, 0, GUARD_PROVISIONED,
+     NET_STATE_SOFTAP, NET_ACT_NONE, TIMER_AP_WINDOW},
+    {NET_STATE_SOFTAP, NET_EVT_TIMEOUT, ROW_RESET_FAILURES, GUARD_PROVISIONED,
+     NET_STATE_STA_CONNECTING, NET_ACT_START_STA, TIMER_CONNECT},
+
+    {NET_STATE_STA_CONNECTING, NET_EVT_STA_DISCONNECTED, 0, GUARD_NONE,
+     NET_STATE_STA_CONNECTING, NET_ACT_NONE, TIMER_BACKOFF},
+    {NET_STATE_STA_CONNECTING, NET_EVT_TIMEOUT, ROW_COUNT_FAILURE,
+     GUARD_STA_EXHAUSTED, NET_STATE_SOFTAP, NET_ACT_START_AP,
+     TIMER_AP_WINDOW},
+    {NET_STATE_STA_CONNECTING, NET_EVT_TIMEOUT, 0, GUARD_STA_RETRY,
+     NET_STATE_STA_CONNECTING, NET_ACT_RETRY_STA, TIMER_CONNECT},
+    // 重新取得地址时 MQTT 会话没断就直接回到已连接
+    {NET_STATE_STA_CONNECTING, NET_EVT_GOT_IP, ROW_RESET_FAILURES,
+     GUARD_MQTT_UP, NET_STATE_MQTT_CONNECTED, NET_ACT_START_MQTT,
+     TIMER_CANCEL},
+    {NET_STATE_STA_CONNECTING, NET_EVT_GOT_IP, ROW_RESET_FAILURES, GUARD_NONE,
+     NET_STATE_MQTT_CONNECTING, NET_ACT_START_MQTT, TIMER_CANCEL},
+
+    // MQTT 客户端自己退避重连，这里只跟踪状态
+    {NET_STATE_MQTT_CONNECTING, NET_EVT_MQTT_CONNECTED, 0, GUARD_NONE,
+     NET_STATE_MQTT_CONNECTED, NET_ACT_NONE, TIMER_CANCEL},
+    {NET_STATE_MQTT_CONNECTED, NET_EVT_MQTT_DISCONNECTED, 0, GUARD_NONE,
+     NET_STATE_MQTT_CONNECTING, NET_ACT_NONE, TIMER_CANCEL},
+    {NET_STATE_MQTT_CONNECTING, NET_EVT_STA_DISCONNECTED, 0, GUARD_NONE,
+     NET_STATE_STA_CONNECTING, NET_ACT_NONE, TIMER_BACKOFF},
+    {NET_STATE_MQTT_CONNECTED, NET_EVT_STA_DISCONNECTED, 0, GUARD_NONE,
+     NET_STATE_STA_CONNECTING, NET_ACT_NONE, TIMER_BACKOFF},
+};
+#define ROW_NUM (sizeof(ROWS) / sizeof(ROWS[0]))
+
+static const char *STATE_NAMES[NET_STATE_MAX] = {
+    "softap", "sta_connecting", "mqtt_connecting", "mqtt_connected"};
+static const char *EVENT_NAMES[NET_EVT_MAX] = {
+    "start",          "provision",         "ap_activity",
+    "sta_disconnected", "got_ip",          "mqtt_connected",
+    "mqtt_disconnected", "timeout"};
+
+void net_fsm_init(net_fsm_t *fsm) {
+    fsm->state = NET_STATE_SOFTAP;
+    fsm->sta_failures = 0;
+    fsm->provisioned = 0;
+    fsm->mqtt_connected = 0;
+}
+
+static int net_guard(const net_fsm_t *fsm, net_guard_t guard) {
+    switch (guard) {
+    case GUARD_STA_RETRY:
+        return fsm->sta_failures < NET_STA_MAX_FAILURES;
+    case GUARD_STA_EXHAUSTED:
+        return fsm->sta_failures >= NET_STA_MAX_FAILURES;
+    case GUARD_PROVISIONED:
+        return fsm->provisioned;
+    case GUARD_MQTT_UP:
+        return fsm->mqtt_connected;
+    default:
+        return 1;
+    }
+}
+
+static int32_t net_timer_ms(const net_fsm_t *fsm, net_timer_t timer) {
+    switch (timer) {
+    case TIMER_CANCEL:
+        return 0;
+    case TIMER_CONNECT:
+        return NET_STA_CONNECT_TIMEOUT_MS;
+    case TIMER_BACKOFF: {
+        int shift = fsm->sta_failures < 8 ? fsm->sta_failures : 8;
+        int32_t ms = NET_STA_RETRY_MIN_MS << shift;
+        return ms < NET_STA_RETRY_MAX_MS ? ms : NET_STA_RETRY_MAX_MS;
+    }
+    case TIMER_AP_WINDOW:
+        return NET_AP_WINDOW_MS;
+    default:
+        return -1;
+    }
+}
+
+net_step_t net_fsm_step(net_fsm_t *fsm, net_event_t event) {
+    net_step_t step = {NET_ACT_NONE, -1};
+    int counted = 0;
+
+    if (event == NET_EVT_START) {
+        fsm->provisioned = 1;
+    } else if (event == NET_EVT_PROVISION) {
+        fsm->provisioned = 0;
+    } else if (event == NET_EVT_MQTT_CONNECTED) {
+        fsm->mqtt_connected = 1;
+    } else if (event == NET_EVT_MQTT_DISCONNECTED) {
+        fsm->mqtt_connected = 0;
+    }
+    for (int i = 0; i < ROW_NUM; i++) {
+        const net_row_t *row = &ROWS[i];
+        if ((row->state != NET_STATE_ANY && row->state != fsm->state) ||
+            row->event != event) {
+            continue;
+        }
+        if ((row->flags & ROW_COUNT_FAILURE) && !counted) {
+            fsm->sta_failures++;
+            counted = 1;
+        }
+        if (!net_guard(fsm, row->guard)) {
+            continue;
+        }
+        if (row->flags & ROW_RESET_FAILURES) {
+            fsm->sta_failures = 0;
+        }
+        fsm->state = row->next;
+        step.action = row->action;
+        step.timer_ms = net_timer_ms(fsm, row->timer);
+        break;
+    }
+    return step;
+}
+
+const char *net_state_name(net_state_t state) {
+    return state < NET_STATE_MAX ? STATE_NAMES[state] : "?";
+}
+
+const char *net_event_name(net_event_t event) {
+    return event < NET_EVT_MAX ? EVENT_NAMES[event] : "?";
+}
@@ -0,0 +1,69 @@
+#ifndef USER_NET_FSM_H
+#define USER_NET_FSM_H
+
+#include <stdint.h>
+
+// 联网状态机的转移表，不依赖 FreeRTOS，可以在主机上用事件序列回放
+
+#define NET_STA_CONNECT_TIMEOUT_MS 15000 // 单次连接 AP 并获取 IP 的超时
+#define NET_STA_RETRY_MIN_MS 1000        // 断开后重试的退避初始值
+#define NET_STA_RETRY_MAX_MS 30000       // 退避上限
+#define NET_STA_MAX_FAILURES 8           // 连续失败多少次后回到配网模式
+#define NET_AP_WINDOW_MS 200000          // 配网窗口，无人操作则回到 STA
+
+// 顺序与 dev_state_t 一致
+typedef enum
+{
+    NET_STATE_SOFTAP = 0,
+    NET_STATE_STA_CONNECTING,
+    NET_STATE_MQTT_CONNECTING,
+    NET_STATE_MQTT_CONNECTED,
+    NET_STATE_MAX,
+} net_state_t;
+
+typedef enum
+{
+    NET_EVT_START = 0,         // 已配网，开始连接
+    NET_EVT_PROVISION,         // 未配网，进入配网模式
+    NET_EVT_AP_ACTIVITY,       // 配网模式下有设备接入或建立 TCP 连接
+    NET_EVT_STA_DISCONNECTED,
+    NET_EVT_GOT_IP,
+    NET_EVT_MQTT_CONNECTED,
+    NET_EVT_MQTT_DISCONNECTED,
+    NET_EVT_TIMEOUT,
+    NET_EVT_MAX,
+} net_event_t;
+
+typedef enum
+{
+    NET_ACT_NONE = 0,
+    NET_ACT_START_AP,
+    NET_ACT_START_STA,
+    NET_ACT_RETRY_STA,
+    NET_ACT_START_MQTT,
+    NET_ACT_MAX,
+} net_action_t;
+
+typedef struct
+{
+    net_state_t state;
+    uint8_t sta_failures;
+    uint8_t provisioned; // 有可用的 Wi-Fi 配置，配网窗口超时后可以回到 STA
+    // MQTT 会话在线。与 Wi-Fi 分开跟踪：Wi-Fi 短暂断开后以同一地址重连时，
+    // TCP 连接可能还在，不会再收到 MQTT 连接事件
+    uint8_t mqtt_connected;
+} net_fsm_t;
+
+// 一次转移的结果，timer_ms：-1 保持原定时，0 取消，>0 重新计时
+typedef struct
+{
+    net_action_t action;
+    int32_t timer_ms;
+} net_step_t;
+
+void net_fsm_init(net_fsm_t *fsm);
+net_step_t net_fsm_step(net_fsm_t *fsm, net_event_t event);
+const char *net_state_name(net_state_t state);
+const char *net_event_name(net_event_t event);
+
+#endif // USER_NET_FSM_H
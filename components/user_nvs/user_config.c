@@ -0,0 +1,361 @@
+#include "user_config.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "user config"
+#define CONFIG_CAL_KEY "cal"
+#define CONFIG_LAN_KEY "lankey"
+#define CONFIG_SCHED_KEY "sched"
+#define CONFIG_TZ_KEY "tz"
+#define CONFIG_NUMBER_DIGITS 9 // 不超过 int32_t
+
+light_config_t light_config;
+
+static TaskHandle_t s_subscribers[CONFIG_MAX_SUBSCRIBERS];
+static uint32_t s_pending;
+
+// 最近一次收到的灯效，不保存到 flash
+static effect_timeline_t s_effect;
+static pwm_calibration_t s_calibration;
+// 全 0 表示未设置，局域网控制命令一律拒绝
+static uint8_t s_lan_key[CONFIG_LAN_KEY_SIZE];
+static sched_table_t s_schedule;
+// 只在这里保存，由 alarm 任务设置 TZ 环境变量，避免与 localtime/mktime 并发
+static char s_tz[CONFIG_TZ_SIZE];
+
+// 解析以 '/' 分隔的十进制整数，返回个数，超过 CONFIG_NUMBER_DIGITS 位视为非法
+static int parse_numbers(const char *value, int value_len, int32_t *out,
+                         int max) {
+    int n = 0, digits = 0, neg = 0;
+    int32_t v = 0;
+
+    for (int i = 0; i <= value_len; i++) {
+        char c = i < value_len ? value[i] : '/';
+        if (c == '/') {
+            if (digits == 0 || n >= max) {
+                return -1;
+            }
+            out[n++] = neg ? -v : v;
+            v = digits = neg = 0;
+        } else if (c == '-' && digits == 0 && !neg) {
+            neg = 1;
+        } else if (c >= '0' && c <= '9' && digits < CONFIG_NUMBER_DIGITS) {
+            v = v * 10 + (c - '0');
+            digits++;
+        } else {
+            return -1;
+        }
+    }
+    return n;
+}
+
+// 十进制为旧客户端的 RGB565，"#rrggbb" / "#rrrrggggbbbb" 为高精度颜色
+static effect_rgb_t parse_color(const char *value) {
+    effect_rgb_t color;
+    if (value[0] == '#' &&
+        effect_parse_color(value + 1, strlen(value + 1), &color) == 0) {
+        return color;
+    }
+    return effect_rgb_from565((uint16_t)atoi(value));
+}
+
+void config_update_field(nvs_field_t field) {
+    switch (field) {
+    case NVS_FIELD_LIGHT_NORMAL:
+        light_config.lightNormal = parse_color(nvs_data.lightNormal);
+        break;
+    case NVS_FIELD_LIGHT_PERIOD:
+        light_config.lightPeriod = atoi(nvs_data.lightPeriod);
+        break;
+    case NVS_FIELD_LIGHT_SWITCH1:
+        light_config.lightSwitch1 = parse_color(nvs_data.lightSwitch1);
+        break;
+    case NVS_FIELD_LIGHT_SWITCH2:
+        light_config.lightSwitch2 = parse_color(nvs_data.lightSwitch2);
+        break;
+    case NVS_FIELD_LIGHT_SWITCH3:
+        light_config.lightSwitch3 = parse_color(nvs_data.lightSwitch3);
+        break;
+    default:
+        break;
+    }
+    s_pending |= CONFIG_NOTIFY_FIELD(field);
+}
+
+static void config_load_schedule(void) {
+    static uint8_t blob[SCHED_BLOB_MAX];
+    size_t len = sizeof(blob);
+
+    if (nvs_load_blob_len(CONFIG_SCHED_KEY, blob, &len) != ESP_OK ||
+        sched_unpack(blob, len, &s_schedule) < 0) {
+        memset(&s_schedule, 0, sizeof(s_schedule));
+    }
+}
+
+static void config_store_tz(const char *tz) {
+    portENTER_CRITICAL();
+    strcpy(s_tz, tz);
+    portEXIT_CRITICAL();
+}
+
+static void config_load_tz(void) {
+    char tz[CONFIG_TZ_SIZE];
+
+    if (nvs_load_blob(CONFIG_TZ_KEY, tz, sizeof(tz)) != ESP_OK ||
+        tz[0] == '\0' || tz[sizeof(tz) - 1] != '\0') {
+        strcpy(tz, CONFIG_ROOMLIGHT_TZ);
+    }
+    config_store_tz(tz);
+}
+
+void config_load_all(void) {
+    for (int i = 0; i < NVS_FIELD_MAX; i++) {
+        config_update_field(i);
+    }
+    if (nvs_load_blob(CONFIG_CAL_KEY, &s_calibration, sizeof(s_calibration)) !=
+        ESP_OK) {
+        pwm_calibration_default(&s_calibration);
+    }
+    if (nvs_load_blob(CONFIG_LAN_KEY, s_lan_key, sizeof(s_lan_key)) != ESP_OK) {
+        memset(s_lan_key, 0, sizeof(s_lan_key));
+    }
+    config_load_schedule();
+    config_load_tz();
+    s_pending |= CONFIG_NOTIFY_CAL | CONFIG_NOTIFY_SCHED | CONFIG_NOTIFY_TIME;
+    config_notify_pending();
+}
+
+// 颜色命令换算成高精度颜色后写入 lightNormal，与普通颜色走同一路径
+static int config_set_normal_rgb48(uint16_t r, uint16_t g, uint16_t b) {
+    char value[NVS_STORAGE_MAX];
+    sprintf(value, "#%04x%04x%04x", r, g, b);
+    return nvs_data_set(NVS_FIELD_LIGHT_NORMAL, value);
+}
+
+// "hue/sat/val"，hue 0-359，sat/val 0-1000
+int config_set_hsv(const char *value, int value_len) {
+    int32_t v[3];
+    uint16_t r, g, b;
+
+    if (parse_numbers(value, value_len, v, 3) != 3 || v[0] < 0 || v[0] > 359 ||
+        v[1] < 0 || v[1] > 1000 || v[2] < 0 || v[2] > 1000) {
+        ESP_LOGW(TAG, "Invalid hsv: %.*s", value_len, value);
+        return -1;
+    }
+    pwm_hsv_to_rgb48(v[0], v[1], v[2], &r, &g, &b);
+    return config_set_normal_rgb48(r, g, b);
+}
+
+// "kelvin/brightness"，kelvin PWM_CCT_MIN-PWM_CCT_MAX，brightness 0-1000
+int config_set_cct(const char *value, int value_len) {
+    int32_t v[2];
+    uint16_t r, g, b;
+
+    if (parse_numbers(value, value_len, v, 2) != 2 || v[0] < PWM_CCT_MIN ||
+        v[0] > PWM_CCT_MAX || v[1] < 0 || v[1] > 1000) {
+        ESP_LOGW(TAG, "Invalid cct: %.*s", value_len, value);
+        return -1;
+    }
+    pwm_cct_to_rgb48(v[0], v[1], &r, &g, &b);
+    return config_set_normal_rgb48(r, g, b);
+}
+
+// 9 个 Q12 矩阵元素（按行）加 3 个千分比最大占空比，"0" 恢复默认
+int config_set_calibration(const char *value, int value_len) {
+    pwm_calibration_t cal;
+    int32_t v[12];
+
+    if (value_len == 1 && value[0] == '0') {
+        pwm_calibration_default(&cal);
+    } else if (parse_numbers(value, value_len, v, 12) == 12) {
+        for (int i = 0; i < 9; i++) {
+            if (v[i] < -32768 || v[i] > 32767) {
+                return -1;
+            }
+            cal.matrix[i / 3][i % 3] = v[i];
+        }
+        for (int i = 0; i < 3; i++) {
+            if (v[9 + i] < 0 || v[9 + i] > 1000) {
+                return -1;
+            }
+            cal.max_duty[i] = v[9 + i];
+        }
+    } else {
+        ESP_LOGW(TAG, "Invalid calibration: %.*s", value_len, value);
+        return -1;
+    }
+
+    portENTER_CRITICAL();
+    s_calibration = cal;
+    portEXIT_CRITICAL();
+    nvs_save_blob(CONFIG_CAL_KEY, &cal, sizeof(cal));
+    s_pending |= CONFIG_NOTIFY_CAL;
+    return 0;
+}
+
+void config_get_calibration(pwm_calibration_t *cal) {
+    portENTER_CRITICAL();
+    *cal = s_calibration;
+    portEXIT_CRITICAL();
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// "0" 清除密钥，否则为 64 个十六进制字符
+int config_set_lan_key(const char *value, int value_len) {
+    uint8_t key[CONFIG_LAN_KEY_SIZE] = {0};
+
+    if (!(value_len == 1 && value[0] == '0')) {
+        if (value_len != CONFIG_LAN_KEY_SIZE * 2) {
+            ESP_LOGW(TAG, "Invalid LAN key length %d", value_len);
+            return -1;
+        }
+        for (int i = 0; i < CONFIG_LAN_KEY_SIZE; i++) {
+            int hi = hex_digit(value[2 * i]);
+            int lo = hex_digit(value[2 * i + 1]);
+            if (hi < 0 || lo < 0) {
+                ESP_LOGW(TAG, "Invalid LAN key");
+                return -1;
+            }
+            key[i] = (hi << 4) | lo;
+        }
+    }
+
+    portENTER_CRITICAL();
+    memcpy(s_lan_key, key, sizeof(key));
+    portEXIT_CRITICAL();
+    nvs_save_blob(CONFIG_LAN_KEY, key, sizeof(key));
+    ESP_LOGI(TAG, "LAN key %s", value_len == 1 ? "cleared" : "updated");
+    return 0;
+}
+
+// 返回 1 表示已设置密钥
+int config_get_lan_key(uint8_t key[CONFIG_LAN_KEY_SIZE]) {
+    uint8_t any = 0;
+
+    portENTER_CRITICAL();
+    memcpy(key, s_lan_key, CONFIG_LAN_KEY_SIZE);
+    portEXIT_CRITICAL();
+    for (int i = 0; i < CONFIG_LAN_KEY_SIZE; i++) {
+        any |= key[i];
+    }
+    return any != 0;
+}
+
+// 整表替换，空字符串或 "0" 清空
+int config_set_schedule(const char *value, int value_len) {
+    static sched_table_t table;
+    static uint8_t blob[SCHED_BLOB_MAX];
+
+    int count = sched_parse(value, value_len, &table);
+    if (count < 0) {
+        ESP_LOGW(TAG, "Invalid schedule: %.*s", value_len, value);
+        return -1;
+    }
+    int len = sched_pack(&table, blob, sizeof(blob));
+    portENTER_CRITICAL();
+    s_schedule = table;
+    portEXIT_CRITICAL();
+    nvs_save_blob(CONFIG_SCHED_KEY, blob, len);
+    ESP_LOGI(TAG, "Schedule: %d rules, %d bytes", count, len);
+    s_pending |= CONFIG_NOTIFY_SCHED;
+    return count;
+}
+
+int config_get_schedule(sched_table_t *table) {
+    portENTER_CRITICAL();
+    *table = s_schedule;
+    portEXIT_CRITICAL();
+    return table->count;
+}
+
+// POSIX TZ 字符串，如 "CST-8"、"CET-1CEST,M3.5.0,M10.5.0/3"，"0" 恢复默认
+int config_set_tz(const char *value, int value_len) {
+    char tz[CONFIG_TZ_SIZE] = {0};
+
+    if (value_len == 1 && value[0] == '0') {
+        strcpy(tz, CONFIG_ROOMLIGHT_TZ);
+    } else if (value_len > 0 && value_len < sizeof(tz) &&
+               memchr(value, '"', value_len) == NULL) {
+        memcpy(tz, value, value_len);
+    } else {
+        ESP_LOGW(TAG, "Invalid time zone: %.*s", value_len, value);
+        return -1;
+    }
+    ESP_LOGI(TAG, "Time zone %s", tz);
+    config_store_tz(tz);
+    nvs_save_blob(CONFIG_TZ_KEY, tz, sizeof(tz));
+    s_pending |= CONFIG_NOTIFY_TIME;
+    return 0;
+}
+
+void config_get_tz(char tz[CONFIG_TZ_SIZE]) {
+    portENTER_CRITICAL();
+    strcpy(tz, s_tz);
+    portEXIT_CRITICAL();
+}
+
+// 空字符串或 "0" 表示停止灯效
+int config_set_effect(const char *value, int value_len) {
+    effect_timeline_t timeline = {0};
+
+    if (value_len > 0 && !(value_len == 1 && value[0] == '0') &&
+        effect_parse(value, value_len, &timeline) < 0) {
+        ESP_LOGW(TAG, "Invalid effect: %.*s", value_len, value);
+        return -1;
+    }
+    portENTER_CRITICAL();
+    s_effect = timeline;
+    portEXIT_CRITICAL();
+    s_pending |= CONFIG_NOTIFY_EFFECT;
+    return timeline.count;
+}
+
+int config_get_effect(effect_timeline_t *timeline) {
+    portENTER_CRITICAL();
+    *timeline = s_effect;
+    portEXIT_CRITICAL();
+    return timeline->count;
+}
+
+// 一个数据包内的所有修改合并为一次通知
+void config_notify_pending(void) {
+    uint32_t bits = s_pending;
+    s_pending = 0;
+    if (bits) {
+        config_notify(bits);
+    }
+}
+
+void config_notify(uint32_t bits) {
+    for (int i = 0; i < CONFIG_MAX_SUBSCRIBERS; i++) {
+        if (s_subscribers[i] != NULL) {
+            xTaskNotify(s_subscribers[i], bits, eSetBits);
+        }
+    }
+}
+
+int config_subscribe(TaskHandle_t task) {
+    for (int i = 0; i < CONFIG_MAX_SUBSCRIBERS; i++) {
+        if (s_subscribers[i] == NULL || s_subscribers[i] == task) {
+            s_subscribers[i] = task;
+            return 0;
+        }
+    }
+    ESP_LOGE(TAG, "Too many config subscribers");
+    return -1;
+}
@@ -0,0 +1,60 @@
+#ifndef USER_CONFIG_H
+#define USER_CONFIG_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "user_effect.h"
+#include "user_nvs.h"
+#include "user_pwm.h"
+#include "user_sched.h"
+
+#define CONFIG_MAX_SUBSCRIBERS 4
+#define CONFIG_LAN_KEY_SIZE 32
+#define CONFIG_TZ_SIZE 48
+// 通知值的位：低位为 nvs_field_t 对应的位
+#define CONFIG_NOTIFY_FIELD(field) (1UL << (field))
+#define CONFIG_NOTIFY_STATE (1UL << 16)  // dev_state 变化
+#define CONFIG_NOTIFY_EFFECT (1UL << 17) // 收到新的灯效
+#define CONFIG_NOTIFY_CAL (1UL << 18)    // 校准参数变化
+#define CONFIG_NOTIFY_VERSION (1UL << 19) // 应用了新的期望状态版本
+#define CONFIG_NOTIFY_SYNC (1UL << 20)    // 房间共享时钟跳变
+#define CONFIG_NOTIFY_SCHED (1UL << 21)   // 定时规则变化
+#define CONFIG_NOTIFY_TIME (1UL << 22)    // 对时完成、时间跳变或时区变化
+#define CONFIG_NOTIFY_LIGHT                                                    \
+    (CONFIG_NOTIFY_FIELD(NVS_FIELD_LIGHT_NORMAL) |                             \
+     CONFIG_NOTIFY_FIELD(NVS_FIELD_LIGHT_PERIOD) |                             \
+     CONFIG_NOTIFY_FIELD(NVS_FIELD_LIGHT_SWITCH1) |                            \
+     CONFIG_NOTIFY_FIELD(NVS_FIELD_LIGHT_SWITCH2) |                            \
+     CONFIG_NOTIFY_FIELD(NVS_FIELD_LIGHT_SWITCH3))
+
+// 已解析的运行时配置，字符串变化时才重新解析
+typedef struct
+{
+    int lightPeriod;
+    effect_rgb_t lightNormal;
+    effect_rgb_t lightSwitch1;
+    effect_rgb_t lightSwitch2;
+    effect_rgb_t lightSwitch3;
+} light_config_t;
+extern light_config_t light_config;
+
+void config_load_all(void);
+void config_update_field(nvs_field_t field);
+void config_notify_pending(void);
+int config_set_effect(const char *value, int value_len);
+int config_get_effect(effect_timeline_t *timeline);
+int config_set_hsv(const char *value, int value_len);
+int config_set_cct(const char *value, int value_len);
+int config_set_calibration(const char *value, int value_len);
+void config_get_calibration(pwm_calibration_t *cal);
+int config_set_lan_key(const char *value, int value_len);
+int config_get_lan_key(uint8_t key[CONFIG_LAN_KEY_SIZE]);
+int config_set_schedule(const char *value, int value_len);
+int config_get_schedule(sched_table_t *table);
+int config_set_tz(const char *value, int value_len);
+void config_get_tz(char tz[CONFIG_TZ_SIZE]);
+void config_notify(uint32_t bits);
+int config_subscribe(TaskHandle_t task);
+
+#endif // USER_CONFIG_H
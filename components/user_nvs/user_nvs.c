@@ -1,13 +1,17 @@
 #include "user_nvs.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "nvs.h"
 #include "nvs_flash.h"
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
-#include "cJSON.h"
+#include "user_config.h"
+#include "user_parser.h"
 #define TAG "user nvs"
 
 static const char *NVS_CUSTOMER = "customer_data";
@@ -16,15 +20,88 @@ dev_state_t dev_state = DEV_SOFTAP;
 uint16_t uniqueId;
 uint8_t mac[6] = {0};
 
-static const char *LABELS[] = {
-    NVS_SSID,         NVS_PASS,         NVS_USERID,
-    NVS_ROOMID,       NVS_LightNormal,  NVS_LightPeriod,
-    NVS_LightSwitch1, NVS_LightSwitch2, NVS_LightSwitch3};
+// 下标即 nvs_field_t，与 nvs_data_t 成员顺序一致
+static const char *LABELS[NVS_FIELD_MAX] = {
+    NVS_SSID,         NVS_PASS,         NVS_USERID,       NVS_ROOMID,
+    NVS_TimeStamp,    NVS_LightNormal,  NVS_LightPeriod,  NVS_LightSwitch1,
+    NVS_LightSwitch2, NVS_LightSwitch3};
+static const uint8_t LABEL_LENS[NVS_FIELD_MAX] = {
+    sizeof(NVS_SSID) - 1,         sizeof(NVS_PASS) - 1,
+    sizeof(NVS_USERID) - 1,       sizeof(NVS_ROOMID) - 1,
+    sizeof(NVS_TimeStamp) - 1,    sizeof(NVS_LightNormal) - 1,
+    sizeof(NVS_LightPeriod) - 1,  sizeof(NVS_LightSwitch1) - 1,
+    sizeof(NVS_LightSwitch2) - 1, sizeof(NVS_LightSwitch3) - 1};
 
 nvs_data_t nvs_data;
 
+// 整个 nvs_data_t 作为一个带版本和 CRC 的 blob 存储，启动时一次读取
+#define NVS_BLOB_KEY "cfg"
+#define NVS_BLOB_VERSION 1
+#define NVS_DIRTY_VERSION (1 << NVS_FIELD_MAX) // 期望状态版本号待落盘
+
+typedef struct {
+    uint16_t version;
+    uint16_t size;
+    nvs_data_t data;
+    uint32_t crc;
+} nvs_blob_t;
+
+// 写回缓存：nvs_data 即 RAM 副本，s_dirty 记录尚未落盘的字段
+static uint32_t s_dirty;
+static int64_t s_first_dirty_us;
+static SemaphoreHandle_t s_nvs_lock;
+static esp_timer_handle_t s_flush_timer;
+static int s_flush_armed; // 落盘定时器已启动且尚未触发
+static nvs_stats_t s_stats;
+static uint32_t s_desired_version;
+
+static uint32_t nvs_crc32(const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    uint32_t crc = 0xffffffff;
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static void nvs_lock(void) {
+    if (s_nvs_lock != NULL) {
+        xSemaphoreTake(s_nvs_lock, portMAX_DELAY);
+    }
+}
+
+static void nvs_unlock(void) {
+    if (s_nvs_lock != NULL) {
+        xSemaphoreGive(s_nvs_lock);
+    }
+}
+
+// 调用者持有 nvs_lock
+static void nvs_arm_flush(uint32_t delay_ms) {
+    esp_timer_stop(s_flush_timer);
+    esp_timer_start_once(s_flush_timer, delay_ms * 1000ULL);
+    s_flush_armed = 1;
+}
+
+static void nvs_flush_timer_cb(void *arg) {
+    nvs_lock();
+    s_flush_armed = 0;
+    nvs_unlock();
+    if (nvs_flush() != ESP_OK) {
+        // 脏数据仍在 RAM 中，重新计时后重试，不能等下一次修改
+        nvs_lock();
+        if (s_dirty != 0 && !s_flush_armed) {
+            s_first_dirty_us = esp_timer_get_time();
+            nvs_arm_flush(NVS_FLUSH_RETRY_MS);
+        }
+        nvs_unlock();
+    }
+}
+
 void init_nvs() {
-    uint8_t mac[6];
     esp_err_t ret = esp_efuse_mac_get_default(mac);
 
     if (ret == ESP_OK) {
@@ -42,6 +119,182 @@ void init_nvs() {
         err = nvs_flash_init();
     }
     ESP_ERROR_CHECK(err);
+
+    s_nvs_lock = xSemaphoreCreateMutex();
+    const esp_timer_create_args_t timer_args = {
+        .callback = nvs_flush_timer_cb,
+        .name = "nvs_flush",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_flush_timer));
+}
+
+int nvs_data_set(nvs_field_t field, const char *value) {
+    if (field < 0 || field >= NVS_FIELD_MAX ||
+        strlen(value) >= NVS_STORAGE_MAX) {
+        return -1;
+    }
+
+    char *dst = NVS_FIELD_PTR(&nvs_data, field);
+    nvs_lock();
+    if (strcmp(dst, value) == 0) {
+        s_stats.skipped++;
+        nvs_unlock();
+        return 0;
+    }
+    strcpy(dst, value);
+    config_update_field(field);
+    if (s_dirty == 0) {
+        s_first_dirty_us = esp_timer_get_time();
+    }
+    s_dirty |= 1 << field;
+    nvs_unlock();
+    return 1;
+}
+
+void nvs_schedule_flush(void) {
+    if (s_flush_timer == NULL) {
+        return;
+    }
+    nvs_lock();
+    // 连续修改时不断推迟，但脏数据最长只保留 NVS_FLUSH_MAX_DELAY_MS；
+    // 到期后只保留已挂起的定时器，没有挂起的定时器时总要启动一个
+    if (s_dirty != 0 &&
+        (!s_flush_armed ||
+         esp_timer_get_time() - s_first_dirty_us <
+             (NVS_FLUSH_MAX_DELAY_MS - NVS_FLUSH_DELAY_MS) * 1000LL)) {
+        nvs_arm_flush(NVS_FLUSH_DELAY_MS);
+    }
+    nvs_unlock();
+}
+
+esp_err_t nvs_flush(void) {
+    nvs_lock();
+    if (s_dirty == 0) {
+        nvs_unlock();
+        return ESP_OK;
+    }
+
+    nvs_handle handle;
+    esp_err_t err = nvs_open(NVS_CUSTOMER, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        nvs_unlock();
+        ESP_LOGE(TAG, "Error (%s) opening NVS handle!", esp_err_to_name(err));
+        return err;
+    }
+
+    nvs_blob_t blob = {
+        .version = NVS_BLOB_VERSION,
+        .size = sizeof(nvs_data_t),
+    };
+    memcpy(&blob.data, &nvs_data, sizeof(nvs_data_t));
+    blob.crc = nvs_crc32(&blob, offsetof(nvs_blob_t, crc));
+    err = nvs_set_blob(handle, NVS_BLOB_KEY, &blob, sizeof(blob));
+    s_stats.bytes += sizeof(blob);
+    if (err == ESP_OK && (s_dirty & NVS_DIRTY_VERSION)) {
+        err = nvs_set_u32(handle, NVS_Version, s_desired_version);
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(handle);
+    }
+    nvs_close(handle);
+
+    if (err == ESP_OK) {
+        s_dirty = 0;
+        s_stats.commits++;
+    } else {
+        ESP_LOGE(TAG, "Error (%s) flushing NVS!", esp_err_to_name(err));
+    }
+    nvs_unlock();
+    return err;
+}
+
+void nvs_get_stats(nvs_stats_t *stats) {
+    *stats = s_stats;
+}
+
+uint32_t nvs_desired_version(void) {
+    return s_desired_version;
+}
+
+esp_err_t nvs_load_blob(const char *key, void *buf, size_t len) {
+    nvs_handle handle;
+    size_t length = len;
+    esp_err_t err = nvs_open(NVS_CUSTOMER, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_get_blob(handle, key, buf, &length);
+    s_stats.reads++;
+    nvs_close(handle);
+    if (err == ESP_OK && length != len) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    return err;
+}
+
+// 变长 blob，*len 传入缓冲区大小，返回实际长度
+esp_err_t nvs_load_blob_len(const char *key, void *buf, size_t *len) {
+    nvs_handle handle;
+    esp_err_t err = nvs_open(NVS_CUSTOMER, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_get_blob(handle, key, buf, len);
+    s_stats.reads++;
+    nvs_close(handle);
+    return err;
+}
+
+esp_err_t nvs_save_blob(const char *key, const void *buf, size_t len) {
+    nvs_handle handle;
+    nvs_lock();
+    esp_err_t err = nvs_open(NVS_CUSTOMER, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(handle, key, buf, len);
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+            s_stats.commits++;
+            s_stats.bytes += len;
+        }
+        nvs_close(handle);
+    }
+    nvs_unlock();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error (%s) saving %s!", esp_err_to_name(err), key);
+    }
+    return err;
+}
+
+void nvs_flush_and_restart(void) {
+    if (s_flush_timer != NULL) {
+        esp_timer_stop(s_flush_timer);
+        s_flush_armed = 0;
+    }
+    nvs_flush();
+    esp_restart();
+}
+
+void dev_state_set(dev_state_t state) {
+    if (dev_state != state) {
+        dev_state = state;
+        config_notify(CONFIG_NOTIFY_STATE);
+    }
+}
+
+const char *nvs_field_label(nvs_field_t field) {
+    if (field < 0 || field >= NVS_FIELD_MAX) {
+        return NULL;
+    }
+    return LABELS[field];
+}
+
+int nvs_field_lookup(const char *key, int key_len) {
+    for (int i = 0; i < NVS_FIELD_MAX; i++) {
+        if (LABEL_LENS[i] == key_len && memcmp(key, LABELS[i], key_len) == 0) {
+            return i;
+        }
+    }
+    return -1;
 }
 
 int nvs_write_data_to_flash(const char *input) {
@@ -67,100 +320,280 @@ int nvs_write_data_to_flash(const char *input) {
     strncpy(value, ptr + 1, sizeof(value) - 1);
     value[sizeof(value) - 1] = '\0';
 
-    int is_valid_label = 0;
-    for (int i = 0; i < sizeof(LABELS) / sizeof(LABELS[0]); i++) {
-        if (strcmp(key, LABELS[i]) == 0) {
-            is_valid_label = 1;
-            break;
-        }
-    }
-
-    if (!is_valid_label) {
+    int field = nvs_field_lookup(key, key_length);
+    if (field < 0 || nvs_data_set(field, value) < 0) {
         return 0;
     }
 
-    nvs_handle handle;
-    esp_err_t err = nvs_open(NVS_CUSTOMER, NVS_READWRITE, &handle);
-    if (err != ESP_OK) {
-        return 0;
+    config_notify_pending();
+    return (nvs_flush() == ESP_OK) ? 1 : 0;
+}
+
+static void nvs_set_defaults(void) {
+    for (int i = 0; i < NVS_FIELD_MAX; i++) {
+        strcpy(NVS_FIELD_PTR(&nvs_data, i), "default");
     }
+}
 
-    err = nvs_set_str(handle, key, value);
-    if (err != ESP_OK) {
-        nvs_close(handle);
-        return 0;
+// 旧版固件按键名逐个存储字符串
+static void nvs_migrate_legacy(nvs_handle handle) {
+    for (int i = 0; i < NVS_FIELD_MAX; i++) {
+        char *field = NVS_FIELD_PTR(&nvs_data, i);
+        size_t value_length = NVS_STORAGE_MAX;
+        esp_err_t err = nvs_get_str(handle, LABELS[i], field, &value_length);
+        s_stats.reads++;
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "[%s]: %s (legacy)", LABELS[i], field);
+        } else {
+            strcpy(field, "default");
+        }
     }
+}
 
-    err = nvs_commit(handle);
-    nvs_close(handle);
+static void nvs_load_data(void);
 
-    return (err == ESP_OK) ? 1 : 0;
+void nvs_read_data_from_flash() {
+    nvs_load_data();
+    config_load_all();
 }
 
-void nvs_read_data_from_flash() {
+static void nvs_load_data(void) {
     nvs_handle handle;
+    nvs_set_defaults();
     esp_err_t err = nvs_open(NVS_CUSTOMER, NVS_READWRITE, &handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error (%s) opening NVS handle!", esp_err_to_name(err));
         return;
     }
-    char *data_pointers[] = {
-        nvs_data.ssid,         nvs_data.pass,         nvs_data.userID,
-        nvs_data.roomID,       nvs_data.lightNormal,  nvs_data.lightPeriod,
-        nvs_data.lightSwitch1, nvs_data.lightSwitch2, nvs_data.lightSwitch3};
-    for (int i = 0; i < sizeof(LABELS) / sizeof(LABELS[0]); i++) {
-        size_t value_length =
-            sizeof(nvs_data.ssid); // Assuming all fields are the same size
-        err = nvs_get_str(handle, LABELS[i], data_pointers[i], &value_length);
-        if (err == ESP_OK) {
-            ESP_LOGI(TAG, "[%s]: %s", LABELS[i], data_pointers[i]);
-        } else if (err == ESP_ERR_NVS_NOT_FOUND) {
-            ESP_LOGI(TAG, "[%s] not found.", LABELS[i]);
-            // set as default
-            strcpy(data_pointers[i], "default");
-        } else {
-            ESP_LOGI(TAG, "Error (%s) reading %s from NVS!",
-                     esp_err_to_name(err), LABELS[i]);
+
+    nvs_blob_t blob;
+    size_t length = sizeof(blob);
+    if (nvs_get_u32(handle, NVS_Version, &s_desired_version) != ESP_OK) {
+        s_desired_version = 0;
+    }
+    err = nvs_get_blob(handle, NVS_BLOB_KEY, &blob, &length);
+    s_stats.reads += 2;
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGI(TAG, "Config blob not found, migrating legacy keys");
+        nvs_migrate_legacy(handle);
+        s_dirty = (1 << NVS_FIELD_MAX) - 1;
+        // blob 写入成功后才删除旧键
+        if (nvs_flush() == ESP_OK) {
+            for (int i = 0; i < NVS_FIELD_MAX; i++) {
+                nvs_erase_key(handle, LABELS[i]);
+            }
+            nvs_commit(handle);
         }
+        nvs_close(handle);
+        return;
     }
-
     nvs_close(handle);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Error (%s) reading config blob!", esp_err_to_name(err));
+    } else if (length != sizeof(blob) || blob.version != NVS_BLOB_VERSION ||
+               blob.size != sizeof(nvs_data_t)) {
+        ESP_LOGW(TAG, "Config blob version %d size %d mismatch, using defaults",
+                 blob.version, (int)length);
+    } else if (blob.crc != nvs_crc32(&blob, offsetof(nvs_blob_t, crc))) {
+        ESP_LOGW(TAG, "Config blob CRC mismatch, using defaults");
+    } else {
+        memcpy(&nvs_data, &blob.data, sizeof(nvs_data_t));
+        for (int i = 0; i < NVS_FIELD_MAX; i++) {
+            NVS_FIELD_PTR(&nvs_data, i)[NVS_STORAGE_MAX - 1] = '\0';
+            ESP_LOGI(TAG, "[%s]: %s", LABELS[i], NVS_FIELD_PTR(&nvs_data, i));
+        }
+    }
 }
 
-void parse_data_packet(const char *data_packet, int data_packet_len, nvs_data_t *nvs_data) {
-    // 将数据包解析为 cJSON 对象
-    cJSON *json = cJSON_Parse(data_packet);
-    if (json == NULL) {
-        ESP_LOGW(TAG, "Error parsing JSON data");
+// 不保存为字符串字段的命令，在普通字段写入之后按表中顺序执行
+typedef int (*packet_cmd_handler_t)(const char *value, int value_len);
+
+static const struct {
+    const char *key;
+    uint8_t key_len;
+    packet_cmd_handler_t handler;
+} COMMANDS[NVS_CMD_MAX] = {
+    [NVS_CMD_EFFECT] = {NVS_Effect, sizeof(NVS_Effect) - 1, config_set_effect},
+    [NVS_CMD_HSV] = {NVS_Hsv, sizeof(NVS_Hsv) - 1, config_set_hsv},
+    [NVS_CMD_CCT] = {NVS_Cct, sizeof(NVS_Cct) - 1, config_set_cct},
+    [NVS_CMD_CAL] = {NVS_Calibration, sizeof(NVS_Calibration) - 1,
+                     config_set_calibration},
+    [NVS_CMD_LAN_KEY] = {NVS_LanKey, sizeof(NVS_LanKey) - 1,
+                         config_set_lan_key},
+    [NVS_CMD_SCHED] = {NVS_Schedule, sizeof(NVS_Schedule) - 1,
+                       config_set_schedule},
+    [NVS_CMD_TZ] = {NVS_TimeZone, sizeof(NVS_TimeZone) - 1, config_set_tz},
+};
+#define COMMAND_NUM NVS_CMD_MAX
+
+typedef struct {
+    const char *value[NVS_FIELD_MAX];
+    int value_len[NVS_FIELD_MAX];
+    const char *cmd_value[COMMAND_NUM];
+    int cmd_len[COMMAND_NUM];
+    int reboot;
+    int invalid; // 有值无法使用，整个包都不应用
+    uint32_t version;
+} packet_fields_t;
+
+// 版本号必须是 1..UINT32_MAX 的十进制数
+static int parse_version(const char *value, int value_len, uint32_t *version) {
+    uint32_t v = 0;
+    if (value_len <= 0) {
+        return -1;
+    }
+    for (int i = 0; i < value_len; i++) {
+        if (value[i] < '0' || value[i] > '9') {
+            return -1;
+        }
+        uint32_t digit = value[i] - '0';
+        if (v > (UINT32_MAX - digit) / 10) {
+            return -1;
+        }
+        v = v * 10 + digit;
+    }
+    *version = v;
+    return 0;
+}
+
+// 只记录值在缓冲区中的位置，整个包语法正确后再统一写入
+static void packet_field_cb(const char *key, int key_len, const char *value,
+                            int value_len, void *arg) {
+    packet_fields_t *fields = arg;
+    int field = nvs_field_lookup(key, key_len);
+
+    if (field >= 0) {
+        fields->value[field] = value;
+        fields->value_len[field] = value_len;
         return;
     }
+    if (key_len == sizeof(NVS_Reboot) - 1 &&
+        memcmp(key, NVS_Reboot, key_len) == 0) {
+        fields->reboot = (value_len == 1 && value[0] == '1');
+        return;
+    }
+    if (key_len == sizeof(NVS_Version) - 1 &&
+        memcmp(key, NVS_Version, key_len) == 0) {
+        if (parse_version(value, value_len, &fields->version) < 0) {
+            ESP_LOGW(TAG, "Invalid ver \"%.*s\"", value_len, value);
+            fields->invalid = 1;
+        }
+        return;
+    }
+    for (int i = 0; i < COMMAND_NUM; i++) {
+        if (COMMANDS[i].key_len == key_len &&
+            memcmp(key, COMMANDS[i].key, key_len) == 0) {
+            fields->cmd_value[i] = value;
+            fields->cmd_len[i] = value_len;
+            return;
+        }
+    }
+}
 
-    // 遍历所有标签并处理相应数据
-    for (int i = 0; i < NVS_StringNum + NVS_IntNum; i++) {
-        cJSON *item = cJSON_GetObjectItem(json, LABELS[i]);
-        if (item != NULL && cJSON_IsString(item)) {
-            const char *value = item->valuestring;
-            if (strlen(value) > NVS_STORAGE_MAX) {
-                ESP_LOGW(TAG, "Value too long for %s", LABELS[i]);
-                cJSON_Delete(json);
-                return;
-            } else {
-                strncpy((char *)nvs_data + offsetof(nvs_data_t, ssid) + i * NVS_STORAGE_MAX, value, NVS_STORAGE_MAX);
-                ESP_LOGI(TAG, "Key: %s, Value: %s", LABELS[i], value);
-                char storage_buffer[NVS_STORAGE_MAX + 10];
-                sprintf(storage_buffer, "%s:%s", LABELS[i], value);
-                nvs_write_data_to_flash(storage_buffer);
-            }
+void parse_data_packet(const char *data_packet, int data_packet_len, nvs_data_t *target) {
+    packet_fields_t fields = {0};
+
+    if (parser_scan(data_packet, data_packet_len, packet_field_cb, &fields) < 0) {
+        ESP_LOGW(TAG, "Error parsing data packet");
+        return;
+    }
+    // 与语法错误一样，任何一个值不可用时整个包都不应用
+    for (int i = 0; i < NVS_FIELD_MAX && !fields.invalid; i++) {
+        char value[NVS_STORAGE_MAX];
+        if (fields.value[i] != NULL &&
+            parser_copy_value(value, sizeof(value), fields.value[i],
+                              fields.value_len[i]) < 0) {
+            ESP_LOGW(TAG, "Invalid or too long value for %s", LABELS[i]);
+            fields.invalid = 1;
+        }
+    }
+    if (fields.invalid) {
+        ESP_LOGW(TAG, "Rejecting data packet");
+        return;
+    }
+    // 带版本号的期望状态：重复或乱序到达的旧版本直接忽略，0 表示不带版本
+    if (fields.version != 0 && target == &nvs_data) {
+        if (fields.version <= s_desired_version) {
+            ESP_LOGI(TAG, "Ignoring desired state ver %u (applied %u)",
+                     fields.version, s_desired_version);
+            s_stats.stale++;
+            return;
+        }
+        nvs_lock();
+        s_desired_version = fields.version;
+        if (s_dirty == 0) {
+            s_first_dirty_us = esp_timer_get_time();
+        }
+        s_dirty |= NVS_DIRTY_VERSION;
+        nvs_unlock();
+        config_notify(CONFIG_NOTIFY_VERSION);
+    }
+
+    for (int i = 0; i < NVS_FIELD_MAX; i++) {
+        if (fields.value[i] == NULL) {
+            continue;
+        }
+        char value[NVS_STORAGE_MAX];
+        parser_copy_value(value, sizeof(value), fields.value[i],
+                          fields.value_len[i]);
+        if (target != &nvs_data) {
+            strcpy(NVS_FIELD_PTR(target, i), value);
+        } else if (nvs_data_set(i, value) > 0) {
+            ESP_LOGI(TAG, "Key: %s, Value: %s", LABELS[i], value);
         }
     }
 
-    // 处理重启指令
-    cJSON *reboot_item = cJSON_GetObjectItem(json, NVS_Reboot);
-    if (reboot_item != NULL && cJSON_IsString(reboot_item) && strcmp(reboot_item->valuestring, "1") == 0) {
+    for (int i = 0; i < COMMAND_NUM && target == &nvs_data; i++) {
+        if (fields.cmd_value[i] != NULL) {
+            COMMANDS[i].handler(fields.cmd_value[i], fields.cmd_len[i]);
+        }
+    }
+    config_notify_pending();
+
+    // 处理重启指令，重启前先落盘
+    if (fields.reboot) {
         ESP_LOGI(TAG, "Rebooting...");
-        esp_restart();
+        nvs_flush_and_restart();
+    }
+    nvs_schedule_flush();
+}
+
+static void packet_key_cb(const char *key, int key_len, const char *value,
+                          int value_len, void *arg) {
+    uint32_t *mask = arg;
+    int field = nvs_field_lookup(key, key_len);
+
+    if (field >= 0) {
+        *mask |= NVS_KEY_FIELD(field);
+    } else if (key_len == sizeof(NVS_Reboot) - 1 &&
+               memcmp(key, NVS_Reboot, key_len) == 0) {
+        *mask |= NVS_KEY_REBOOT;
+    } else if (key_len == sizeof(NVS_Version) - 1 &&
+               memcmp(key, NVS_Version, key_len) == 0) {
+        *mask |= NVS_KEY_VERSION;
+    } else {
+        for (int i = 0; i < COMMAND_NUM; i++) {
+            if (COMMANDS[i].key_len == key_len &&
+                memcmp(key, COMMANDS[i].key, key_len) == 0) {
+                *mask |= NVS_KEY_COMMAND(i);
+            }
+        }
     }
+}
+
+// 返回数据包中出现的键的位图，语法错误返回 0
+uint32_t parse_packet_keys(const char *data_packet, int data_packet_len) {
+    uint32_t mask = 0;
+    if (parser_scan(data_packet, data_packet_len, packet_key_cb, &mask) < 0) {
+        return 0;
+    }
+    return mask | NVS_KEY_VALID;
+}
 
-    // 释放 cJSON 对象
-    cJSON_Delete(json);
+// 分片消息的第一片：只统计已完整出现的键，截断处的语法错误不影响结果
+uint32_t parse_packet_keys_prefix(const char *data_packet, int data_packet_len) {
+    uint32_t mask = 0;
+    parser_scan(data_packet, data_packet_len, packet_key_cb, &mask);
+    return mask;
 }
@@ -4,20 +4,58 @@
 #include "nvs_flash.h"
 
 #define NVS_STORAGE_MAX 30
+#define NVS_FLUSH_DELAY_MS 2000      // 最后一次修改后延迟落盘
+#define NVS_FLUSH_MAX_DELAY_MS 10000 // 连续修改时最长延迟
+#define NVS_FLUSH_RETRY_MS 5000      // 落盘失败后重试间隔
 
 #define NVS_SSID "ssid"
 #define NVS_PASS "pass"
 #define NVS_USERID "user"
 #define NVS_ROOMID "room"
 #define NVS_TimeStamp "timestamp" // 基于第一次连接wifi获取到的时间戳作为延长sn码
-#define NVS_StringNum   5
 #define NVS_LightNormal "lightNormal" //常亮颜色
 #define NVS_LightPeriod     "lightPeriod" // 切换周期和切换颜色
 #define NVS_LightSwitch1    "lightSwitch1"
 #define NVS_LightSwitch2    "lightSwitch2"        
 #define NVS_LightSwitch3    "lightSwitch3"  
 #define NVS_Reboot "reboot"
-#define NVS_IntNum 5
+#define NVS_Effect "effect" // 灯效时间线，只在运行时生效
+#define NVS_Hsv "hsv"       // "hue/sat/val"，换算后写入 lightNormal
+#define NVS_Cct "cct"       // "kelvin/brightness"，换算后写入 lightNormal
+#define NVS_Calibration "cal" // 白平衡/最大电流校准矩阵
+#define NVS_LanKey "lankey"   // 局域网控制的 HMAC 密钥，64 个十六进制字符
+#define NVS_Schedule "sched"  // 本地定时规则，格式见 user_sched.h
+#define NVS_TimeZone "tz"     // POSIX TZ 字符串，"0" 恢复默认
+#define NVS_Version "ver"     // 期望状态版本号，不大于已应用版本的数据包被忽略
+
+// 字段编号，顺序与 nvs_data_t 成员顺序一致
+typedef enum
+{
+    NVS_FIELD_SSID = 0,
+    NVS_FIELD_PASS,
+    NVS_FIELD_USERID,
+    NVS_FIELD_ROOMID,
+    NVS_FIELD_TIMESTAMP,
+    NVS_FIELD_LIGHT_NORMAL,
+    NVS_FIELD_LIGHT_PERIOD,
+    NVS_FIELD_LIGHT_SWITCH1,
+    NVS_FIELD_LIGHT_SWITCH2,
+    NVS_FIELD_LIGHT_SWITCH3,
+    NVS_FIELD_MAX,
+}nvs_field_t;
+
+// 不保存为字符串字段的命令
+typedef enum
+{
+    NVS_CMD_EFFECT = 0,
+    NVS_CMD_HSV,
+    NVS_CMD_CCT,
+    NVS_CMD_CAL,
+    NVS_CMD_LAN_KEY,
+    NVS_CMD_SCHED,
+    NVS_CMD_TZ,
+    NVS_CMD_MAX,
+}nvs_cmd_t;
 
 typedef enum
 {
@@ -27,6 +65,7 @@ typedef enum
     DEV_MQTT_CONNECTED,
 }dev_state_t;
 extern dev_state_t dev_state;
+void dev_state_set(dev_state_t state);
 
 typedef struct
 {
@@ -42,11 +81,52 @@ typedef struct
     char lightSwitch3[NVS_STORAGE_MAX];
 } nvs_data_t;
 extern nvs_data_t nvs_data;
+
+typedef struct
+{
+    uint32_t reads;   // 读取 flash 的次数
+    uint32_t commits; // nvs_commit 次数
+    uint32_t bytes;   // 写入的数据字节数
+    uint32_t skipped; // 值未变化而跳过的写入
+    uint32_t stale;   // 版本号过旧而忽略的数据包
+} nvs_stats_t;
+
 extern uint8_t mac[6];
 extern uint16_t uniqueId;
 
+// parse_packet_keys 返回的位图：低位为 nvs_field_t，其后为命令表中的命令
+#define NVS_KEY_FIELD(field) (1UL << (field))
+#define NVS_KEY_COMMAND(index) (1UL << (16 + (index)))
+#define NVS_KEY_VERSION (1UL << 29) // 带版本号的期望状态
+#define NVS_KEY_REBOOT (1UL << 30)
+#define NVS_KEY_VALID (1UL << 31)
+// 只包含这些键的数据包属于颜色命令，可以被后来的同类命令取代
+#define NVS_KEYS_COLOR                                                         \
+    (NVS_KEY_FIELD(NVS_FIELD_LIGHT_NORMAL) |                                   \
+     NVS_KEY_FIELD(NVS_FIELD_LIGHT_PERIOD) |                                   \
+     NVS_KEY_FIELD(NVS_FIELD_LIGHT_SWITCH1) |                                  \
+     NVS_KEY_FIELD(NVS_FIELD_LIGHT_SWITCH2) |                                  \
+     NVS_KEY_FIELD(NVS_FIELD_LIGHT_SWITCH3) |                                       \
+     NVS_KEY_COMMAND(NVS_CMD_EFFECT) | NVS_KEY_COMMAND(NVS_CMD_HSV) |            \
+     NVS_KEY_COMMAND(NVS_CMD_CCT))
+
+#define NVS_FIELD_PTR(data, field) ((char *)(data) + (field) * NVS_STORAGE_MAX)
+
 void init_nvs();
+const char *nvs_field_label(nvs_field_t field);
+int nvs_field_lookup(const char *key, int key_len);
+int nvs_data_set(nvs_field_t field, const char *value);
+void nvs_schedule_flush(void);
+esp_err_t nvs_flush(void);
+void nvs_flush_and_restart(void);
+void nvs_get_stats(nvs_stats_t *stats);
+uint32_t nvs_desired_version(void);
+esp_err_t nvs_load_blob(const char *key, void *buf, size_t len);
+esp_err_t nvs_load_blob_len(const char *key, void *buf, size_t *len);
+esp_err_t nvs_save_blob(const char *key, const void *buf, size_t len);
 int nvs_write_data_to_flash(const char *input);
 void nvs_read_data_from_flash(void);
 void parse_data_packet(const char *data_packet, int data_packet_len, nvs_data_t *nvs_data);
+uint32_t parse_packet_keys(const char *data_packet, int data_packet_len);
+uint32_t parse_packet_keys_prefix(const char *data_packet, int data_packet_len);
 #endif // USER_NVS_H
@@ -0,0 +1,271 @@
+#include "user_parser.h"
+#include <stddef.h>
+
+static int is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static int skip_space(const char *buf, int len, int pos) {
+    while (pos < len && is_space(buf[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+// 读取引号字符串，pos 指向起始引号，返回结束引号之后的位置
+static int scan_string(const char *buf, int len, int pos, int *start,
+                       int *slen) {
+    pos++;
+    *start = pos;
+    while (pos < len) {
+        if (buf[pos] == '\\') {
+            pos += 2;
+        } else if (buf[pos] == '"') {
+            *slen = pos - *start;
+            return pos + 1;
+        } else {
+            pos++;
+        }
+    }
+    return -1;
+}
+
+// 读取未加引号的片段，直到任意一个终止符，末尾空白不计入
+static int scan_bare(const char *buf, int len, int pos, const char *stops,
+                     int *start, int *slen) {
+    *start = pos;
+    while (pos < len) {
+        const char *s;
+        for (s = stops; *s != '\0' && *s != buf[pos]; s++) {
+        }
+        if (*s != '\0') {
+            break;
+        }
+        pos++;
+    }
+    int end = pos;
+    while (end > *start && is_space(buf[end - 1])) {
+        end--;
+    }
+    *slen = end - *start;
+    return pos;
+}
+
+// 跳过嵌套的对象或数组，值本身不回调
+static int skip_nested(const char *buf, int len, int pos) {
+    int depth = 0;
+    while (pos < len) {
+        char c = buf[pos];
+        if (c == '"') {
+            int s, l;
+            pos = scan_string(buf, len, pos, &s, &l);
+            if (pos < 0) {
+                return -1;
+            }
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            depth++;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                return pos + 1;
+            }
+        }
+        pos++;
+    }
+    return -1;
+}
+
+int parser_scan(const char *buf, int len, parser_pair_cb_t cb, void *arg) {
+    int pos, count = 0, braced = 0;
+    int key, key_len, value, value_len;
+
+    if (buf == NULL || len <= 0) {
+        return -1;
+    }
+    // 兼容以 '\0' 结尾且长度包含结尾符的调用
+    while (len > 0 && buf[len - 1] == '\0') {
+        len--;
+    }
+
+    pos = skip_space(buf, len, 0);
+    if (pos < len && buf[pos] == '{') {
+        braced = 1;
+        pos++;
+    }
+
+    while (1) {
+        pos = skip_space(buf, len, pos);
+        if (pos >= len) {
+            return braced ? -1 : count;
+        }
+        if (buf[pos] == '}') {
+            break;
+        }
+
+        if (buf[pos] == '"') {
+            pos = scan_string(buf, len, pos, &key, &key_len);
+        } else {
+            pos = scan_bare(buf, len, pos, ":,}", &key, &key_len);
+        }
+        if (pos < 0 || key_len == 0) {
+            return -1;
+        }
+        pos = skip_space(buf, len, pos);
+        if (pos >= len || buf[pos] != ':') {
+            return -1;
+        }
+        pos = skip_space(buf, len, pos + 1);
+        if (pos >= len) {
+            return -1;
+        }
+
+        if (buf[pos] == '"') {
+            pos = scan_string(buf, len, pos, &value, &value_len);
+            if (pos < 0) {
+                return -1;
+            }
+        } else if (buf[pos] == '{' || buf[pos] == '[') {
+            pos = skip_nested(buf, len, pos);
+            if (pos < 0) {
+                return -1;
+            }
+            value_len = -1;
+        } else {
+            pos = scan_bare(buf, len, pos, ",}", &value, &value_len);
+        }
+
+        if (value_len >= 0) {
+            if (cb != NULL) {
+                cb(buf + key, key_len, buf + value, value_len, arg);
+            }
+            count++;
+        }
+
+        pos = skip_space(buf, len, pos);
+        if (pos < len && buf[pos] == ',') {
+            pos++;
+        } else if (pos < len && buf[pos] == '}') {
+            break;
+        } else if (pos < len) {
+            return -1;
+        }
+    }
+
+    if (!braced) {
+        return -1;
+    }
+    pos = skip_space(buf, len, pos + 1);
+    return pos == len ? count : -1;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// 读取 \u 之后的 4 位十六进制数，格式错误返回 -1
+static long read_hex4(const char *p, int avail) {
+    long code = 0;
+    if (avail < 4) {
+        return -1;
+    }
+    for (int i = 0; i < 4; i++) {
+        int h = hex_value(p[i]);
+        if (h < 0) {
+            return -1;
+        }
+        code = (code << 4) | h;
+    }
+    return code;
+}
+
+// 解码 value[*i] 处的 \uXXXX（含 UTF-16 代理对）为 UTF-8，不接受 \u0000，
+// *i 指向反斜杠，成功后指向转义序列的最后一个字符
+static int decode_unicode(char *dst, int dst_size, int n, const char *value,
+                          int value_len, int *i) {
+    int pos = *i + 2;
+    long code = read_hex4(value + pos, value_len - pos);
+    if (code <= 0 || (code >= 0xdc00 && code <= 0xdfff)) {
+        return -1;
+    }
+    pos += 4;
+    if (code >= 0xd800 && code <= 0xdbff) {
+        if (value_len - pos < 2 || value[pos] != '\\' || value[pos + 1] != 'u') {
+            return -1;
+        }
+        long low = read_hex4(value + pos + 2, value_len - pos - 2);
+        if (low < 0xdc00 || low > 0xdfff) {
+            return -1;
+        }
+        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+        pos += 6;
+    }
+
+    int bytes = code < 0x80 ? 1 : code < 0x800 ? 2 : code < 0x10000 ? 3 : 4;
+    if (n + bytes > dst_size - 1) {
+        return -1;
+    }
+    if (bytes == 1) {
+        dst[n] = (char)code;
+    } else {
+        static const unsigned char LEAD[] = {0, 0, 0xc0, 0xe0, 0xf0};
+        for (int k = bytes - 1; k > 0; k--) {
+            dst[n + k] = (char)(0x80 | (code & 0x3f));
+            code >>= 6;
+        }
+        dst[n] = (char)(LEAD[bytes] | code);
+    }
+    *i = pos - 1;
+    return n + bytes;
+}
+
+int parser_copy_value(char *dst, int dst_size, const char *value, int value_len) {
+    int n = 0;
+    for (int i = 0; i < value_len; i++) {
+        char c = value[i];
+        if (c == '\\' && i + 1 < value_len) {
+            if (value[i + 1] == 'u') {
+                n = decode_unicode(dst, dst_size, n, value, value_len, &i);
+                if (n < 0) {
+                    return -1;
+                }
+                continue;
+            }
+            c = value[++i];
+            switch (c) {
+            case 'b':
+                c = '\b';
+                break;
+            case 'f':
+                c = '\f';
+                break;
+            case 'n':
+                c = '\n';
+                break;
+            case 'r':
+                c = '\r';
+                break;
+            case 't':
+                c = '\t';
+                break;
+            default:
+                break;
+            }
+        }
+        if (n >= dst_size - 1) {
+            return -1;
+        }
+        dst[n++] = c;
+    }
+    dst[n] = '\0';
+    return n;
+}
@@ -0,0 +1,21 @@
+#ifndef USER_PARSER_H
+#define USER_PARSER_H
+
+/*
+ * 无分配的单遍命令解析器
+ * 直接在调用者的缓冲区上扫描 {"key":"value",...}，也接受设备内部使用的
+ * key:value,key:value 简写形式。不依赖 NUL 结尾，只使用显式长度。
+ */
+
+// value 指向缓冲区内的原始片段（字符串不含引号，转义未处理）
+typedef void (*parser_pair_cb_t)(const char *key, int key_len,
+                                 const char *value, int value_len, void *arg);
+
+// 返回解析出的键值对数量，语法错误返回 -1
+int parser_scan(const char *buf, int len, parser_pair_cb_t cb, void *arg);
+
+// 将 value 片段去转义后拷贝到 dst（含 '\0'），\uXXXX 解码为 UTF-8，
+// 放不下或 \u 转义无效返回 -1
+int parser_copy_value(char *dst, int dst_size, const char *value, int value_len);
+
+#endif // USER_PARSER_H
@@ -21,6 +21,7 @@
 #include "esp_ota_ops.h"
 #include "esp_http_client.h"
 #include "esp_https_ota.h"
+#include "user_nvs.h"
 
 static const char *TAG = "simple_ota_example";
 extern const uint8_t cert_pem_start[] asm("_binary_cert_pem_start");
@@ -65,7 +66,8 @@ void simple_ota_example_task(void * pvParameter)
     };
     esp_err_t ret = esp_https_ota(&config);
     if (ret == ESP_OK) {
-        esp_restart();
+        // 先写回防抖中的配置，否则升级重启会丢掉最近的修改
+        nvs_flush_and_restart();
     } else {
         ESP_LOGE(TAG, "Firmware Upgrades Failed");
     }
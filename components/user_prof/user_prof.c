@@ -0,0 +1,92 @@
+#include "user_prof.h"
+#include "esp_timer.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// 0 表示该阶段还没有到达
+static uint32_t s_marks[PROF_PHASE_MAX];
+static uint32_t s_wakeups[PROF_TASK_MAX];
+
+static const char *const TASK_NAMES[PROF_TASK_MAX] = {
+    [PROF_TASK_RENDER] = "render", [PROF_TASK_INPUT] = "input",
+    [PROF_TASK_NET] = "net",       [PROF_TASK_CMD] = "cmd",
+    [PROF_TASK_PUBLISH] = "pub",   [PROF_TASK_SHADOW] = "shadow",
+    [PROF_TASK_ALARM] = "alarm",   [PROF_TASK_SYNC] = "sync",
+};
+
+// 只记录第一次到达，重连不会覆盖启动时的数据
+void prof_mark(prof_phase_t phase) {
+    if (phase < PROF_PHASE_MAX && s_marks[phase] == 0) {
+        uint32_t ms = esp_timer_get_time() / 1000;
+        s_marks[phase] = ms ? ms : 1;
+    }
+}
+
+// 格式："prof:<版本>,reset:<复位原因>,boot:<t0>/<t1>/..."，未到达的阶段为 "-"
+int prof_format(char *buf, int size, int reset_reason) {
+    int len = snprintf(buf, size, "prof:%d,reset:%d,boot:",
+                       PROF_RECORD_VERSION, reset_reason);
+
+    for (int i = 0; i < PROF_PHASE_MAX && len < size; i++) {
+        const char *sep = i ? "/" : "";
+        if (s_marks[i]) {
+            len += snprintf(buf + len, size - len, "%s%u", sep, s_marks[i]);
+        } else {
+            len += snprintf(buf + len, size - len, "%s-", sep);
+        }
+    }
+    return (len < size) ? len : -1;
+}
+
+int prof_parse(const char *s, prof_record_t *rec) {
+    int n = 0;
+
+    if (sscanf(s, "prof:%d,reset:%d,boot:%n", &rec->version,
+               &rec->reset_reason, &n) != 2 || n == 0 ||
+        rec->version != PROF_RECORD_VERSION) {
+        return -1;
+    }
+    s += n;
+    for (int i = 0; i < PROF_PHASE_MAX; i++) {
+        if (i > 0 && *s++ != '/') {
+            return -1;
+        }
+        if (*s == '-') {
+            rec->marks[i] = 0;
+            s++;
+        } else if (*s >= '0' && *s <= '9') {
+            rec->marks[i] = strtoul(s, (char **)&s, 10);
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 每个任务只有自己写计数，不需要加锁
+void prof_wakeup(prof_task_t task) {
+    if (task < PROF_TASK_MAX) {
+        s_wakeups[task]++;
+    }
+}
+
+// 格式："wake:<统计时长 ms>,<任务>:<每秒唤醒次数>,..."，统计自上次调用以来的平均值
+int prof_format_wakeups(char *buf, int size) {
+    static uint32_t last_counts[PROF_TASK_MAX];
+    static uint32_t last_ms;
+    uint32_t now_ms = esp_timer_get_time() / 1000;
+    uint32_t window = now_ms - last_ms;
+    int len = snprintf(buf, size, "wake:%u", window);
+
+    for (int i = 0; i < PROF_TASK_MAX && len < size; i++) {
+        uint32_t count = s_wakeups[i] - last_counts[i];
+        // 每秒次数保留两位小数
+        uint32_t rate = window ? (uint64_t)count * 100000 / window : 0;
+        len += snprintf(buf + len, size - len, ",%s:%u.%02u", TASK_NAMES[i],
+                        rate / 100, rate % 100);
+        last_counts[i] += count;
+    }
+    last_ms = now_ms;
+    return (len < size) ? len : -1;
+}
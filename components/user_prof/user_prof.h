@@ -0,0 +1,53 @@
+#ifndef USER_PROF_H
+#define USER_PROF_H
+
+#include <stdint.h>
+
+// 启动阶段计时：记录各阶段第一次到达的时间（开机后的毫秒数），
+// 第一次连上 MQTT 时作为一条遥测上报
+typedef enum
+{
+    PROF_BOOT = 0,         // 进入 app_main
+    PROF_NVS_READY,        // 配置读取完成
+    PROF_WIFI_START,       // 开始连接 AP
+    PROF_WIFI_CONNECTED,   // 关联成功
+    PROF_GOT_IP,           // DHCP 完成
+    PROF_SNTP_DONE,        // 对时完成
+    PROF_MQTT_START,       // 启动 MQTT 客户端
+    PROF_MQTT_CONNECTING,  // 开始建立连接（TCP + TLS）
+    PROF_MQTT_CONNECTED,   // 收到 CONNACK
+    PROF_PHASE_MAX,
+} prof_phase_t;
+
+#define PROF_RECORD_VERSION 1
+
+// 各任务被唤醒的次数，用来确认静止时没有多余的唤醒
+typedef enum
+{
+    PROF_TASK_RENDER = 0, // 灯光刷新
+    PROF_TASK_INPUT,      // 按键
+    PROF_TASK_NET,        // 联网状态机
+    PROF_TASK_CMD,        // 命令分发
+    PROF_TASK_PUBLISH,    // MQTT 发送
+    PROF_TASK_SHADOW,     // 状态上报
+    PROF_TASK_ALARM,      // 定时规则
+    PROF_TASK_SYNC,       // 房间时钟同步
+    PROF_TASK_MAX,
+} prof_task_t;
+
+// prof_format 输出的一条记录，marks 为 0 表示该阶段没有到达
+typedef struct
+{
+    int version;
+    int reset_reason;
+    uint32_t marks[PROF_PHASE_MAX];
+} prof_record_t;
+
+void prof_mark(prof_phase_t phase);
+int prof_format(char *buf, int size, int reset_reason);
+// 解析 prof_format 的输出，供主机端统计工具使用；格式或版本不符返回 -1
+int prof_parse(const char *s, prof_record_t *rec);
+void prof_wakeup(prof_task_t task);
+int prof_format_wakeups(char *buf, int size);
+
+#endif // USER_PROF_H
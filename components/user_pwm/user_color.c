@@ -0,0 +1,83 @@
+#include "user_pwm.h"
+
+#define CCT_STEP 500
+
+// 黑体辐射近似颜色，每 500K 一项，点之间线性插值
+static const uint8_t cct_table[][3] = {
+    {255,  68,   0}, // 1000K
+    {255, 108,   0}, // 1500K
+    {255, 137,  14}, // 2000K
+    {255, 159,  70}, // 2500K
+    {255, 177, 110}, // 3000K
+    {255, 193, 141}, // 3500K
+    {255, 206, 166}, // 4000K
+    {255, 218, 187}, // 4500K
+    {255, 228, 206}, // 5000K
+    {255, 237, 222}, // 5500K
+    {255, 246, 237}, // 6000K
+    {255, 254, 250}, // 6500K
+    {243, 242, 255}, // 7000K
+    {230, 235, 255}, // 7500K
+    {221, 230, 255}, // 8000K
+    {215, 226, 255}, // 8500K
+    {210, 223, 255}, // 9000K
+    {205, 220, 255}, // 9500K
+    {202, 218, 255}, // 10000K
+};
+
+// hue: 0-359 度，sat/val: 0-1000
+void pwm_hsv_to_rgb48(uint16_t hue, uint16_t sat, uint16_t val, uint16_t *r,
+                      uint16_t *g, uint16_t *b) {
+    uint32_t v = (val > 1000 ? 1000 : val) * 65535 / 1000;
+    uint32_t s = sat > 1000 ? 1000 : sat;
+    uint32_t sector = (hue % 360) / 60;
+    uint32_t f = (hue % 60) * 65535 / 60;
+    uint32_t p = v * (1000 - s) / 1000;
+    uint32_t q = v * (1000 - s * f / 65535) / 1000;
+    uint32_t t = v * (1000 - s * (65535 - f) / 65535) / 1000;
+
+    switch (sector) {
+    case 0:
+        *r = v, *g = t, *b = p;
+        break;
+    case 1:
+        *r = q, *g = v, *b = p;
+        break;
+    case 2:
+        *r = p, *g = v, *b = t;
+        break;
+    case 3:
+        *r = p, *g = q, *b = v;
+        break;
+    case 4:
+        *r = t, *g = p, *b = v;
+        break;
+    default:
+        *r = v, *g = p, *b = q;
+        break;
+    }
+}
+
+// kelvin: 1000-10000，brightness: 0-1000
+void pwm_cct_to_rgb48(uint16_t kelvin, uint16_t brightness, uint16_t *r,
+                      uint16_t *g, uint16_t *b) {
+    uint32_t k = kelvin < PWM_CCT_MIN   ? PWM_CCT_MIN
+                 : kelvin > PWM_CCT_MAX ? PWM_CCT_MAX
+                                        : kelvin;
+    uint32_t i = (k - PWM_CCT_MIN) / CCT_STEP;
+    uint32_t frac = (k - PWM_CCT_MIN) % CCT_STEP;
+    // 亮度换算为 Q16 (0..65536)，65536 使满亮度时输出正好是通道值；
+    // 若只取 0..257，亮度低于 4‰ 会直接变成 0
+    uint32_t level = (brightness > 1000 ? 1000 : brightness) * 65536 / 1000;
+    uint16_t *out[3] = {r, g, b};
+
+    for (int c = 0; c < 3; c++) {
+        int32_t lo = cct_table[i][c];
+        int32_t hi = i + 1 < sizeof(cct_table) / sizeof(cct_table[0])
+                         ? cct_table[i + 1][c]
+                         : lo;
+        uint32_t value = lo * CCT_STEP + (hi - lo) * (int32_t)frac; // x500
+        uint32_t channel = value * 257 / CCT_STEP;                  // 16 位
+        *out[c] = (channel * level) >> 16;
+    }
+}
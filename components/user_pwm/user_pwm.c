@@ -2,9 +2,15 @@
 #include "driver/pwm.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include "user_gamma.h"
 #include <string.h>
 
 #define MAX_PWM_CHANNELS 3
+#define GAMMA_LUT_BITS 8
+#define GAMMA_LUT_SIZE ((1 << GAMMA_LUT_BITS) + 1)
+#define DUTY_FRAC_BITS 4
 
 static const char *TAG = "user_pwm";
 
@@ -12,6 +18,30 @@ static uint32_t g_io_num[MAX_PWM_CHANNELS];
 static uint32_t g_channel_num = 0;
 static uint32_t g_period = 0;
 
+// 16 位亮度经 gamma 校正后的占空比，单位微秒，低 DUTY_FRAC_BITS 位为小数
+static uint32_t g_gamma_lut[GAMMA_LUT_SIZE];
+
+// 帧缓冲：先暂存所有通道，变化时再一次性 pwm_start
+static uint32_t g_staged[MAX_PWM_CHANNELS];
+static uint32_t g_committed[MAX_PWM_CHANNELS];
+static int64_t g_last_commit_us;
+static int g_frame_pending;
+static pwm_stats_t g_stats;
+
+// 白平衡/最大电流校准，作用在 gamma 之后的线性占空比上
+static pwm_calibration_t g_cal = {
+    .matrix = {{4096, 0, 0}, {0, 4096, 0}, {0, 0, 4096}},
+    .max_duty = {1000, 1000, 1000},
+};
+
+// 在 init_pwm 中把 user_gamma.h 的 Q16 表按 PWM 周期缩放一次，只用整数运算
+static void gamma_lut_init(void) {
+    uint64_t max = g_period << DUTY_FRAC_BITS;
+    for (int i = 0; i < GAMMA_LUT_SIZE; i++) {
+        g_gamma_lut[i] = (uint32_t)((gamma_q16[i] * max + 32767) / 65535);
+    }
+}
+
 esp_err_t init_pwm(const uint32_t *io_num, uint32_t channel_num,
                    uint32_t frequency, const uint32_t *duty_cycle) {
     if (frequency == 0) {
@@ -37,8 +67,10 @@ esp_err_t init_pwm(const uint32_t *io_num, uint32_t channel_num,
     for (int i = 0; i < channel_num; i++) {
         duties[i] = (g_period * duty_cycle[i]) / 100;
         g_io_num[i] = io_num[i];
+        g_staged[i] = g_committed[i] = duties[i];
     }
     g_channel_num = channel_num;
+    gamma_lut_init();
 
     float phase[channel_num];        // Phases
     memset(phase, 0, sizeof(phase)); // Initialize phases to 0
@@ -57,24 +89,127 @@ esp_err_t init_pwm(const uint32_t *io_num, uint32_t channel_num,
     return ESP_OK;
 }
 
-int gamma_corrected_values[32] = {0,   1,   2,   5,   11,  18,  26,  37,
-                                  50,  65,  82,  102, 123, 147, 173, 202,
-                                  233, 266, 302, 340, 381, 424, 470, 518,
-                                  569, 622, 679, 737, 799, 863, 930, 1000};
+void pwm_frame_stage(uint32_t channel, uint32_t duty) {
+    if (channel < g_channel_num) {
+        g_staged[channel] = duty > g_period ? g_period : duty;
+    }
+}
 
-esp_err_t set_rgb_color(uint16_t lightness) {
-    uint32_t r = gamma_corrected_values[(lightness >> 11) & 0x1f];
-    uint32_t g = gamma_corrected_values[((lightness >> 5) & 0x3f) / 2];
-    uint32_t b = gamma_corrected_values[lightness & 0x1f];
-    // ESP_LOGI(TAG, "Setting RGB color to %d %d %d", r, g, b);
-    // pwm_stop(0);
-    pwm_set_duty(0, r);
-    pwm_set_duty(1, b);
-    pwm_set_duty(2, g);
+esp_err_t pwm_frame_commit(void) {
+    int changed = 0;
+    for (int i = 0; i < g_channel_num; i++) {
+        if (g_staged[i] != g_committed[i]) {
+            changed = 1;
+            break;
+        }
+    }
+    if (!changed) {
+        g_frame_pending = 0;
+        g_stats.skipped++;
+        return ESP_OK;
+    }
+
+    // 限制提交频率，过快的帧只保留最新一帧，由 pwm_frame_pending_ms 提示重试
+    int64_t now = esp_timer_get_time();
+    if (now - g_last_commit_us < CONFIG_ROOMLIGHT_PWM_MIN_COMMIT_MS * 1000LL) {
+        if (!g_frame_pending) {
+            g_frame_pending = 1;
+        } else {
+            g_stats.coalesced++;
+        }
+        return ESP_OK;
+    }
+
+    for (int i = 0; i < g_channel_num; i++) {
+        if (g_staged[i] != g_committed[i]) {
+            pwm_set_duty(i, g_staged[i]);
+            g_committed[i] = g_staged[i];
+        }
+    }
     pwm_start();
+    g_last_commit_us = now;
+    g_frame_pending = 0;
+    g_stats.commits++;
     return ESP_OK;
 }
 
+uint32_t pwm_frame_pending_ms(void) {
+    if (!g_frame_pending) {
+        return 0;
+    }
+    int64_t next = g_last_commit_us + CONFIG_ROOMLIGHT_PWM_MIN_COMMIT_MS * 1000LL;
+    int64_t remain = next - esp_timer_get_time();
+    return remain > 1000 ? (uint32_t)(remain / 1000) : 1;
+}
+
+void pwm_get_stats(pwm_stats_t *stats) {
+    *stats = g_stats;
+}
+
+static uint32_t gamma_duty(uint16_t level) {
+    if (level == 0xffff) {
+        return g_gamma_lut[GAMMA_LUT_SIZE - 1];
+    }
+    uint32_t i = level >> (16 - GAMMA_LUT_BITS);
+    uint32_t frac = level & ((1 << (16 - GAMMA_LUT_BITS)) - 1);
+    return g_gamma_lut[i] +
+           (((g_gamma_lut[i + 1] - g_gamma_lut[i]) * frac) >> (16 - GAMMA_LUT_BITS));
+}
+
+// 小数部分四舍五入到整数微秒
+static uint32_t output_duty(uint32_t duty) {
+    return (duty + (1 << (DUTY_FRAC_BITS - 1))) >> DUTY_FRAC_BITS;
+}
+
+void pwm_calibration_default(pwm_calibration_t *cal) {
+    memset(cal, 0, sizeof(*cal));
+    for (int i = 0; i < 3; i++) {
+        cal->matrix[i][i] = 4096;
+        cal->max_duty[i] = 1000;
+    }
+}
+
+void pwm_set_calibration(const pwm_calibration_t *cal) {
+    g_cal = *cal;
+}
+
+esp_err_t set_rgb48(uint16_t r, uint16_t g, uint16_t b) {
+    // 硬件通道顺序：R, B, G
+    static const uint8_t hw_channel[3] = {0, 2, 1};
+    const uint16_t level[3] = {r, g, b};
+    int32_t linear[3], max = g_period << DUTY_FRAC_BITS;
+
+    for (int i = 0; i < 3; i++) {
+        linear[i] = gamma_duty(level[i]);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        // 通道数少于 3 时跳过没有接线的颜色，不影响后面的通道
+        if (hw_channel[i] >= g_channel_num) {
+            continue;
+        }
+        int32_t duty = (g_cal.matrix[i][0] * linear[0] +
+                        g_cal.matrix[i][1] * linear[1] +
+                        g_cal.matrix[i][2] * linear[2]) >> 12;
+        duty = duty < 0 ? 0 : duty > max ? max : duty;
+        duty = duty * g_cal.max_duty[i] / 1000;
+        pwm_frame_stage(hw_channel[i], output_duty(duty));
+    }
+    return pwm_frame_commit();
+}
+
+esp_err_t set_rgb888(uint32_t rgb) {
+    return set_rgb48(((rgb >> 16) & 0xff) * 257, ((rgb >> 8) & 0xff) * 257,
+                     (rgb & 0xff) * 257);
+}
+
+// 兼容旧客户端的 RGB565，绿色保留全部 6 位
+esp_err_t set_rgb_color(uint16_t lightness) {
+    return set_rgb48(((lightness >> 11) & 0x1f) * 65535 / 31,
+                     ((lightness >> 5) & 0x3f) * 65535 / 63,
+                     (lightness & 0x1f) * 65535 / 31);
+}
+
 esp_err_t set_pwm_duty(uint32_t io_num, uint32_t duty_cycle) {
     if (duty_cycle > 100) {
         ESP_LOGE(TAG, "Invalid duty cycle");
@@ -94,9 +229,6 @@ esp_err_t set_pwm_duty(uint32_t io_num, uint32_t duty_cycle) {
         return ESP_ERR_NOT_FOUND;
     }
 
-    uint32_t duty = (g_period * duty_cycle) / 100;
-    pwm_set_duty(channel, duty);
-    pwm_start();
-
-    return ESP_OK;
+    pwm_frame_stage(channel, (g_period * duty_cycle) / 100);
+    return pwm_frame_commit();
 }
@@ -4,7 +4,39 @@
 #include <stdint.h>
 #include "esp_err.h"
 
+typedef struct
+{
+    uint32_t commits;   // 实际调用 pwm_start 的次数
+    uint32_t skipped;   // 与上一帧相同而跳过
+    uint32_t coalesced; // 频率限制内被后续帧覆盖
+} pwm_stats_t;
+
+// 校准矩阵，行列顺序 R, G, B，Q12（4096 = 1.0）
+typedef struct
+{
+    int16_t matrix[3][3];
+    uint16_t max_duty[3]; // 每通道最大占空比，千分比
+} pwm_calibration_t;
+
 esp_err_t init_pwm(const uint32_t *io_num, uint32_t channel_num, uint32_t frequency, const uint32_t *duty_cycle);
 esp_err_t set_pwm_duty(uint32_t io_num, uint32_t duty_cycle);
 esp_err_t set_rgb_color(uint16_t lightness);
+esp_err_t set_rgb888(uint32_t rgb);
+esp_err_t set_rgb48(uint16_t r, uint16_t g, uint16_t b);
+void pwm_calibration_default(pwm_calibration_t *cal);
+void pwm_set_calibration(const pwm_calibration_t *cal);
+
+// 整数色彩空间转换，输出每通道 16 位
+#define PWM_CCT_MIN 1000
+#define PWM_CCT_MAX 10000
+void pwm_hsv_to_rgb48(uint16_t hue, uint16_t sat, uint16_t val, uint16_t *r,
+                      uint16_t *g, uint16_t *b);
+void pwm_cct_to_rgb48(uint16_t kelvin, uint16_t brightness, uint16_t *r,
+                      uint16_t *g, uint16_t *b);
+
+void pwm_frame_stage(uint32_t channel, uint32_t duty);
+esp_err_t pwm_frame_commit(void);
+// 有帧因频率限制尚未提交时返回需要等待的毫秒数，否则返回 0
+uint32_t pwm_frame_pending_ms(void);
+void pwm_get_stats(pwm_stats_t *stats);
 #endif // USER_PWM_H
@@ -0,0 +1,202 @@
+#include "user_sched.h"
+#include <string.h>
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+static int sched_arg_valid(uint8_t action, const char *arg, int len) {
+    if (len <= 0 || len >= SCHED_ARG_SIZE) {
+        return 0;
+    }
+    // 参数要原样拼进命令，不能含有引号和分隔符
+    for (int i = 0; i < len; i++) {
+        if (arg[i] == '"' || arg[i] == '\\' || arg[i] == ',' ||
+            arg[i] == ':' || arg[i] < ' ') {
+            return 0;
+        }
+    }
+    switch (action) {
+    case SCHED_ACT_COLOR:
+    case SCHED_ACT_EFFECT:
+        return 1;
+    case SCHED_ACT_SCENE:
+        return len == 1 && arg[0] >= '1' && arg[0] <= '3';
+    default:
+        return 0;
+    }
+}
+
+// 文本和 flash 中的规则都要经过这里，执行时不再检查
+static int sched_rule_valid(const sched_rule_t *rule, const char *arg,
+                            int len) {
+    return rule->days != 0 && !(rule->days & ~SCHED_DAYS_ALL) &&
+           rule->minute < 24 * 60 && sched_arg_valid(rule->action, arg, len);
+}
+
+// 解析一条 "<星期>@<HHMM>=<动作><参数>"
+static int sched_parse_rule(const char *s, int len, sched_rule_t *rule) {
+    int d0, d1, hour, minute;
+
+    if (len < 10 || s[2] != '@' || s[7] != '=') {
+        return -1;
+    }
+    d0 = hex_digit(s[0]);
+    d1 = hex_digit(s[1]);
+    if (d0 < 0 || d1 < 0) {
+        return -1;
+    }
+    for (int i = 3; i < 7; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return -1;
+        }
+    }
+    hour = (s[3] - '0') * 10 + (s[4] - '0');
+    minute = (s[5] - '0') * 10 + (s[6] - '0');
+    rule->days = (d0 << 4) | d1;
+    rule->action = s[8];
+    rule->minute = hour * 60 + minute;
+    if (hour > 23 || minute > 59 ||
+        !sched_rule_valid(rule, s + 9, len - 9)) {
+        return -1;
+    }
+    memcpy(rule->arg, s + 9, len - 9);
+    rule->arg[len - 9] = '\0';
+    return 0;
+}
+
+// 空字符串或 "0" 清空规则表，任何一条规则出错则整体拒绝
+int sched_parse(const char *s, int len, sched_table_t *table) {
+    int pos = 0;
+
+    memset(table, 0, sizeof(*table));
+    if (len == 0 || (len == 1 && s[0] == '0')) {
+        return 0;
+    }
+    while (pos < len) {
+        const char *end = memchr(s + pos, '|', len - pos);
+        int rule_len = end ? end - (s + pos) : len - pos;
+        if (table->count >= SCHED_RULE_NUM ||
+            sched_parse_rule(s + pos, rule_len, &table->rules[table->count]) <
+                0) {
+            memset(table, 0, sizeof(*table));
+            return -1;
+        }
+        table->count++;
+        pos += rule_len + 1;
+    }
+    return table->count;
+}
+
+// 紧凑存储：版本、条数，每条为星期、分钟（小端）、动作、参数长度和参数
+int sched_pack(const sched_table_t *table, uint8_t *buf, int size) {
+    int pos = 2;
+
+    if (size < 2) {
+        return -1;
+    }
+    buf[0] = SCHED_BLOB_VERSION;
+    buf[1] = table->count;
+    for (int i = 0; i < table->count; i++) {
+        const sched_rule_t *rule = &table->rules[i];
+        int arg_len = strlen(rule->arg);
+        if (pos + 5 + arg_len > size) {
+            return -1;
+        }
+        buf[pos++] = rule->days;
+        buf[pos++] = rule->minute & 0xff;
+        buf[pos++] = rule->minute >> 8;
+        buf[pos++] = rule->action;
+        buf[pos++] = arg_len;
+        memcpy(buf + pos, rule->arg, arg_len);
+        pos += arg_len;
+    }
+    return pos;
+}
+
+int sched_unpack(const uint8_t *buf, int len, sched_table_t *table) {
+    int pos = 2;
+
+    memset(table, 0, sizeof(*table));
+    if (len < 2 || buf[0] != SCHED_BLOB_VERSION || buf[1] > SCHED_RULE_NUM) {
+        return -1;
+    }
+    for (int i = 0; i < buf[1]; i++) {
+        sched_rule_t *rule = &table->rules[i];
+        if (pos + 5 > len) {
+            goto fail;
+        }
+        int arg_len = buf[pos + 4];
+        if (pos + 5 + arg_len > len || arg_len >= SCHED_ARG_SIZE) {
+            goto fail;
+        }
+        rule->days = buf[pos];
+        rule->minute = buf[pos + 1] | (buf[pos + 2] << 8);
+        rule->action = buf[pos + 3];
+        // 旧版本或损坏的数据不能进入规则表
+        if (!sched_rule_valid(rule, (const char *)buf + pos + 5, arg_len)) {
+            goto fail;
+        }
+        memcpy(rule->arg, buf + pos + 5, arg_len);
+        rule->arg[arg_len] = '\0';
+        pos += 5 + arg_len;
+    }
+    table->count = buf[1];
+    return table->count;
+
+fail:
+    memset(table, 0, sizeof(*table));
+    return -1;
+}
+
+// 某条规则在 now 之后的第一次触发时刻
+static time_t sched_rule_next(const sched_rule_t *rule, const struct tm *local,
+                              time_t now) {
+    // 第 7 天覆盖只在今天生效、今天的时刻已过的规则
+    for (int d = 0; d <= 7; d++) {
+        if (!(rule->days & (1 << ((local->tm_wday + d) % 7)))) {
+            continue;
+        }
+        struct tm tm = *local;
+        tm.tm_mday += d;
+        tm.tm_hour = rule->minute / 60;
+        tm.tm_min = rule->minute % 60;
+        tm.tm_sec = 0;
+        tm.tm_isdst = -1;
+        time_t at = mktime(&tm);
+        if (at > now) {
+            return at;
+        }
+    }
+    return -1;
+}
+
+// 返回最近的触发时刻，due 为该时刻要执行的规则位图；没有规则返回 -1。
+// 规则最多 8 条，每条最多试 8 天，只在规则变化或触发后计算一次。
+time_t sched_next(const sched_table_t *table, time_t now, uint8_t *due) {
+    struct tm local;
+    time_t best = -1;
+
+    *due = 0;
+    localtime_r(&now, &local);
+    for (int i = 0; i < table->count; i++) {
+        time_t at = sched_rule_next(&table->rules[i], &local, now);
+        if (at < 0) {
+            continue;
+        }
+        if (best < 0 || at < best) {
+            best = at;
+            *due = 1 << i;
+        } else if (at == best) {
+            *due |= 1 << i;
+        }
+    }
+    return best;
+}
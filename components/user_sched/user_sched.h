@@ -0,0 +1,51 @@
+#ifndef USER_SCHED_H
+#define USER_SCHED_H
+
+/*
+ * 本地定时规则
+ * 纯 C 实现，不依赖 FreeRTOS。时间按 TZ 环境变量换算为本地时间，
+ * 夏令时由 mktime 处理：不存在的时刻顺延，重复的时刻只触发一次。
+ *
+ * 文本格式，规则之间用 '|' 分隔："<星期>@<HHMM>=<动作><参数>"
+ *   星期：两位十六进制位图，bit0 为星期日，"7f" 为每天
+ *   动作：c 颜色（与 lightNormal 格式相同），s 场景（1-3，取 lightSwitchN），
+ *         e 灯效（与 effect 格式相同）
+ * 例："3e@0700=c#ffc080|7f@2300=e500/000000"
+ */
+
+#include <stdint.h>
+#include <time.h>
+
+#define SCHED_RULE_NUM 8
+#define SCHED_ARG_SIZE 96
+#define SCHED_BLOB_VERSION 1
+#define SCHED_BLOB_MAX (2 + SCHED_RULE_NUM * (5 + SCHED_ARG_SIZE))
+#define SCHED_DAYS_ALL 0x7f
+
+typedef enum
+{
+    SCHED_ACT_COLOR = 'c',
+    SCHED_ACT_SCENE = 's',
+    SCHED_ACT_EFFECT = 'e',
+} sched_action_t;
+
+typedef struct
+{
+    uint8_t days;
+    uint8_t action;
+    uint16_t minute; // 本地时间，0-1439
+    char arg[SCHED_ARG_SIZE];
+} sched_rule_t;
+
+typedef struct
+{
+    uint8_t count;
+    sched_rule_t rules[SCHED_RULE_NUM];
+} sched_table_t;
+
+int sched_parse(const char *s, int len, sched_table_t *table);
+int sched_pack(const sched_table_t *table, uint8_t *buf, int size);
+int sched_unpack(const uint8_t *buf, int len, sched_table_t *table);
+time_t sched_next(const sched_table_t *table, time_t now, uint8_t *due);
+
+#endif // USER_SCHED_H
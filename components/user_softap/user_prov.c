@@ -0,0 +1,235 @@
+#include "user_prov.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "user_cmd.h"
+#include "user_net.h"
+#include "user_nvs.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "user prov"
+
+typedef struct
+{
+    int sock;
+    uint32_t seq;
+    TickType_t last_rx;
+    prov_rx_t rx;
+} prov_conn_t;
+
+static prov_conn_t s_conns[PROV_MAX_CLIENTS];
+
+static void prov_reply(prov_conn_t *conn, const char *reason) {
+    char ack[64];
+    int len;
+
+    if (reason == NULL) {
+        len = snprintf(ack, sizeof(ack), "ack:ok,seq:%u\n", conn->seq);
+    } else {
+        len = snprintf(ack, sizeof(ack), "ack:error,reason:%s,seq:%u\n", reason,
+                       conn->seq);
+    }
+    send(conn->sock, ack, len, 0);
+}
+
+// 配网命令没有认证，只接受经软 AP 接口、且设备仍处于 AP 模式时的连接。
+// STA 模式下局域网内任何主机都能连到本端口。
+static int prov_from_softap(int sock) {
+    wifi_mode_t mode;
+    struct sockaddr_in local;
+    socklen_t addr_len = sizeof(local);
+    tcpip_adapter_ip_info_t ap;
+
+    if (esp_wifi_get_mode(&mode) != ESP_OK || !(mode & WIFI_MODE_AP) ||
+        getsockname(sock, (struct sockaddr *)&local, &addr_len) != 0 ||
+        tcpip_adapter_get_ip_info(TCPIP_ADAPTER_IF_AP, &ap) != ESP_OK) {
+        return 0;
+    }
+    return local.sin_addr.s_addr == ap.ip.addr;
+}
+
+static void prov_handle_frame(const char *frame, int len, void *arg) {
+    prov_conn_t *conn = arg;
+
+    conn->seq++;
+    // 不记录内容，配网命令带有 Wi-Fi 密码
+    ESP_LOGI(TAG, "Frame %u from sock %d, %d bytes", conn->seq, conn->sock,
+             len);
+    // 局域网控制密钥只能经 MQTT 设置，不能在明文通道上下发
+    if (!prov_from_softap(conn->sock) ||
+        (parse_packet_keys(frame, len) & NVS_KEY_COMMAND(NVS_CMD_LAN_KEY))) {
+        ESP_LOGW(TAG, "Frame %u rejected", conn->seq);
+        prov_reply(conn, "forbidden");
+        return;
+    }
+    esp_err_t err = cmd_queue_post(CMD_SRC_TCP, frame, len);
+    if (err == ESP_OK) {
+        prov_reply(conn, NULL);
+    } else {
+        prov_reply(conn, err == ESP_ERR_NO_MEM ? "busy" : "invalid");
+    }
+    net_post_event(NET_EVT_AP_ACTIVITY);
+}
+
+static void prov_process(prov_conn_t *conn, int eof) {
+    if (prov_rx_process(&conn->rx, eof, prov_handle_frame, conn) < 0) {
+        conn->seq++;
+        prov_reply(conn, "too_long");
+    }
+}
+
+static void prov_close(prov_conn_t *conn) {
+    ESP_LOGI(TAG, "Close sock %d", conn->sock);
+    shutdown(conn->sock, 0);
+    close(conn->sock);
+    conn->sock = -1;
+}
+
+static void prov_accept(int listen_sock) {
+    struct sockaddr_in source_addr;
+    socklen_t addr_len = sizeof(source_addr);
+    int sock = accept(listen_sock, (struct sockaddr *)&source_addr, &addr_len);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
+        return;
+    }
+    if (!prov_from_softap(sock)) {
+        ESP_LOGW(TAG, "Socket %d not from softAP, rejecting", sock);
+        send(sock, "ack:error,reason:forbidden,seq:0\n", 33, 0);
+        close(sock);
+        return;
+    }
+
+    for (int i = 0; i < PROV_MAX_CLIENTS; i++) {
+        if (s_conns[i].sock < 0) {
+            s_conns[i].sock = sock;
+            s_conns[i].rx.len = 0;
+            s_conns[i].rx.discard = 0;
+            s_conns[i].seq = 0;
+            s_conns[i].last_rx = xTaskGetTickCount();
+            ESP_LOGI(TAG, "Socket %d accepted", sock);
+            net_post_event(NET_EVT_AP_ACTIVITY);
+            return;
+        }
+    }
+    ESP_LOGW(TAG, "Too many clients, rejecting");
+    send(sock, "ack:error,reason:busy,seq:0\n", 28, 0);
+    close(sock);
+}
+
+static void prov_receive(prov_conn_t *conn) {
+    prov_rx_t *rx = &conn->rx;
+    int len = recv(conn->sock, rx->buf + rx->len, PROV_RX_SIZE - rx->len, 0);
+    if (len < 0) {
+        ESP_LOGE(TAG, "recv failed: errno %d", errno);
+        prov_close(conn);
+    } else if (len == 0) {
+        prov_process(conn, 1);
+        prov_close(conn);
+    } else {
+        rx->len += len;
+        conn->last_rx = xTaskGetTickCount();
+        prov_process(conn, 0);
+    }
+}
+
+static int prov_listen(void) {
+    struct sockaddr_in dest_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(PROV_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+
+    int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (listen_sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        return -1;
+    }
+    if (bind(listen_sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr)) !=
+            0 ||
+        listen(listen_sock, PROV_MAX_CLIENTS) != 0) {
+        ESP_LOGE(TAG, "Socket unable to bind/listen: errno %d", errno);
+        close(listen_sock);
+        return -1;
+    }
+    ESP_LOGI(TAG, "Listening on port %d", PROV_PORT);
+    return listen_sock;
+}
+
+static void prov_server_task(void *pvParameters) {
+    int listen_sock;
+
+    for (int i = 0; i < PROV_MAX_CLIENTS; i++) {
+        s_conns[i].sock = -1;
+    }
+    while ((listen_sock = prov_listen()) < 0) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    while (1) {
+        fd_set rfds;
+        int max_fd = listen_sock;
+        TickType_t now = xTaskGetTickCount();
+        TickType_t idle = pdMS_TO_TICKS(PROV_IDLE_TIMEOUT_MS);
+        TickType_t wait = idle;
+        int clients = 0;
+
+        FD_ZERO(&rfds);
+        FD_SET(listen_sock, &rfds);
+        for (int i = 0; i < PROV_MAX_CLIENTS; i++) {
+            prov_conn_t *conn = &s_conns[i];
+            if (conn->sock < 0) {
+                continue;
+            }
+            TickType_t age = now - conn->last_rx;
+            if (age >= idle) {
+                ESP_LOGI(TAG, "Sock %d idle", conn->sock);
+                prov_close(conn);
+                continue;
+            }
+            if (idle - age < wait) {
+                wait = idle - age;
+            }
+            FD_SET(conn->sock, &rfds);
+            if (conn->sock > max_fd) {
+                max_fd = conn->sock;
+            }
+            clients++;
+        }
+
+        // 没有客户端时无需超时，一直等待新连接
+        struct timeval tv = {
+            .tv_sec = wait * portTICK_PERIOD_MS / 1000,
+            .tv_usec = (wait * portTICK_PERIOD_MS % 1000) * 1000,
+        };
+        int ready = select(max_fd + 1, &rfds, NULL, NULL, clients ? &tv : NULL);
+        if (ready < 0) {
+            ESP_LOGE(TAG, "select failed: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        for (int i = 0; i < PROV_MAX_CLIENTS; i++) {
+            if (s_conns[i].sock >= 0 && FD_ISSET(s_conns[i].sock, &rfds)) {
+                prov_receive(&s_conns[i]);
+            }
+        }
+        if (FD_ISSET(listen_sock, &rfds)) {
+            prov_accept(listen_sock);
+        }
+    }
+}
+
+// 重复调用无效，避免第二个任务再绑定同一端口
+void prov_server_start(void) {
+    static int started;
+
+    if (started) {
+        return;
+    }
+    started = 1;
+    xTaskCreate(prov_server_task, "prov_server", 4096, NULL, 5, NULL);
+}
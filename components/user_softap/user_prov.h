@@ -0,0 +1,29 @@
+#ifndef USER_PROV_H
+#define USER_PROV_H
+
+#define PROV_PORT 3333
+#define PROV_MAX_CLIENTS 3
+#define PROV_RX_SIZE 512            // 每个连接的重组缓冲区
+#define PROV_IDLE_TIMEOUT_MS 60000  // 空闲连接超时关闭
+
+// 帧格式：一行一条命令（以 '\n' 结尾），或以 '{' 开头、括号配平的 JSON 对象。
+// 每条命令回复一行 "ack:ok,seq:N" 或 "ack:error,reason:...,seq:N"。
+// 只接受来自软 AP 接口的连接，STA 模式下回复 forbidden；lankey 一律拒绝。
+
+typedef void (*prov_frame_cb_t)(const char *frame, int len, void *arg);
+
+// 每个连接的接收缓冲区，recv 追加到 buf + len 之后交给 prov_rx_process
+typedef struct
+{
+    int len;
+    int discard; // 超长帧，丢弃到下一帧结束
+    char buf[PROV_RX_SIZE];
+} prov_rx_t;
+
+int prov_frame_next(const char *buf, int len, int *start, int *frame_len);
+// 对缓冲区中每个完整的帧调用 cb，剩余部分移到开头；eof 时剩余内容作为最后一帧。
+// 缓冲区满仍没有完整帧时清空并返回 -1
+int prov_rx_process(prov_rx_t *rx, int eof, prov_frame_cb_t cb, void *arg);
+void prov_server_start(void);
+
+#endif // USER_PROV_H
@@ -0,0 +1,89 @@
+#include "user_prov.h"
+#include <string.h>
+
+// 帧切分和重组缓冲区，不依赖 socket，可以在主机上测试
+
+// 在 buf 中找下一帧，返回值为已消耗的字节数；找到帧时 *frame_len > 0。
+// 帧前的空白被跳过，没有完整帧时返回跳过的空白长度。
+int prov_frame_next(const char *buf, int len, int *start, int *frame_len) {
+    int i = 0;
+
+    *frame_len = 0;
+    while (i < len && (buf[i] == '\n' || buf[i] == '\r' || buf[i] == ' ' ||
+                       buf[i] == '\t')) {
+        i++;
+    }
+    *start = i;
+    if (i >= len) {
+        return i;
+    }
+
+    if (buf[i] == '{') {
+        int depth = 0;
+        int in_str = 0;
+        for (int j = i; j < len; j++) {
+            char c = buf[j];
+            if (in_str) {
+                if (c == '\\') {
+                    j++;
+                } else if (c == '"') {
+                    in_str = 0;
+                }
+            } else if (c == '"') {
+                in_str = 1;
+            } else if (c == '{') {
+                depth++;
+            } else if (c == '}' && --depth == 0) {
+                *frame_len = j + 1 - i;
+                return j + 1;
+            }
+        }
+        return i;
+    }
+
+    const char *nl = memchr(buf + i, '\n', len - i);
+    if (nl == NULL) {
+        return i;
+    }
+    int end = nl - buf;
+    *frame_len = end - i;
+    if (*frame_len > 0 && buf[end - 1] == '\r') {
+        (*frame_len)--;
+    }
+    return end + 1;
+}
+
+int prov_rx_process(prov_rx_t *rx, int eof, prov_frame_cb_t cb, void *arg) {
+    int pos = 0;
+
+    while (pos < rx->len) {
+        int start, frame_len;
+        int used = prov_frame_next(rx->buf + pos, rx->len - pos, &start,
+                                   &frame_len);
+        if (frame_len == 0) {
+            pos += used;
+            break;
+        }
+        if (rx->discard) {
+            rx->discard = 0;
+        } else {
+            cb(rx->buf + pos + start, frame_len, arg);
+        }
+        pos += used;
+    }
+    // 兼容不带换行的旧客户端：连接关闭时剩余内容作为最后一帧
+    if (eof && pos < rx->len && !rx->discard) {
+        cb(rx->buf + pos, rx->len - pos, arg);
+        pos = rx->len;
+    }
+    memmove(rx->buf, rx->buf + pos, rx->len - pos);
+    rx->len -= pos;
+
+    if (rx->len == PROV_RX_SIZE) {
+        // 缓冲区满仍没有完整帧，丢弃到下一帧结束
+        rx->len = 0;
+        rx->discard = 1;
+        return -1;
+    }
+    return 0;
+}
@@ -8,26 +8,21 @@
 #include "lwip/netdb.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
+#include "user_net.h"
 #include "user_nvs.h"
+#include "user_prov.h"
 #include "user_softap.h"
 #include <string.h>
 
 #define EXAMPLE_ESP_WIFI_SSID "honoka"
 #define EXAMPLE_ESP_WIFI_PASS "12345678"
 #define EXAMPLE_MAX_STA_CONN 2
-#define PORT 3333
-#define MAX_PACKETS 4
-#define MAX_PACKET_SIZE 128
 static const char *TAG = "wifi softAP";
 
-user_softap_state_t user_softap_state;
-
-static void tcp_server_task(void *pvParameters);
-
 static void wifi_event_handler(void *arg, esp_event_base_t event_base,
                                int32_t event_id, void *event_data) {
     if (event_id == WIFI_EVENT_AP_STACONNECTED) {
-        user_softap_state.newDeviceConnect = true;
+        net_post_event(NET_EVT_AP_ACTIVITY);
         wifi_event_ap_staconnected_t *event =
             (wifi_event_ap_staconnected_t *)event_data;
         ESP_LOGI(TAG, "station " MACSTR " join, AID=%d", MAC2STR(event->mac),
@@ -73,80 +68,7 @@ void wifi_init_softap() {
     ESP_LOGI(TAG, "wifi_init_softap finished. SSID:%s password:%s",
              user_ssid, EXAMPLE_ESP_WIFI_PASS);
 
-    xTaskCreate(tcp_server_task, "tcp_server", 4096, NULL, 5, NULL);
-}
-
-void tcp_server_task(void *pvParameters) {
-    char rx_buffer[128];
-    char addr_str[128];
-    int addr_family;
-    int ip_protocol;
-
-    while (1) {
-        struct sockaddr_in dest_addr;
-        dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        dest_addr.sin_family = AF_INET;
-        dest_addr.sin_port = htons(PORT);
-        addr_family = AF_INET;
-        ip_protocol = IPPROTO_IP;
-        inet_ntoa_r(dest_addr.sin_addr, addr_str, sizeof(addr_str) - 1);
-
-        int listen_sock = socket(addr_family, SOCK_STREAM, ip_protocol);
-        if (listen_sock < 0) {
-            ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
-            break;
-        }
-        ESP_LOGI(TAG, "Socket created");
-
-        int err =
-            bind(listen_sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr));
-        if (err != 0) {
-            ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
-            break;
-        }
-        ESP_LOGI(TAG, "Socket bound, port %d", PORT);
-
-        err = listen(listen_sock, 1);
-        if (err != 0) {
-            ESP_LOGE(TAG, "Error occurred during listen: errno %d", errno);
-            break;
-        }
-        ESP_LOGI(TAG, "Socket listening");
-
-        while (1) {
-            struct sockaddr_in source_addr;
-            uint addr_len = sizeof(source_addr);
-            int sock =
-                accept(listen_sock, (struct sockaddr *)&source_addr, &addr_len);
-            if (sock < 0) {
-                ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
-                break;
-            }
-            ESP_LOGI(TAG, "Socket accepted");
-            user_softap_state.newDeviceBindTCP = true;
-            while (1) {     
-                int len = recv(sock, rx_buffer, sizeof(rx_buffer) - 1, 0);
-                if (len < 0) {
-                    ESP_LOGE(TAG, "recv failed: errno %d", errno);
-                    break;
-                } else if (len == 0) {
-                    ESP_LOGI(TAG, "Connection closed");
-                    break;
-                } else {
-                    rx_buffer[len] = 0;
-                    ESP_LOGI(TAG, "Received %d bytes: %s", len, rx_buffer);
-                    parse_data_packet(rx_buffer, len, &nvs_data);
-                }
-            }
-
-            if (sock != -1) {
-                ESP_LOGE(TAG, "Shutting down socket and restarting...");
-                shutdown(sock, 0);
-                close(sock);
-            }
-        }
-    }
-    vTaskDelete(NULL);
+    prov_server_start();
 }
 
 void wifi_deinit_softap() {
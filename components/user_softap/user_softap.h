@@ -2,13 +2,6 @@
 #define __USER_SOFTAP_H__
 
 #define SOFTAP_TIMEOUT 60
-typedef struct 
-{
-    /* data */
-    bool newDeviceConnect;
-    bool newDeviceBindTCP;
-}user_softap_state_t;
-extern user_softap_state_t user_softap_state;
 
 void wifi_init_softap();
 void wifi_deinit_softap();
@@ -0,0 +1,246 @@
+#include "user_sync.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "user_config.h"
+#include "user_nvs.h"
+#include "user_prof.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "user sync"
+
+// 同步任务在 s_work 上计算，完成后整体拷贝到 s_est 供灯光任务读取，
+// 避免在临界区内做包络计算
+static sync_est_t s_work;
+static sync_est_t s_est;
+static int64_t s_step_us;
+static sync_stats_t s_stats;
+
+static int64_t sync_offset_us(int64_t local_us) {
+    portENTER_CRITICAL();
+    int64_t offset = sync_est_offset(&s_est, local_us);
+    portEXIT_CRITICAL();
+    return offset;
+}
+
+// 未同步时等于本地时钟
+uint32_t sync_now_ms(void) {
+    int64_t local = esp_timer_get_time();
+    return (uint32_t)((local + sync_offset_us(local)) / 1000);
+}
+
+// 向上取到下一个网格点，同一网格内收到同一条房间命令的灯从同一时刻开始
+uint32_t sync_align_ms(uint32_t now_ms) {
+    return (now_ms / SYNC_ALIGN_MS + 1) * SYNC_ALIGN_MS;
+}
+
+// 返回上次调用以来共享时钟的跳变量，调用者据此平移已有的时间基准
+int32_t sync_take_step_ms(void) {
+    portENTER_CRITICAL();
+    int64_t step = s_step_us;
+    s_step_us = 0;
+    portEXIT_CRITICAL();
+    return (int32_t)(step / 1000);
+}
+
+void sync_get_stats(sync_stats_t *stats) {
+    portENTER_CRITICAL();
+    *stats = s_stats;
+    stats->drift_ppb = s_est.drift_ppb;
+    portEXIT_CRITICAL();
+}
+
+static int parse_hex(const char *s, int len, uint32_t *value) {
+    *value = 0;
+    for (int i = 0; i < len; i++) {
+        char c = s[i];
+        int d;
+        if (c >= '0' && c <= '9') {
+            d = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            d = c - 'a' + 10;
+        } else {
+            return -1;
+        }
+        *value = (*value << 4) | d;
+    }
+    return 0;
+}
+
+// "T " + 8 位编号 + " " + 16 位时间 + " " + 房间号
+#define SYNC_HEADER_LEN 28
+
+static int sync_parse_beacon(const char *buf, int len, uint32_t *id,
+                             int64_t *shared_us) {
+    uint32_t hi, lo;
+    int room_len = strlen(nvs_data.roomID);
+
+    if (len != SYNC_HEADER_LEN + room_len || buf[0] != 'T' || buf[1] != ' ' ||
+        buf[10] != ' ' || buf[27] != ' ' ||
+        memcmp(buf + SYNC_HEADER_LEN, nvs_data.roomID, room_len) != 0 ||
+        parse_hex(buf + 2, 8, id) != 0 || parse_hex(buf + 11, 8, &hi) != 0 ||
+        parse_hex(buf + 19, 8, &lo) != 0) {
+        return -1;
+    }
+    *shared_us = (int64_t)(((uint64_t)hi << 32) | lo);
+    return 0;
+}
+
+static void sync_send_beacon(int sock, uint32_t id) {
+    struct sockaddr_in group = {
+        .sin_family = AF_INET,
+        .sin_port = htons(SYNC_PORT),
+        .sin_addr.s_addr = inet_addr(SYNC_GROUP),
+    };
+    char buf[SYNC_HEADER_LEN + NVS_STORAGE_MAX];
+
+    int64_t local = esp_timer_get_time();
+    uint64_t shared = local + sync_offset_us(local);
+    int len = snprintf(buf, sizeof(buf), "T %08x %08x%08x %s", id,
+                       (uint32_t)(shared >> 32), (uint32_t)shared,
+                       nvs_data.roomID);
+    if (sendto(sock, buf, len, 0, (struct sockaddr *)&group, sizeof(group)) <
+        0) {
+        ESP_LOGW(TAG, "Beacon send failed: errno %d", errno);
+        return;
+    }
+    s_stats.beacons_sent++;
+}
+
+static void sync_handle_beacon(sync_elect_t *el, const char *buf, int len,
+                               int64_t local_us) {
+    uint32_t id;
+    int64_t shared_us;
+
+    if (sync_parse_beacon(buf, len, &id, &shared_us) != 0) {
+        return;
+    }
+    s_stats.beacons_received++;
+    sync_beacon_t kind = sync_elect_on_beacon(el, id, local_us);
+    if (kind == SYNC_BEACON_IGNORE) {
+        return;
+    }
+    if (kind == SYNC_BEACON_NEW_LEADER) {
+        ESP_LOGI(TAG, "Following leader %08x", id);
+    }
+
+    int64_t step = 0;
+    int64_t before = sync_est_offset(&s_work, local_us);
+    if (kind == SYNC_BEACON_NEW_LEADER) {
+        sync_est_new_source(&s_work);
+    }
+    sync_est_result_t result = sync_est_sample(&s_work, local_us, shared_us);
+    if (result == SYNC_EST_NONE) {
+        return;
+    }
+    if (result == SYNC_EST_STEPPED) {
+        step = sync_est_offset(&s_work, local_us) - before;
+    }
+    portENTER_CRITICAL();
+    s_est = s_work;
+    s_step_us += step;
+    s_stats.steps += result == SYNC_EST_STEPPED;
+    portEXIT_CRITICAL();
+    if (result == SYNC_EST_STEPPED) {
+        ESP_LOGI(TAG, "Shared clock stepped by %d ms", (int)(step / 1000));
+        config_notify(CONFIG_NOTIFY_SYNC);
+    }
+}
+
+static int sync_bind(void) {
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(SYNC_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    struct ip_mreq mreq = {
+        .imr_multiaddr.s_addr = inet_addr(SYNC_GROUP),
+        .imr_interface.s_addr = htonl(INADDR_ANY),
+    };
+    uint8_t ttl = 1;
+    uint8_t loop = 0;
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        return -1;
+    }
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) !=
+            0) {
+        ESP_LOGE(TAG, "Socket unable to bind/join: errno %d", errno);
+        close(sock);
+        return -1;
+    }
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    setsockopt(sock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+    ESP_LOGI(TAG, "Joined %s:%d", SYNC_GROUP, SYNC_PORT);
+    return sock;
+}
+
+static void sync_task(void *pvParameters) {
+    static char buf[SYNC_HEADER_LEN + NVS_STORAGE_MAX];
+    sync_elect_t el;
+    int sock;
+
+    // 编号取 MAC 低 4 字节，不能为 0
+    uint32_t id = (mac[2] << 24) | (mac[3] << 16) | (mac[4] << 8) | mac[5];
+    if (id == 0) {
+        id = 1;
+    }
+    while ((sock = sync_bind()) < 0) {
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    sync_elect_init(&el, id, esp_timer_get_time());
+    int64_t next_beacon = 0;
+    while (1) {
+        int64_t now = esp_timer_get_time();
+        sync_role_t role = sync_elect_tick(&el, now);
+        if (role != s_stats.role) {
+            ESP_LOGI(TAG, "Role %d -> %d", s_stats.role, role);
+            s_stats.role = role;
+        }
+
+        int64_t wait_us = (int64_t)SYNC_BEACON_MS * 1000;
+        if (role == SYNC_ROLE_LEADER) {
+            if (now >= next_beacon) {
+                sync_send_beacon(sock, id);
+                next_beacon = now + wait_us;
+            }
+            wait_us = next_beacon - now;
+        }
+
+        fd_set rfds;
+        FD_ZERO(&rfds);
+        FD_SET(sock, &rfds);
+        struct timeval tv = {
+            .tv_sec = wait_us / 1000000,
+            .tv_usec = wait_us % 1000000,
+        };
+        int ready = select(sock + 1, &rfds, NULL, NULL, &tv);
+        prof_wakeup(PROF_TASK_SYNC);
+        if (ready <= 0) {
+            continue;
+        }
+        int len = recvfrom(sock, buf, sizeof(buf), 0, NULL, NULL);
+        int64_t local_us = esp_timer_get_time();
+        if (len > 0) {
+            sync_handle_beacon(&el, buf, len, local_us);
+        }
+    }
+}
+
+// 第一次获得 IP 后调用，重复调用无效；未配置房间号时不参与同步
+void sync_start(void) {
+    static int started;
+
+    if (started || strcmp(nvs_data.roomID, "default") == 0) {
+        return;
+    }
+    started = 1;
+    xTaskCreate(sync_task, "room_sync", 3072, NULL, 7, NULL);
+}
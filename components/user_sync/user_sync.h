@@ -0,0 +1,34 @@
+#ifndef USER_SYNC_H
+#define USER_SYNC_H
+
+#include <stdint.h>
+#include "user_sync_est.h"
+
+/*
+ * 房间内多灯时钟同步
+ * 同一房间的灯通过组播选出编号最小的一盏作为主节点，每秒广播一次共享时钟，
+ * 其他灯估计偏移和漂移。闪烁相位和灯效起点都以共享时钟为准。
+ *
+ * 广播："T <id> <shared_us 16 位十六进制> <roomID>"
+ */
+
+#define SYNC_GROUP "239.255.51.76"
+#define SYNC_PORT 3335
+#define SYNC_ALIGN_MS 250 // 灯效起点对齐到共享时钟的网格
+
+typedef struct
+{
+    uint32_t beacons_sent;
+    uint32_t beacons_received;
+    uint32_t steps;      // 共享时钟跳变次数
+    int32_t drift_ppb;
+    uint8_t role;        // sync_role_t
+} sync_stats_t;
+
+void sync_start(void);
+uint32_t sync_now_ms(void);
+uint32_t sync_align_ms(uint32_t now_ms);
+int32_t sync_take_step_ms(void);
+void sync_get_stats(sync_stats_t *stats);
+
+#endif // USER_SYNC_H
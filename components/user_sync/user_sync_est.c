@@ -0,0 +1,173 @@
+#include "user_sync_est.h"
+#include <string.h>
+
+void sync_est_init(sync_est_t *est) {
+    memset(est, 0, sizeof(*est));
+}
+
+// 样本来源变化：模型保留，历史样本和漂移参考点清空，攒够样本前按原模型外推
+void sync_est_new_source(sync_est_t *est) {
+    est->count = 0;
+    est->head = 0;
+    est->low_count = 0;
+    est->since_checkpoint = 0;
+    est->checkpoint_count = 0;
+    est->checkpoint_head = 0;
+}
+
+int64_t sync_est_offset(const sync_est_t *est, int64_t local_us) {
+    if (!est->locked) {
+        return 0;
+    }
+    return est->anchor_offset_us +
+           (local_us - est->anchor_local_us) * est->drift_ppb / 1000000000;
+}
+
+// 第 i 旧的样本
+static const sync_sample_t *sync_est_at(const sync_est_t *est, int i) {
+    int index = est->head - est->count + i;
+    if (index < 0) {
+        index += SYNC_HISTORY;
+    }
+    return &est->hist[index];
+}
+
+// 包络点的误差有几毫秒，几十秒内算出的斜率误差太大，
+// 所以漂移用约两分钟前后的包络点估计，参考点攒满之前按 0 处理
+static void sync_est_checkpoint(sync_est_t *est) {
+    if (++est->since_checkpoint < SYNC_HISTORY / 2) {
+        return;
+    }
+    est->since_checkpoint = 0;
+    sync_sample_t *cp = &est->checkpoints[est->checkpoint_head];
+    cp->local_us = est->anchor_local_us;
+    cp->offset_us = est->anchor_offset_us;
+    est->checkpoint_head = (est->checkpoint_head + 1) % SYNC_CHECKPOINTS;
+    if (est->checkpoint_count < SYNC_CHECKPOINTS) {
+        est->checkpoint_count++;
+        return;
+    }
+
+    // 环满时 head 指向最旧的参考点
+    const sync_sample_t *old = &est->checkpoints[est->checkpoint_head];
+    int64_t dt = cp->local_us - old->local_us;
+    if (dt <= 0) {
+        return;
+    }
+    // 参考点按当前漂移投影过，斜率是对当前估计的修正量
+    int64_t d = est->drift_ppb + (cp->offset_us - old->offset_us -
+                                  dt * est->drift_ppb / 1000000000) *
+                                     1000000000 / dt;
+    if (d > SYNC_DRIFT_MAX_PPB) {
+        d = SYNC_DRIFT_MAX_PPB;
+    } else if (d < -SYNC_DRIFT_MAX_PPB) {
+        d = -SYNC_DRIFT_MAX_PPB;
+    }
+    est->drift_ppb += (int32_t)(d - est->drift_ppb) / 4;
+}
+
+static void sync_est_push(sync_est_t *est, int64_t local_us, int64_t offset) {
+    est->hist[est->head].local_us = local_us;
+    est->hist[est->head].offset_us = offset;
+    est->head = (est->head + 1) % SYNC_HISTORY;
+    if (est->count < SYNC_HISTORY) {
+        est->count++;
+    }
+}
+
+// remote_us 为主节点发送时的共享时钟，样本偏移 = 真实偏移 - 单程时延。
+// 时延只会让样本偏小，所以取补偿漂移后的上包络，抖动和 DTIM 缓存造成的
+// 延迟只影响被包络忽略的样本。
+sync_est_result_t sync_est_sample(sync_est_t *est, int64_t local_us,
+                                  int64_t remote_us) {
+    int64_t offset = remote_us - local_us;
+    int64_t error = offset - sync_est_offset(est, local_us);
+
+    // 偏大只能是时钟跳变；偏小可能只是延迟，连续出现才认为跳变
+    if (est->locked && error < -SYNC_STEP_US) {
+        if (++est->low_count < SYNC_MIN_SAMPLES) {
+            return SYNC_EST_NONE;
+        }
+    } else {
+        est->low_count = 0;
+    }
+    if (est->locked && (error > SYNC_STEP_US || error < -SYNC_STEP_US)) {
+        sync_est_new_source(est);
+        sync_est_push(est, local_us, offset);
+        est->anchor_local_us = local_us;
+        est->anchor_offset_us = offset;
+        return SYNC_EST_STEPPED;
+    }
+
+    sync_est_push(est, local_us, offset);
+    if (est->count < SYNC_MIN_SAMPLES) {
+        return SYNC_EST_NONE;
+    }
+
+    int64_t top = INT64_MIN;
+    for (int i = 0; i < est->count; i++) {
+        const sync_sample_t *s = sync_est_at(est, i);
+        int64_t projected =
+            s->offset_us +
+            (local_us - s->local_us) * est->drift_ppb / 1000000000;
+        if (projected > top) {
+            top = projected;
+        }
+    }
+    est->anchor_local_us = local_us;
+    est->anchor_offset_us = top;
+    sync_est_checkpoint(est);
+    if (!est->locked) {
+        est->locked = 1;
+        return SYNC_EST_STEPPED;
+    }
+    return SYNC_EST_UPDATED;
+}
+
+void sync_elect_init(sync_elect_t *el, uint32_t self_id, int64_t now_us) {
+    memset(el, 0, sizeof(*el));
+    el->self_id = self_id;
+    el->role = SYNC_ROLE_LISTEN;
+    el->start_us = now_us;
+}
+
+// 编号最小的节点当主节点。监听期间也跟随编号更大的主节点，
+// 这样自己接任后沿用房间原有的时钟，其他灯不会跳变。
+sync_beacon_t sync_elect_on_beacon(sync_elect_t *el, uint32_t sender_id,
+                                   int64_t now_us) {
+    if (sender_id == el->self_id || sender_id == 0) {
+        return SYNC_BEACON_IGNORE;
+    }
+    if (el->role == SYNC_ROLE_LEADER && sender_id > el->self_id) {
+        return SYNC_BEACON_IGNORE;
+    }
+
+    int stale = now_us - el->last_beacon_us >=
+                (int64_t)SYNC_LEADER_TIMEOUT_MS * 1000;
+    if (sender_id == el->leader_id && !stale) {
+        el->last_beacon_us = now_us;
+        return SYNC_BEACON_SAMPLE;
+    }
+    if (el->leader_id == 0 || stale || sender_id < el->leader_id) {
+        el->leader_id = sender_id;
+        el->last_beacon_us = now_us;
+        if (sender_id < el->self_id) {
+            el->role = SYNC_ROLE_FOLLOWER;
+        }
+        return SYNC_BEACON_NEW_LEADER;
+    }
+    return SYNC_BEACON_IGNORE;
+}
+
+sync_role_t sync_elect_tick(sync_elect_t *el, int64_t now_us) {
+    if (el->leader_id != 0 && now_us - el->last_beacon_us >=
+                                  (int64_t)SYNC_LEADER_TIMEOUT_MS * 1000) {
+        el->leader_id = 0;
+    }
+    if (el->role != SYNC_ROLE_LEADER &&
+        now_us - el->start_us >= (int64_t)SYNC_LISTEN_MS * 1000 &&
+        (el->leader_id == 0 || el->self_id < el->leader_id)) {
+        el->role = SYNC_ROLE_LEADER;
+    }
+    return el->role;
+}
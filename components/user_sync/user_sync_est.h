@@ -0,0 +1,81 @@
+#ifndef USER_SYNC_EST_H
+#define USER_SYNC_EST_H
+
+#include <stdint.h>
+
+// 房间内时钟同步的选主和偏移估计，不依赖 FreeRTOS，时间由调用者以微秒传入
+
+#define SYNC_BEACON_MS 1000         // 主节点广播间隔
+#define SYNC_LEADER_TIMEOUT_MS 3500 // 多久没收到主节点广播视为离线
+#define SYNC_LISTEN_MS 3000         // 启动后先监听，沿用房间已有的时钟
+#define SYNC_HISTORY 32             // 保留最近的样本数，约 32 秒
+#define SYNC_MIN_SAMPLES 4          // 至少这么多样本才锁定
+#define SYNC_CHECKPOINTS 8          // 每 SYNC_HISTORY/2 个样本记一次偏移，用于估计漂移
+#define SYNC_STEP_US 500000         // 偏差超过该值视为主节点时钟跳变，需大于 DTIM 缓存延迟
+#define SYNC_DRIFT_MAX_PPB 200000   // 晶振漂移估计上限，200 ppm
+
+typedef enum
+{
+    SYNC_ROLE_LISTEN = 0,
+    SYNC_ROLE_FOLLOWER,
+    SYNC_ROLE_LEADER,
+} sync_role_t;
+
+typedef enum
+{
+    SYNC_EST_NONE = 0, // 样本已记录，模型未变
+    SYNC_EST_UPDATED,  // 偏移和漂移平滑更新
+    SYNC_EST_STEPPED,  // 首次锁定或主节点时钟跳变，共享时钟跳变
+} sync_est_result_t;
+
+typedef struct
+{
+    int64_t local_us;
+    int64_t offset_us; // 主节点共享时钟 - 本地接收时刻
+} sync_sample_t;
+
+// 共享时钟 = 本地时钟 + offset，offset 随漂移线性变化
+typedef struct
+{
+    uint8_t locked;
+    uint8_t count;
+    uint8_t head;
+    uint8_t low_count; // 连续明显偏小的样本数
+    uint8_t since_checkpoint;
+    uint8_t checkpoint_count;
+    uint8_t checkpoint_head;
+    int32_t drift_ppb;
+    int64_t anchor_local_us;
+    int64_t anchor_offset_us;
+    sync_sample_t hist[SYNC_HISTORY];
+    sync_sample_t checkpoints[SYNC_CHECKPOINTS];
+} sync_est_t;
+
+typedef struct
+{
+    uint32_t self_id;
+    uint32_t leader_id; // 0 表示没有可跟随的主节点
+    sync_role_t role;
+    int64_t start_us;
+    int64_t last_beacon_us;
+} sync_elect_t;
+
+typedef enum
+{
+    SYNC_BEACON_IGNORE = 0,
+    SYNC_BEACON_SAMPLE,     // 来自当前主节点
+    SYNC_BEACON_NEW_LEADER, // 换了主节点，样本同样有效
+} sync_beacon_t;
+
+void sync_est_init(sync_est_t *est);
+void sync_est_new_source(sync_est_t *est);
+sync_est_result_t sync_est_sample(sync_est_t *est, int64_t local_us,
+                                  int64_t remote_us);
+int64_t sync_est_offset(const sync_est_t *est, int64_t local_us);
+
+void sync_elect_init(sync_elect_t *el, uint32_t self_id, int64_t now_us);
+sync_beacon_t sync_elect_on_beacon(sync_elect_t *el, uint32_t sender_id,
+                                   int64_t now_us);
+sync_role_t sync_elect_tick(sync_elect_t *el, int64_t now_us);
+
+#endif // USER_SYNC_EST_H
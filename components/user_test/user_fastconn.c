@@ -0,0 +1,99 @@
+#include "user_fastconn.h"
+#include <string.h>
+
+static uint32_t fastconn_hash(const char *ssid, const char *pass) {
+    uint32_t hash = 2166136261u;
+    for (const char *p = ssid; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    hash = (hash ^ 0) * 16777619u; // 分隔，避免 "ab"+"c" 与 "a"+"bc" 相同
+    for (const char *p = pass; *p; p++) {
+        hash = (hash ^ (uint8_t)*p) * 16777619u;
+    }
+    return hash;
+}
+
+static int fastconn_cache_valid(const fastconn_t *fc) {
+    return fc->cache.version == FASTCONN_VERSION &&
+           fc->cache.cred_hash == fc->cred_hash && fc->cache.channel != 0;
+}
+
+// stored 为 NULL 表示没有读到缓存
+void fastconn_init(fastconn_t *fc, const fastconn_cache_t *stored,
+                   const char *ssid, const char *pass, int reuse_lease) {
+    memset(fc, 0, sizeof(*fc));
+    fc->cred_hash = fastconn_hash(ssid, pass);
+    fc->reuse_lease = reuse_lease;
+    if (stored != NULL) {
+        fc->cache = *stored;
+    }
+    fc->mode = fastconn_cache_valid(fc) ? FASTCONN_CACHED : FASTCONN_SCAN;
+}
+
+void fastconn_plan(const fastconn_t *fc, fastconn_plan_t *plan) {
+    memset(plan, 0, sizeof(*plan));
+    plan->mode = fc->mode;
+    if (fc->mode != FASTCONN_CACHED) {
+        return;
+    }
+    memcpy(plan->bssid, fc->cache.bssid, sizeof(plan->bssid));
+    plan->channel = fc->cache.channel;
+    // 第一次失败后就不再复用租约，避免地址冲突时一直连不上
+    if (fc->reuse_lease && fc->failures == 0 && fc->cache.ip != 0) {
+        plan->static_ip = 1;
+        plan->ip = fc->cache.ip;
+        plan->netmask = fc->cache.netmask;
+        plan->gw = fc->cache.gw;
+        memcpy(plan->dns, fc->cache.dns, sizeof(plan->dns));
+        if (plan->dns[0] == 0) {
+            plan->dns[0] = plan->gw;
+        }
+    }
+}
+
+// 连接失败，返回 1 表示方案变化，需要重新配置后再连接
+int fastconn_on_fail(fastconn_t *fc) {
+    fc->failures++;
+    if (fc->mode == FASTCONN_CACHED) {
+        if (fc->failures >= FASTCONN_CACHED_RETRY) {
+            fc->mode = FASTCONN_SCAN;
+            return 1;
+        }
+        return fc->failures == 1 && fc->reuse_lease && fc->cache.ip != 0;
+    }
+    return 0;
+}
+
+// 关联成功，返回 1 表示缓存需要保存
+int fastconn_on_connected(fastconn_t *fc, const uint8_t bssid[6],
+                          int channel) {
+    int changed = !fastconn_cache_valid(fc) ||
+                  memcmp(fc->cache.bssid, bssid, 6) != 0 ||
+                  fc->cache.channel != channel;
+
+    fc->failures = 0;
+    if (changed) {
+        fc->cache.version = FASTCONN_VERSION;
+        fc->cache.cred_hash = fc->cred_hash;
+        memcpy(fc->cache.bssid, bssid, 6);
+        fc->cache.channel = channel;
+        fc->cache.ip = 0; // 换了 AP，旧租约不再可信
+    }
+    fc->mode = FASTCONN_CACHED;
+    return changed;
+}
+
+// 获得 IP，返回 1 表示缓存需要保存
+int fastconn_on_got_ip(fastconn_t *fc, uint32_t ip, uint32_t netmask,
+                       uint32_t gw, const uint32_t dns[FASTCONN_DNS_NUM]) {
+    if (fc->cache.ip == ip && fc->cache.netmask == netmask &&
+        fc->cache.gw == gw &&
+        memcmp(fc->cache.dns, dns, sizeof(fc->cache.dns)) == 0) {
+        return 0;
+    }
+    fc->cache.ip = ip;
+    fc->cache.netmask = netmask;
+    fc->cache.gw = gw;
+    memcpy(fc->cache.dns, dns, sizeof(fc->cache.dns));
+    return 1;
+}
@@ -0,0 +1,63 @@
+#ifndef USER_FASTCONN_H
+#define USER_FASTCONN_H
+
+#include <stdint.h>
+
+// 快速重连：记住上次成功连接的 BSSID、信道和 IP 租约，
+// 下次直接连接该 AP，失败后回退到全信道扫描。
+// 本模块只做决策，不调用 Wi-Fi 接口，由 user_test.c 执行。
+
+#define FASTCONN_NVS_KEY "wifi"
+#define FASTCONN_VERSION 2
+#define FASTCONN_CACHED_RETRY 2 // 使用缓存连接失败几次后改为扫描
+#define FASTCONN_DNS_NUM 2      // 主、备 DNS 服务器
+
+typedef struct
+{
+    uint16_t version;
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint32_t cred_hash; // SSID 和密码的摘要，配网变化后缓存失效
+    uint32_t ip;        // 网络字节序，0 表示没有租约
+    uint32_t netmask;
+    uint32_t gw;
+    uint32_t dns[FASTCONN_DNS_NUM]; // 租约下发的 DNS，0 表示没有
+} fastconn_cache_t;
+
+typedef enum
+{
+    FASTCONN_CACHED = 0, // 指定 BSSID 和信道
+    FASTCONN_SCAN,       // 全信道扫描
+} fastconn_mode_t;
+
+typedef struct
+{
+    fastconn_mode_t mode;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t static_ip; // 复用上次的租约，跳过 DHCP
+    uint32_t ip;
+    uint32_t netmask;
+    uint32_t gw;
+    uint32_t dns[FASTCONN_DNS_NUM]; // 租约没有 DNS 时用网关代替
+} fastconn_plan_t;
+
+typedef struct
+{
+    fastconn_cache_t cache;
+    uint32_t cred_hash;
+    fastconn_mode_t mode;
+    uint8_t reuse_lease;
+    uint8_t failures;
+} fastconn_t;
+
+void fastconn_init(fastconn_t *fc, const fastconn_cache_t *stored,
+                   const char *ssid, const char *pass, int reuse_lease);
+void fastconn_plan(const fastconn_t *fc, fastconn_plan_t *plan);
+int fastconn_on_fail(fastconn_t *fc);
+int fastconn_on_connected(fastconn_t *fc, const uint8_t bssid[6],
+                          int channel);
+int fastconn_on_got_ip(fastconn_t *fc, uint32_t ip, uint32_t netmask,
+                       uint32_t gw, const uint32_t dns[FASTCONN_DNS_NUM]);
+
+#endif // USER_FASTCONN_H
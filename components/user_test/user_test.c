@@ -3,6 +3,7 @@
 #include "esp_log.h"
 #include "esp_netif.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
@@ -13,144 +14,177 @@
 #include "lwip/sys.h"
 #include "nvs.h"
 #include "nvs_flash.h"
+#include "sdkconfig.h"
+#include "user_fastconn.h"
+#include "user_net.h"
 #include "user_nvs.h"
+#include "user_prof.h"
+#include "user_prov.h"
 #include <string.h>
 
 #define EXAMPLE_ESP_WIFI_SSID "honoka"
 #define EXAMPLE_ESP_WIFI_PASS "12345678"
 #define EXAMPLE_MAX_STA_CONN 2
-#define PORT 3333
-#define MAX_PACKETS 4
-#define MAX_PACKET_SIZE 128
 
-#define EXAMPLE_ESP_MAXIMUM_RETRY 5
-#define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT BIT1
-static int s_retry_num = 0;
+#ifdef CONFIG_ROOMLIGHT_WIFI_REUSE_LEASE
+#define WIFI_REUSE_LEASE 1
+#else
+#define WIFI_REUSE_LEASE 0
+#endif
+
+// 两次 MQTT 心跳之间射频按 DTIM 休眠，下行报文会延迟到下一个 DTIM
+#ifdef CONFIG_ROOMLIGHT_MODEM_SLEEP
+#define WIFI_PS_TYPE WIFI_PS_MIN_MODEM
+#else
+#define WIFI_PS_TYPE WIFI_PS_NONE
+#endif
+#define WIFI_LEASE_CONFIRM_MS 5000 // 复用租约连上后，隔多久在后台重新走 DHCP
+
+static fastconn_t s_fastconn;
+static int s_fastconn_dirty;
+static int s_static_ip; // 当前使用的是缓存的租约
+static uint32_t s_reused_ip; // 等待 DHCP 确认的复用地址，0 表示没有
+static esp_timer_handle_t s_lease_timer;
 
 static const char *TAG = "wifi ctrl";
 wifi_config_t wifi_config;
-user_wifi_state_t user_wifi_state;
-static EventGroupHandle_t s_wifi_event_group;
-static void tcp_server_task(void *pvParameters);
 
-static void wifi_event_handler(void *arg, esp_event_base_t event_base,
-                               int32_t event_id, void *event_data) {
-    // ap event handler
-    if (dev_state == DEV_SOFTAP) {
-        if (event_id == WIFI_EVENT_AP_STACONNECTED) {
-            wifi_event_ap_staconnected_t *event =
-                (wifi_event_ap_staconnected_t *)event_data;
-            ESP_LOGI(TAG, "station " MACSTR " join, AID=%d",
-                     MAC2STR(event->mac), event->aid);
-            user_wifi_state.newDeviceConnect = true;
-        } else if (event_id == WIFI_EVENT_AP_STADISCONNECTED) {
-            wifi_event_ap_stadisconnected_t *event =
-                (wifi_event_ap_stadisconnected_t *)event_data;
-            ESP_LOGI(TAG, "station " MACSTR " leave, AID=%d",
-                     MAC2STR(event->mac), event->aid);
+static void wifi_get_dns(uint32_t dns[FASTCONN_DNS_NUM]) {
+    tcpip_adapter_dns_info_t info;
+    for (int i = 0; i < FASTCONN_DNS_NUM; i++) {
+        dns[i] = 0;
+        if (tcpip_adapter_get_dns_info(TCPIP_ADAPTER_IF_STA,
+                                       TCPIP_ADAPTER_DNS_MAIN + i,
+                                       &info) == ESP_OK) {
+            dns[i] = ip4_addr_get_u32(ip_2_ip4(&info.ip));
         }
     }
-    else {
-        // sta event handler
-        if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-            esp_wifi_connect();
-        } else if (event_base == WIFI_EVENT &&
-                   event_id == WIFI_EVENT_STA_DISCONNECTED) {
-            if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY) {
-                esp_wifi_connect();
-                s_retry_num++;
-                ESP_LOGI(TAG, "retry to connect to the AP");
-            } else {
-                xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
-            }
-            ESP_LOGI(TAG, "connect to the AP fail");
-        } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
-            user_wifi_state.getNewIP = true;
-            ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
-            ESP_LOGI(TAG, "got ip:%s", ip4addr_ntoa(&event->ip_info.ip));
-            s_retry_num = 0;
-            xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+}
+
+// 跳过 DHCP 时 DNS 不会自动配置，否则 MQTT 和 SNTP 的域名都无法解析
+static void wifi_set_dns(const uint32_t dns[FASTCONN_DNS_NUM]) {
+    for (int i = 0; i < FASTCONN_DNS_NUM; i++) {
+        tcpip_adapter_dns_info_t info = {0};
+        if (dns[i] == 0) {
+            continue;
         }
+        ip_addr_set_ip4_u32(&info.ip, dns[i]);
+        tcpip_adapter_set_dns_info(TCPIP_ADAPTER_IF_STA,
+                                   TCPIP_ADAPTER_DNS_MAIN + i, &info);
     }
 }
 
-// ap tcp process
-void tcp_server_task(void *pvParameters) {
-    char rx_buffer[128];
-    char addr_str[128];
-    int addr_family;
-    int ip_protocol;
-
-    while (1) {
-        struct sockaddr_in dest_addr;
-        dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-        dest_addr.sin_family = AF_INET;
-        dest_addr.sin_port = htons(PORT);
-        addr_family = AF_INET;
-        ip_protocol = IPPROTO_IP;
-        inet_ntoa_r(dest_addr.sin_addr, addr_str, sizeof(addr_str) - 1);
-
-        int listen_sock = socket(addr_family, SOCK_STREAM, ip_protocol);
-        if (listen_sock < 0) {
-            ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
-            break;
-        }
-        ESP_LOGI(TAG, "Socket created");
+// 复用的租约可能已过期或分给了别人，连上后重新走一次 DHCP 确认或续租。
+// tcpip_adapter 启动 DHCP 时直接清零接口地址而不通知 TCP，拿回同一地址后
+// 已建立的连接继续可用，地址变化时在 GOT_IP 中重连。
+static void wifi_lease_confirm_cb(void *arg) {
+    if (s_static_ip) {
+        ESP_LOGI(TAG, "confirming reused lease with DHCP");
+        s_static_ip = 0;
+        tcpip_adapter_dhcpc_start(TCPIP_ADAPTER_IF_STA);
+    }
+}
 
-        int err =
-            bind(listen_sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr));
-        if (err != 0) {
-            ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
-            break;
-        }
-        ESP_LOGI(TAG, "Socket bound, port %d", PORT);
+// 按快速重连方案配置 STA：指定 BSSID/信道或全信道扫描，静态 IP 或 DHCP
+static void wifi_apply_fastconn(void) {
+    fastconn_plan_t plan;
+    fastconn_plan(&s_fastconn, &plan);
 
-        err = listen(listen_sock, 1);
-        if (err != 0) {
-            ESP_LOGE(TAG, "Error occurred during listen: errno %d", errno);
-            break;
-        }
-        ESP_LOGI(TAG, "Socket listening");
-
-        while (1) {
-            struct sockaddr_in source_addr;
-            uint addr_len = sizeof(source_addr);
-            int sock =
-                accept(listen_sock, (struct sockaddr *)&source_addr, &addr_len);
-            if (sock < 0) {
-                ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
-                break;
-            }
-            ESP_LOGI(TAG, "Socket accepted");
-            while (1) {
-                int len = recv(sock, rx_buffer, sizeof(rx_buffer) - 1, 0);
-                if (len < 0) {
-                    ESP_LOGE(TAG, "recv failed: errno %d", errno);
-                    break;
-                } else if (len == 0) {
-                    ESP_LOGI(TAG, "Connection closed");
-                    break;
-                } else {
-                    rx_buffer[len] = 0;
-                    ESP_LOGI(TAG, "Received %d bytes: %s", len, rx_buffer);
-                    parse_data_packet(rx_buffer, len, &nvs_data);
-                }
-            }
+    wifi_config.sta.bssid_set = (plan.mode == FASTCONN_CACHED);
+    memcpy(wifi_config.sta.bssid, plan.bssid, sizeof(plan.bssid));
+    wifi_config.sta.channel = plan.channel;
+    esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
 
-            if (sock != -1) {
-                ESP_LOGE(TAG, "Shutting down socket and restarting...");
-                shutdown(sock, 0);
-                close(sock);
+    if (plan.static_ip) {
+        tcpip_adapter_ip_info_t ip_info = {
+            .ip.addr = plan.ip,
+            .netmask.addr = plan.netmask,
+            .gw.addr = plan.gw,
+        };
+        tcpip_adapter_dhcpc_stop(TCPIP_ADAPTER_IF_STA);
+        tcpip_adapter_set_ip_info(TCPIP_ADAPTER_IF_STA, &ip_info);
+        wifi_set_dns(plan.dns);
+    } else if (s_static_ip) {
+        tcpip_adapter_dhcpc_start(TCPIP_ADAPTER_IF_STA);
+    }
+    s_static_ip = plan.static_ip;
+
+    if (plan.mode == FASTCONN_CACHED) {
+        ESP_LOGI(TAG, "fast connect to " MACSTR " channel %d%s",
+                 MAC2STR(plan.bssid), plan.channel,
+                 plan.static_ip ? ", reusing lease" : "");
+    } else {
+        ESP_LOGI(TAG, "full scan connect");
+    }
+}
+
+// 按事件本身区分 AP 和 STA：模式切换期间 dev_state 可能与事件来源不一致
+static void wifi_event_handler(void *arg, esp_event_base_t event_base,
+                               int32_t event_id, void *event_data) {
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STACONNECTED) {
+        wifi_event_ap_staconnected_t *event =
+            (wifi_event_ap_staconnected_t *)event_data;
+        ESP_LOGI(TAG, "station " MACSTR " join, AID=%d", MAC2STR(event->mac),
+                 event->aid);
+        net_post_event(NET_EVT_AP_ACTIVITY);
+    } else if (event_base == WIFI_EVENT &&
+               event_id == WIFI_EVENT_AP_STADISCONNECTED) {
+        wifi_event_ap_stadisconnected_t *event =
+            (wifi_event_ap_stadisconnected_t *)event_data;
+        ESP_LOGI(TAG, "station " MACSTR " leave, AID=%d", MAC2STR(event->mac),
+                 event->aid);
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT &&
+               event_id == WIFI_EVENT_STA_CONNECTED) {
+        wifi_event_sta_connected_t *event =
+            (wifi_event_sta_connected_t *)event_data;
+        prof_mark(PROF_WIFI_CONNECTED);
+        s_fastconn_dirty |=
+            fastconn_on_connected(&s_fastconn, event->bssid, event->channel);
+    } else if (event_base == WIFI_EVENT &&
+               event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        esp_timer_stop(s_lease_timer);
+        s_reused_ip = 0;
+        if (fastconn_on_fail(&s_fastconn)) {
+            wifi_apply_fastconn();
+        }
+        ESP_LOGI(TAG, "connect to the AP fail");
+        // 由联网状态机按退避时间调用 wifi_reconnect()
+        net_post_event(NET_EVT_STA_DISCONNECTED);
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        prof_mark(PROF_GOT_IP);
+        ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+        uint32_t dns[FASTCONN_DNS_NUM];
+        ESP_LOGI(TAG, "got ip:%s", ip4addr_ntoa(&event->ip_info.ip));
+        wifi_get_dns(dns);
+        s_fastconn_dirty |= fastconn_on_got_ip(
+            &s_fastconn, event->ip_info.ip.addr, event->ip_info.netmask.addr,
+            event->ip_info.gw.addr, dns);
+        if (s_fastconn_dirty &&
+            nvs_save_blob(FASTCONN_NVS_KEY, &s_fastconn.cache,
+                          sizeof(s_fastconn.cache)) == ESP_OK) {
+            s_fastconn_dirty = 0;
+        }
+        if (s_reused_ip != 0 && !s_static_ip) {
+            // 后台 DHCP 完成，地址变了则旧连接已失效，重新连接
+            uint32_t reused = s_reused_ip;
+            s_reused_ip = 0;
+            if (event->ip_info.ip.addr != reused) {
+                ESP_LOGW(TAG, "reused lease replaced, reconnecting");
+                esp_wifi_disconnect();
             }
+            return;
+        }
+        if (s_static_ip) {
+            s_reused_ip = event->ip_info.ip.addr;
+            esp_timer_start_once(s_lease_timer, WIFI_LEASE_CONFIRM_MS * 1000ULL);
         }
+        net_post_event(NET_EVT_GOT_IP);
     }
-    vTaskDelete(NULL);
 }
 
 void user_wifi_init() {
-    s_wifi_event_group = xEventGroupCreate();
-
     tcpip_adapter_init();
 
     ESP_ERROR_CHECK(esp_event_loop_create_default());
@@ -164,14 +198,19 @@ void user_wifi_init() {
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
                                                &wifi_event_handler, NULL));
 
-    xTaskCreate(tcp_server_task, "tcp_server", 4096, NULL, 5, NULL);
+    const esp_timer_create_args_t lease_timer_args = {
+        .callback = wifi_lease_confirm_cb,
+        .name = "wifi_lease",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&lease_timer_args, &s_lease_timer));
+
+    prov_server_start();
 }
 
 void wifiSwitch(int mode) {
     esp_wifi_stop();
     esp_wifi_set_mode(mode);
     if (mode == WIFI_MODE_AP) {
-        dev_state = DEV_SOFTAP;
         memset(&wifi_config, 0, sizeof(wifi_config_t));
         char user_ssid[32];
         sprintf(user_ssid, "%s-%04x", EXAMPLE_ESP_WIFI_SSID, uniqueId);
@@ -187,7 +226,7 @@ void wifiSwitch(int mode) {
         ESP_LOGI(TAG, "wifi_init_softap finished. SSID:%s password:%s",
                  user_ssid, EXAMPLE_ESP_WIFI_PASS);
     } else if (mode == WIFI_MODE_STA) {
-        dev_state = DEV_STA_CONNECTING;
+        prof_mark(PROF_WIFI_START);
         memset(&wifi_config, 0, sizeof(wifi_config_t));
         strncpy((char *)wifi_config.sta.ssid, nvs_data.ssid,
                 sizeof(wifi_config.sta.ssid) - 1);
@@ -196,12 +235,24 @@ void wifiSwitch(int mode) {
         if (strlen((char *)wifi_config.sta.password)) {
             wifi_config.sta.threshold.authmode = WIFI_AUTH_WPA2_PSK;
         }
-        esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
+        fastconn_cache_t cache;
+        int cached = nvs_load_blob(FASTCONN_NVS_KEY, &cache, sizeof(cache)) ==
+                     ESP_OK;
+        fastconn_init(&s_fastconn, cached ? &cache : NULL, nvs_data.ssid,
+                      nvs_data.pass, WIFI_REUSE_LEASE);
+        s_fastconn_dirty = 0;
+        wifi_apply_fastconn();
         ESP_LOGI(TAG, "wifi_init_sta finished.");
     }
     esp_wifi_start();
     // 如果是STA模式，尝试连接
     if (mode == WIFI_MODE_STA) {
+        esp_wifi_set_ps(WIFI_PS_TYPE);
         ESP_ERROR_CHECK(esp_wifi_connect());
     }
-}
\ No newline at end of file
+}
+
+void wifi_reconnect(void) {
+    ESP_LOGI(TAG, "retry to connect to the AP");
+    esp_wifi_connect();
+}
@@ -0,0 +1,118 @@
+#include "user_alarm.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "user_cmd.h"
+#include "user_config.h"
+#include "user_nvs.h"
+#include "user_prof.h"
+#include "user_time.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "user alarm"
+
+// 规则转换为普通命令，与云端命令走同一条路径
+static void alarm_fire(const sched_rule_t *rule) {
+    char packet[SCHED_ARG_SIZE + NVS_STORAGE_MAX];
+    int len;
+
+    switch (rule->action) {
+    case SCHED_ACT_COLOR:
+        len = snprintf(packet, sizeof(packet), "%s:%s", NVS_LightNormal,
+                       rule->arg);
+        break;
+    case SCHED_ACT_SCENE: {
+        const char *scene[] = {nvs_data.lightSwitch1, nvs_data.lightSwitch2,
+                               nvs_data.lightSwitch3};
+        if (rule->arg[0] < '1' || rule->arg[0] > '3') {
+            return;
+        }
+        len = snprintf(packet, sizeof(packet), "%s:%s", NVS_LightNormal,
+                       scene[rule->arg[0] - '1']);
+        break;
+    }
+    case SCHED_ACT_EFFECT:
+        len = snprintf(packet, sizeof(packet), "%s:\"%s\"", NVS_Effect,
+                       rule->arg);
+        break;
+    default:
+        return;
+    }
+    ESP_LOGI(TAG, "Fire %02x@%02d%02d: %s", rule->days, rule->minute / 60,
+             rule->minute % 60, packet);
+    cmd_queue_post(CMD_SRC_LOCAL, packet, len);
+}
+
+// TZ 环境变量只在本任务中修改，其他任务不调用 localtime/mktime
+static void alarm_apply_tz(void) {
+    static char applied[CONFIG_TZ_SIZE];
+    char tz[CONFIG_TZ_SIZE];
+
+    config_get_tz(tz);
+    if (strcmp(tz, applied) != 0) {
+        strcpy(applied, tz);
+        setenv("TZ", tz, 1);
+        tzset();
+        ESP_LOGI(TAG, "Time zone %s", tz);
+    }
+}
+
+static void alarm_task(void *pvParameters) {
+    static sched_table_t table;
+    uint32_t notify = CONFIG_NOTIFY_SCHED | CONFIG_NOTIFY_TIME;
+    time_t next = -1;
+    uint8_t due = 0;
+
+    config_subscribe(xTaskGetCurrentTaskHandle());
+    while (1) {
+        struct timeval tv;
+        TickType_t wait = portMAX_DELAY;
+
+        if (notify & CONFIG_NOTIFY_TIME) {
+            alarm_apply_tz();
+        }
+        // 规则表换了，due 中的编号不再对应
+        if (notify & CONFIG_NOTIFY_SCHED) {
+            config_get_schedule(&table);
+            next = -1;
+        }
+        if (table.count > 0 && time_now(&tv) == 0) {
+            if (next >= 0 && tv.tv_sec >= next) {
+                if (tv.tv_sec - next <= ALARM_LATE_MAX_S) {
+                    for (int i = 0; i < table.count; i++) {
+                        if (due & (1 << i)) {
+                            alarm_fire(&table.rules[i]);
+                        }
+                    }
+                }
+                next = -1;
+            }
+            // 其他配置通知不影响触发时刻，无需重算
+            if (next < 0 || (notify & CONFIG_NOTIFY_TIME)) {
+                next = sched_next(&table, tv.tv_sec, &due);
+                if (next >= 0) {
+                    ESP_LOGI(TAG, "Next event in %d s",
+                             (int)(next - tv.tv_sec));
+                }
+            }
+            if (next >= 0) {
+                int64_t ms =
+                    (int64_t)(next - tv.tv_sec) * 1000 - tv.tv_usec / 1000;
+                // 多等一个 tick，醒来时一定已经到点
+                wait = (TickType_t)(ms / portTICK_PERIOD_MS + 1);
+            }
+        } else {
+            next = -1;
+        }
+        notify = 0;
+        xTaskNotifyWait(0, ULONG_MAX, &notify, wait);
+        prof_wakeup(PROF_TASK_ALARM);
+    }
+}
+
+void alarm_start(void) {
+    xTaskCreate(alarm_task, "alarm", 3072, NULL, 5, NULL);
+}
@@ -0,0 +1,11 @@
+#ifndef USER_ALARM_H
+#define USER_ALARM_H
+
+// 执行本地定时规则：算出最近的触发时刻后一直睡到该时刻，
+// 规则、时区变化或对时跳变时重新计算。TZ 环境变量只由本任务设置
+
+#define ALARM_LATE_MAX_S 120 // 时间跳过触发时刻太久则不再补执行
+
+void alarm_start(void);
+
+#endif // USER_ALARM_H
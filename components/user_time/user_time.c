@@ -0,0 +1,89 @@
+#include "user_time.h"
+#include "esp_log.h"
+#include "esp_sntp.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "user_cmd.h"
+#include "user_config.h"
+#include "user_nvs.h"
+#include "user_prof.h"
+#include "user_timemap.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TAG "user time"
+
+static timemap_t s_map;
+
+// 第一次对时的时间戳作为序列号的扩展，只写一次。
+// 回调在 lwip 线程中执行，写 flash 交给命令队列
+static void time_save_stamp(time_t now) {
+    char stamp[32];
+
+    if (strcmp(nvs_data.timeStamp, "default") != 0) {
+        return;
+    }
+    int len = snprintf(stamp, sizeof(stamp), "%s:%d", NVS_TimeStamp, (int)now);
+    cmd_queue_post(CMD_SRC_LOCAL, stamp, len);
+    ESP_LOGI(TAG, "Time stamp: %s", stamp);
+}
+
+static void time_sync_cb(struct timeval *tv) {
+    int64_t mono = esp_timer_get_time();
+    int64_t wall = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+
+    portENTER_CRITICAL();
+    int first = !s_map.valid;
+    int stepped = timemap_sync(&s_map, mono, wall);
+    int32_t drift = s_map.drift_ppb;
+    portEXIT_CRITICAL();
+
+    struct tm timeinfo;
+    // 时区由 alarm 任务维护，这里按 UTC 打印
+    gmtime_r(&tv->tv_sec, &timeinfo);
+    ESP_LOGI(TAG, "Time synced%s (UTC): %s drift %d ppb",
+             stepped ? " (step)" : "", asctime(&timeinfo), drift);
+    if (first) {
+        prof_mark(PROF_SNTP_DONE);
+        time_save_stamp(tv->tv_sec);
+    }
+    if (stepped) {
+        config_notify(CONFIG_NOTIFY_TIME);
+    }
+}
+
+// 获得 IP 后调用，立即返回，重复调用无效
+void time_start(void) {
+    static int started;
+
+    if (started) {
+        return;
+    }
+    started = 1;
+    ESP_LOGI(TAG, "Starting SNTP");
+    sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_setservername(0, TIME_SERVER);
+    sntp_set_time_sync_notification_cb(time_sync_cb);
+    sntp_init();
+}
+
+int time_synced(void) {
+    return s_map.valid;
+}
+
+// 按映射换算当前墙上时间，未对时返回 -1
+int time_now(struct timeval *tv) {
+    int64_t mono = esp_timer_get_time();
+
+    portENTER_CRITICAL();
+    int valid = s_map.valid;
+    int64_t wall = timemap_wall(&s_map, mono);
+    portEXIT_CRITICAL();
+    if (!valid) {
+        return -1;
+    }
+    tv->tv_sec = wall / 1000000;
+    tv->tv_usec = wall % 1000000;
+    return 0;
+}
@@ -0,0 +1,20 @@
+#ifndef USER_TIME_H
+#define USER_TIME_H
+
+#include <stdint.h>
+#include <sys/time.h>
+
+/*
+ * 后台对时
+ * 获得 IP 后启动 SNTP，不等待结果；之后由 lwip 按
+ * CONFIG_LWIP_SNTP_UPDATE_DELAY 周期重新对时。
+ * 每次对时更新单调时钟到墙上时间的映射，两次对时之间按估计的漂移外推。
+ */
+
+#define TIME_SERVER "pool.ntp.org"
+
+void time_start(void);
+int time_now(struct timeval *tv);
+int time_synced(void);
+
+#endif // USER_TIME_H
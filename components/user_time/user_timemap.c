@@ -0,0 +1,56 @@
+#include "user_timemap.h"
+#include <string.h>
+
+void timemap_init(timemap_t *map) {
+    memset(map, 0, sizeof(*map));
+}
+
+int64_t timemap_wall(const timemap_t *map, int64_t mono_us) {
+    int64_t elapsed = mono_us - map->anchor_mono_us;
+    return map->anchor_wall_us + elapsed + elapsed * map->drift_ppb / 1000000000;
+}
+
+static void timemap_anchor(timemap_t *map, int64_t mono_us, int64_t wall_us) {
+    map->anchor_mono_us = mono_us;
+    map->anchor_wall_us = wall_us;
+}
+
+// 返回 1 表示第一次对时或时间跳变，之前换算出的时刻需要重新计算
+int timemap_sync(timemap_t *map, int64_t mono_us, int64_t wall_us) {
+    if (!map->valid) {
+        map->valid = 1;
+        timemap_anchor(map, mono_us, wall_us);
+        map->ref_mono_us = mono_us;
+        map->ref_wall_us = wall_us;
+        return 1;
+    }
+
+    int64_t error = wall_us - timemap_wall(map, mono_us);
+    if (error > TIMEMAP_STEP_US || error < -TIMEMAP_STEP_US) {
+        // 服务器或时区以外的原因导致跳变，之前的漂移参考点作废
+        timemap_anchor(map, mono_us, wall_us);
+        map->ref_mono_us = mono_us;
+        map->ref_wall_us = wall_us;
+        return 1;
+    }
+
+    int64_t dt = mono_us - map->ref_mono_us;
+    if (dt >= TIMEMAP_MIN_BASELINE_US) {
+        int64_t d = ((wall_us - map->ref_wall_us) - dt) * 1000000000 / dt;
+        if (d > TIMEMAP_DRIFT_MAX_PPB) {
+            d = TIMEMAP_DRIFT_MAX_PPB;
+        } else if (d < -TIMEMAP_DRIFT_MAX_PPB) {
+            d = -TIMEMAP_DRIFT_MAX_PPB;
+        }
+        if (!map->drift_valid) {
+            map->drift_ppb = d;
+            map->drift_valid = 1;
+        } else {
+            map->drift_ppb += (int32_t)(d - map->drift_ppb) / 2;
+        }
+        map->ref_mono_us = mono_us;
+        map->ref_wall_us = wall_us;
+    }
+    timemap_anchor(map, mono_us, wall_us);
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef USER_TIMEMAP_H
+#define USER_TIMEMAP_H
+
+#include <stdint.h>
+
+// 单调时钟到墙上时间的映射，每次对时作为一个样本，估计晶振漂移，
+// 两次对时之间按漂移外推。不依赖 FreeRTOS，时间以微秒传入。
+
+#define TIMEMAP_MIN_BASELINE_US (10 * 60 * 1000000LL) // 间隔太短的样本不用于估计漂移
+#define TIMEMAP_STEP_US 1000000                       // 偏差过大视为时间被调整
+#define TIMEMAP_DRIFT_MAX_PPB 500000
+
+typedef struct
+{
+    uint8_t valid;
+    uint8_t drift_valid;
+    int32_t drift_ppb; // 墙上时间相对单调时钟的速率差
+    int64_t anchor_mono_us;
+    int64_t anchor_wall_us;
+    int64_t ref_mono_us; // 估计漂移的起点
+    int64_t ref_wall_us;
+} timemap_t;
+
+void timemap_init(timemap_t *map);
+int timemap_sync(timemap_t *map, int64_t mono_us, int64_t wall_us);
+int64_t timemap_wall(const timemap_t *map, int64_t mono_us);
+
+#endif // USER_TIMEMAP_H
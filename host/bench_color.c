@@ -0,0 +1,27 @@
+#include "bench_host.h"
+#include "user_pwm.h"
+
+// 整数 HSV / 色温换算的吞吐
+
+static volatile uint32_t s_sink;
+
+int main(int argc, char **argv) {
+    long n = bench_iterations(argc, argv, 2000000);
+    uint16_t r, g, b;
+
+    int64_t start = bench_now_ns();
+    for (long i = 0; i < n; i++) {
+        pwm_hsv_to_rgb48(i % 360, 1000 - i % 7, 1000 - i % 11, &r, &g, &b);
+        s_sink += r + g + b;
+    }
+    bench_report("pwm_hsv_to_rgb48", n, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (long i = 0; i < n; i++) {
+        pwm_cct_to_rgb48(PWM_CCT_MIN + i % (PWM_CCT_MAX - PWM_CCT_MIN + 1),
+                         1000 - i % 13, &r, &g, &b);
+        s_sink += r + g + b;
+    }
+    bench_report("pwm_cct_to_rgb48", n, bench_now_ns() - start);
+    return 0;
+}
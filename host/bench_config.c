@@ -0,0 +1,71 @@
+#include "bench_host.h"
+#include "host_shim.h"
+#include "user_config.h"
+#include "user_nvs.h"
+#include <string.h>
+
+// 运行时配置的换算和通知开销：
+// 改动前渲染任务每一轮都从 nvs_data 字符串重新解析 5 个灯光字段，
+// 现在只在字段变化时解析一次，每个数据包合并为一次通知
+
+static const char *PACKETS[2] = {
+    "{\"lightNormal\":\"#ff8800\",\"lightPeriod\":\"5\",\"lightSwitch1\":"
+    "\"#ff0000\",\"lightSwitch2\":\"#00ff00\",\"lightSwitch3\":\"#0000ff\"}",
+    "{\"lightNormal\":\"#0088ff\",\"lightPeriod\":\"3\",\"lightSwitch1\":"
+    "\"63488\",\"lightSwitch2\":\"2016\",\"lightSwitch3\":\"31\"}",
+};
+
+static volatile int s_sink;
+
+// 改动前每一轮渲染的解析开销
+static void bench_reparse(long passes) {
+    int64_t start = bench_now_ns();
+    for (long n = 0; n < passes; n++) {
+        for (int f = NVS_FIELD_LIGHT_NORMAL; f <= NVS_FIELD_LIGHT_SWITCH3; f++) {
+            config_update_field(f);
+        }
+        s_sink += light_config.lightNormal.r;
+    }
+    bench_report("render pass, re-parse strings", passes, bench_now_ns() - start);
+}
+
+// 现在每一轮渲染只复制已解析的结构
+static void bench_typed(long passes) {
+    int64_t start = bench_now_ns();
+    for (long n = 0; n < passes; n++) {
+        light_config_t copy = light_config;
+        s_sink += copy.lightNormal.r;
+    }
+    bench_report("render pass, typed config", passes, bench_now_ns() - start);
+}
+
+// 每个数据包改动 5 个字段：换算 + 通知订阅者
+static int bench_packet(long packets) {
+    host_task_t task = {0};
+    config_subscribe(&task);
+
+    int64_t start = bench_now_ns();
+    for (long n = 0; n < packets; n++) {
+        const char *p = PACKETS[n & 1];
+        parse_data_packet(p, strlen(p), &nvs_data);
+    }
+    bench_report("packet, convert + notify", packets, bench_now_ns() - start);
+    printf("%-32s %10.2f notifications/packet\n", "subscriber",
+           (double)task.notify_calls / packets);
+    return task.notify_calls == packets &&
+                   (task.notify & CONFIG_NOTIFY_LIGHT) == CONFIG_NOTIFY_LIGHT
+               ? 0
+               : 1;
+}
+
+int main(int argc, char **argv) {
+    long n = bench_iterations(argc, argv, 100000);
+
+    host_nvs_reset(NULL);
+    init_nvs();
+    nvs_read_data_from_flash();
+    parse_data_packet(PACKETS[0], strlen(PACKETS[0]), &nvs_data);
+    bench_reparse(n);
+    bench_typed(n);
+    return bench_packet(n);
+}
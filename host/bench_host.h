@@ -0,0 +1,39 @@
+#ifndef BENCH_HOST_H
+#define BENCH_HOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// 性能测量程序共用：迭代次数可由第一个命令行参数覆盖
+static inline long bench_iterations(int argc, char **argv, long fallback) {
+    long n = argc > 1 ? strtol(argv[1], NULL, 10) : 0;
+    return n > 0 ? n : fallback;
+}
+
+static inline int64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// x86 上返回时间戳计数器，其他平台返回 0，结果中不打印周期数
+static inline uint64_t bench_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// 每行一个结果：名称、每次操作耗时、每秒操作数
+static inline void bench_report(const char *name, long ops, int64_t ns) {
+    if (ns <= 0) {
+        ns = 1;
+    }
+    printf("%-32s %10.1f ns/op %14.0f op/s\n", name, (double)ns / ops,
+           ops * 1e9 / ns);
+}
+
+#endif // BENCH_HOST_H
@@ -0,0 +1,293 @@
+#include "bench_host.h"
+#include "host_shim.h"
+#include "lwip/sockets.h"
+#include "mbedtls/md.h"
+#include "user_cmd.h"
+#include "user_config.h"
+#include "user_lan.h"
+#include "user_nvs.h"
+#include <pthread.h>
+#include <string.h>
+#include <sys/time.h>
+
+// 局域网控制的往返时间：客户端按协议发现设备、签名并发送调光命令，
+// 统计从发送到收到应答的时间。
+// 默认在回环地址上启动一个调用 lan_handle_request 的服务端；
+// 参数 "<次数> <设备 IP> <密钥>" 时直接测量真实设备。
+// 固件代码只在服务端线程中运行，主线程只收发数据报。
+
+#define KEY_HEX "000102030405060708090a0b0c0d0e0f" \
+                "101112131415161718191a1b1c1d1e1f"
+#define REPLY_TIMEOUT_MS 1000
+
+typedef struct
+{
+    int sock;
+    struct sockaddr_in addr;
+    uint8_t key[CONFIG_LAN_KEY_SIZE];
+    uint32_t nonce;
+    uint32_t seq;
+} lan_client_t;
+
+static int s_server_sock;
+static volatile int s_server_stop;
+
+// 回环服务端：与 lan_task 相同的收发循环，另外代替命令任务执行队列
+static void *server_thread(void *arg) {
+    static char buf[LAN_RX_SIZE + 1];
+    char reply[LAN_REPLY_SIZE];
+
+    while (!s_server_stop) {
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        int len = recvfrom(s_server_sock, buf, LAN_RX_SIZE, 0,
+                           (struct sockaddr *)&from, &from_len);
+        if (len < 0) {
+            continue; // 超时，检查是否退出
+        }
+        buf[len] = '\0';
+        int reply_len = lan_handle_request(buf, len, reply, sizeof(reply));
+        if (reply_len > 0) {
+            sendto(s_server_sock, reply, reply_len, 0, (struct sockaddr *)&from,
+                   from_len);
+        }
+        cmd_queue_dispatch();
+    }
+    return NULL;
+}
+
+static void set_timeout(int sock, int ms) {
+    struct timeval tv = {.tv_sec = ms / 1000, .tv_usec = ms % 1000 * 1000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+static int server_start(pthread_t *thread) {
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t addr_len = sizeof(addr);
+
+    s_server_sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s_server_sock < 0 ||
+        bind(s_server_sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        getsockname(s_server_sock, (struct sockaddr *)&addr, &addr_len) != 0) {
+        return -1;
+    }
+    set_timeout(s_server_sock, 100);
+    pthread_create(thread, NULL, server_thread, NULL);
+    return ntohs(addr.sin_port);
+}
+
+static int parse_key(const char *hex, uint8_t key[CONFIG_LAN_KEY_SIZE]) {
+    if (strlen(hex) != CONFIG_LAN_KEY_SIZE * 2) {
+        return -1;
+    }
+    for (int i = 0; i < CONFIG_LAN_KEY_SIZE; i++) {
+        unsigned int b;
+        if (sscanf(hex + 2 * i, "%2x", &b) != 1) {
+            return -1;
+        }
+        key[i] = b;
+    }
+    return 0;
+}
+
+static int client_open(lan_client_t *c, const char *ip, int port,
+                       const char *key_hex) {
+    memset(c, 0, sizeof(*c));
+    c->addr.sin_family = AF_INET;
+    c->addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, ip, &c->addr.sin_addr) != 1 ||
+        parse_key(key_hex, c->key) != 0) {
+        return -1;
+    }
+    c->sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (c->sock < 0) {
+        return -1;
+    }
+    set_timeout(c->sock, REPLY_TIMEOUT_MS);
+    return 0;
+}
+
+static int client_request(lan_client_t *c, const char *req, int len,
+                          char *reply, int size) {
+    if (sendto(c->sock, req, len, 0, (struct sockaddr *)&c->addr,
+               sizeof(c->addr)) != len) {
+        return -1;
+    }
+    int n = recv(c->sock, reply, size - 1, 0);
+    if (n < 0) {
+        return -1;
+    }
+    reply[n] = '\0';
+    return n;
+}
+
+// 取得 nonce 和设备已接受的最大 seq，之后从 seq + 1 开始发送
+static int client_discover(lan_client_t *c) {
+    char reply[LAN_REPLY_SIZE];
+    const char *nonce, *seq;
+
+    if (client_request(c, "disc", 4, reply, sizeof(reply)) < 0 ||
+        (nonce = strstr(reply, "nonce:")) == NULL ||
+        (seq = strstr(reply, ",seq:")) == NULL) {
+        return -1;
+    }
+    c->nonce = strtoul(nonce + 6, NULL, 16);
+    c->seq = strtoul(seq + 5, NULL, 10);
+    return 0;
+}
+
+// 与设备端 lan_compute_tag 相同的签名
+static void client_tag(const lan_client_t *c, uint32_t seq,
+                       const char *payload, char tag[LAN_TAG_LEN + 1]) {
+    mbedtls_md_context_t ctx;
+    uint8_t digest[32];
+    char header[24];
+    int header_len = snprintf(header, sizeof(header), "%08x\n%u\n", c->nonce,
+                              seq);
+
+    mbedtls_md_init(&ctx);
+    mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    mbedtls_md_hmac_starts(&ctx, c->key, CONFIG_LAN_KEY_SIZE);
+    mbedtls_md_hmac_update(&ctx, (const uint8_t *)header, header_len);
+    mbedtls_md_hmac_update(&ctx, (const uint8_t *)payload, strlen(payload));
+    mbedtls_md_hmac_finish(&ctx, digest);
+    mbedtls_md_free(&ctx);
+    for (int i = 0; i < LAN_TAG_LEN / 2; i++) {
+        sprintf(tag + 2 * i, "%02x", digest[i]);
+    }
+}
+
+// 发送一条命令，返回应答中的结果（"ok" 或错误原因），超时返回 NULL
+static const char *client_command(lan_client_t *c, const char *payload) {
+    static char reply[LAN_REPLY_SIZE];
+    char req[LAN_RX_SIZE];
+    char tag[LAN_TAG_LEN + 1];
+    char expect[24];
+    uint32_t seq = ++c->seq;
+
+    client_tag(c, seq, payload, tag);
+    int len = snprintf(req, sizeof(req), "C %u %s\n%s", seq, tag, payload);
+    if (client_request(c, req, len, reply, sizeof(reply)) < 0) {
+        return NULL;
+    }
+    int prefix = snprintf(expect, sizeof(expect), "A %u ", seq);
+    if (strncmp(reply, expect, prefix) != 0) {
+        return NULL;
+    }
+    return strncmp(reply + prefix, "err ", 4) == 0 ? reply + prefix + 4
+                                                   : reply + prefix;
+}
+
+static int cmp_ns(const void *a, const void *b) {
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void report_rtt(const char *name, int64_t *rtt, long n) {
+    int64_t total = 0;
+    for (long i = 0; i < n; i++) {
+        total += rtt[i];
+    }
+    qsort(rtt, n, sizeof(rtt[0]), cmp_ns);
+    bench_report(name, n, total);
+    printf("%-32s p50 %.1f us, p99 %.1f us, max %.1f us\n", "", rtt[n / 2] / 1e3,
+           rtt[n * 99 / 100] / 1e3, rtt[n - 1] / 1e3);
+}
+
+static int bench_discover(lan_client_t *c, int64_t *rtt, long n) {
+    for (long i = 0; i < n; i++) {
+        int64_t start = bench_now_ns();
+        if (client_discover(c) != 0) {
+            printf("discovery timed out\n");
+            return -1;
+        }
+        rtt[i] = bench_now_ns() - start;
+    }
+    report_rtt("discovery round trip", rtt, n);
+    return 0;
+}
+
+static int bench_command(lan_client_t *c, int64_t *rtt, long n) {
+    char payload[32];
+
+    for (long i = 0; i < n; i++) {
+        snprintf(payload, sizeof(payload), "lightNormal:#%06lx", i & 0xffffff);
+        int64_t start = bench_now_ns();
+        const char *result = client_command(c, payload);
+        rtt[i] = bench_now_ns() - start;
+        if (result == NULL || strcmp(result, "ok") != 0) {
+            printf("command %u failed: %s\n", c->seq,
+                   result ? result : "timeout");
+            return -1;
+        }
+    }
+    report_rtt("signed command round trip", rtt, n);
+    return 0;
+}
+
+// 两个客户端共用设备的 seq：落后的一方收到 replay，重新发现后继续
+static int check_shared_seq(lan_client_t *a, lan_client_t *b) {
+    const char *result;
+
+    if (client_discover(a) != 0 || client_discover(b) != 0) {
+        return -1;
+    }
+    b->seq += 10;
+    if ((result = client_command(b, "lightNormal:#010101")) == NULL ||
+        strcmp(result, "ok") != 0) {
+        return -1;
+    }
+    if ((result = client_command(a, "lightNormal:#020202")) == NULL ||
+        strcmp(result, "replay") != 0) {
+        return -1;
+    }
+    if (client_discover(a) != 0 || a->seq != b->seq) {
+        return -1;
+    }
+    result = client_command(a, "lightNormal:#020202");
+    return result != NULL && strcmp(result, "ok") == 0 ? 0 : -1;
+}
+
+int main(int argc, char **argv) {
+    long n = bench_iterations(argc, argv, 2000);
+    int64_t *rtt = malloc(n * sizeof(rtt[0]));
+    lan_client_t a, b;
+    pthread_t thread;
+    int ret;
+
+    if (argc > 3) {
+        // 真实设备：发送的调光命令会改变灯的颜色
+        if (client_open(&a, argv[2], LAN_PORT, argv[3]) != 0) {
+            printf("usage: %s [count] [device-ip key-hex]\n", argv[0]);
+            return 2;
+        }
+        ret = bench_discover(&a, rtt, n) || bench_command(&a, rtt, n);
+        free(rtt);
+        return ret ? 1 : 0;
+    }
+
+    host_nvs_reset(NULL);
+    init_nvs();
+    nvs_read_data_from_flash();
+    cmd_queue_init();
+    config_set_lan_key(KEY_HEX, strlen(KEY_HEX));
+    lan_start();
+    int port = server_start(&thread);
+    if (port < 0 || client_open(&a, "127.0.0.1", port, KEY_HEX) != 0 ||
+        client_open(&b, "127.0.0.1", port, KEY_HEX) != 0) {
+        printf("loopback setup failed\n");
+        return 1;
+    }
+    ret = bench_discover(&a, rtt, n) || bench_command(&a, rtt, n);
+    if (!ret && check_shared_seq(&a, &b) != 0) {
+        printf("shared seq resync failed\n");
+        ret = 1;
+    }
+    s_server_stop = 1;
+    pthread_join(thread, NULL);
+    free(rtt);
+    return ret ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+#include "bench_host.h"
+#include "host_shim.h"
+#include "user_config.h"
+#include "user_nvs.h"
+#include <string.h>
+
+// 启动时载入配置的开销：flash 读取次数、读取字节数和主机耗时。
+// 设备上每次读取都要在 NVS 页中查找条目，启动耗时主要取决于读取次数
+
+static const char *LEGACY_KEYS[NVS_FIELD_MAX] = {
+    NVS_SSID,         NVS_PASS,         NVS_USERID,       NVS_ROOMID,
+    NVS_TimeStamp,    NVS_LightNormal,  NVS_LightPeriod,  NVS_LightSwitch1,
+    NVS_LightSwitch2, NVS_LightSwitch3};
+
+static void report_reads(const char *name, long boots,
+                         const host_nvs_stats_t *before) {
+    printf("%-32s %10.1f reads %12.1f bytes\n", name,
+           (double)(host_nvs.reads - before->reads) / boots,
+           (double)(host_nvs.bytes_read - before->bytes_read) / boots);
+}
+
+// 旧版固件：每个字段一个字符串键，启动时逐个读取
+static void bench_legacy(long boots) {
+    nvs_handle handle;
+    char value[NVS_STORAGE_MAX];
+
+    nvs_flash_erase();
+    nvs_open("customer_data", NVS_READWRITE, &handle);
+    for (int i = 0; i < NVS_FIELD_MAX; i++) {
+        nvs_set_str(handle, LEGACY_KEYS[i], "#ff8800");
+    }
+    nvs_commit(handle);
+
+    host_nvs_stats_t before = host_nvs;
+    int64_t start = bench_now_ns();
+    for (long n = 0; n < boots; n++) {
+        nvs_open("customer_data", NVS_READWRITE, &handle);
+        for (int i = 0; i < NVS_FIELD_MAX; i++) {
+            size_t len = sizeof(value);
+            nvs_get_str(handle, LEGACY_KEYS[i], value, &len);
+        }
+        nvs_close(handle);
+    }
+    bench_report("boot load, per-key strings", boots, bench_now_ns() - start);
+    report_reads("per-key strings flash", boots, &before);
+
+    // 第一次启动迁移到 blob 的一次性开销
+    before = host_nvs;
+    nvs_read_data_from_flash();
+    printf("%-32s %10u reads %6u writes %5u commits\n", "legacy migration",
+           host_nvs.reads - before.reads, host_nvs.writes - before.writes,
+           host_nvs.commits - before.commits);
+}
+
+static void bench_blob(long boots) {
+    host_nvs_stats_t before = host_nvs;
+    int64_t start = bench_now_ns();
+    for (long n = 0; n < boots; n++) {
+        nvs_read_data_from_flash();
+    }
+    bench_report("boot load, config blob", boots, bench_now_ns() - start);
+    report_reads("config blob flash", boots, &before);
+}
+
+int main(int argc, char **argv) {
+    long boots = bench_iterations(argc, argv, 20000);
+
+    host_nvs_reset(NULL);
+    init_nvs();
+    bench_legacy(boots);
+    bench_blob(boots);
+    return strcmp(nvs_data.lightNormal, "#ff8800") == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#include "bench_host.h"
+#include "user_parser.h"
+#include <string.h>
+#ifdef BENCH_CJSON
+#include "cJSON.h"
+#endif
+
+// 按 parse_data_packet 的方式处理一批常见数据包，比较每秒包数和峰值堆占用
+
+static const char *PACKETS[] = {
+    "{\"ssid\":\"HomeNet-5G\",\"pass\":\"correct horse\",\"user\":\"u1024\","
+    "\"room\":\"\\u5ba2\\u5385\"}",
+    "{\"lightNormal\":\"#ff8800\"}",
+    "{\"lightPeriod\":\"5\",\"lightSwitch1\":\"#ff0000\",\"lightSwitch2\":"
+    "\"#00ff00\",\"lightSwitch3\":\"#0000ff\",\"ver\":12}",
+    "{\"effect\":\"*500/ff0000;500/000000\",\"ver\":13}",
+    "{\"hsv\":\"120/500/1000\"}",
+};
+#define PACKET_NUM (int)(sizeof(PACKETS) / sizeof(PACKETS[0]))
+
+// 堆统计：每块前面记录大小
+typedef struct
+{
+    size_t size;
+    size_t pad;
+} alloc_hdr_t;
+
+static size_t s_heap, s_peak, s_allocs;
+
+void *__real_malloc(size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+    alloc_hdr_t *h = __real_malloc(sizeof(*h) + size);
+    if (h == NULL) {
+        return NULL;
+    }
+    h->size = size;
+    s_allocs++;
+    s_heap += size;
+    if (s_heap > s_peak) {
+        s_peak = s_heap;
+    }
+    return h + 1;
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr != NULL) {
+        alloc_hdr_t *h = (alloc_hdr_t *)ptr - 1;
+        s_heap -= h->size;
+        __real_free(h);
+    }
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    void *p = __wrap_malloc(n * size);
+    if (p != NULL) {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    void *p = __wrap_malloc(size);
+    if (p != NULL && ptr != NULL) {
+        size_t old = ((alloc_hdr_t *)ptr - 1)->size;
+        memcpy(p, ptr, old < size ? old : size);
+        __wrap_free(ptr);
+    }
+    return p;
+}
+
+static void heap_reset(void) {
+    s_peak = s_heap;
+    s_allocs = 0;
+}
+
+static int s_sink;
+
+static void copy_pair(const char *key, int key_len, const char *value,
+                      int value_len, void *arg) {
+    char buf[30];
+    s_sink += key_len + parser_copy_value(buf, sizeof(buf), value, value_len);
+}
+
+static int bench_scanner(long iterations) {
+    int pairs = 0;
+    for (int i = 0; i < PACKET_NUM; i++) {
+        pairs += parser_scan(PACKETS[i], strlen(PACKETS[i]), copy_pair, NULL);
+    }
+
+    heap_reset();
+    int64_t start = bench_now_ns();
+    for (long n = 0; n < iterations; n++) {
+        const char *p = PACKETS[n % PACKET_NUM];
+        parser_scan(p, strlen(p), copy_pair, NULL);
+    }
+    bench_report("parser_scan + copy", iterations, bench_now_ns() - start);
+    printf("%-32s %10zu allocs %13zu peak bytes\n", "parser_scan heap", s_allocs,
+           s_peak - s_heap);
+    return s_allocs == 0 && pairs == 13 ? 0 : 1;
+}
+
+#ifdef BENCH_CJSON
+// 与改动前的 parse_data_packet 相同：整包建树后遍历
+static void bench_cjson(long iterations) {
+    heap_reset();
+    size_t base = s_heap;
+    int64_t start = bench_now_ns();
+    for (long n = 0; n < iterations; n++) {
+        cJSON *root = cJSON_Parse(PACKETS[n % PACKET_NUM]);
+        for (cJSON *item = root ? root->child : NULL; item; item = item->next) {
+            if (cJSON_IsString(item)) {
+                s_sink += strlen(item->valuestring);
+            }
+        }
+        cJSON_Delete(root);
+    }
+    bench_report("cJSON_Parse + walk", iterations, bench_now_ns() - start);
+    printf("%-32s %10zu allocs %13zu peak bytes\n", "cJSON heap", s_allocs,
+           s_peak - base);
+}
+#endif
+
+int main(int argc, char **argv) {
+    long iterations = bench_iterations(argc, argv, 200000);
+    int ret = bench_scanner(iterations);
+#ifdef BENCH_CJSON
+    bench_cjson(iterations);
+#else
+    printf("cJSON comparison skipped: set CJSON_DIR to the SDK's cJSON sources\n");
+#endif
+    return ret;
+}
@@ -0,0 +1,76 @@
+#include "bench_host.h"
+#include "user_prov.h"
+#include <string.h>
+
+// 配网连接的帧重组吞吐：一串常见的配网帧按不同的 recv 长度送入
+// prov_rx_process，统计每秒帧数和字节数
+
+static const char *FRAMES[] = {
+    "{\"ssid\":\"HomeNet-5G\",\"pass\":\"correct horse\",\"user\":\"u1024\","
+    "\"room\":\"r1\"}",
+    "ssid:HomeNet,pass:secret,user:u1,room:r1\n",
+    "{\"lightNormal\":\"#ff8800\"}\n",
+    "reboot:1\r\n",
+};
+#define FRAME_NUM (int)(sizeof(FRAMES) / sizeof(FRAMES[0]))
+#define STREAM_SIZE 4096
+
+static char s_stream[STREAM_SIZE];
+static volatile long s_frames, s_bytes;
+
+static void on_frame(const char *frame, int len, void *arg) {
+    s_frames++;
+    s_bytes += len;
+}
+
+// 把流按 chunk 字节一段地送入，与 prov_receive 一样每次 recv 后处理
+static void run(const char *name, int stream_len, int frames, int chunk,
+                long n) {
+    static prov_rx_t rx;
+    long bytes = 0;
+
+    s_frames = 0;
+    int64_t start = bench_now_ns();
+    for (long i = 0; i < n; i++) {
+        int pos = 0;
+        memset(&rx, 0, sizeof(rx));
+        while (pos < stream_len) {
+            int len = stream_len - pos;
+            int room = PROV_RX_SIZE - rx.len;
+            len = len < chunk ? len : chunk;
+            len = len < room ? len : room;
+            memcpy(rx.buf + rx.len, s_stream + pos, len);
+            rx.len += len;
+            pos += len;
+            prov_rx_process(&rx, 0, on_frame, NULL);
+        }
+        bytes += stream_len;
+    }
+    int64_t ns = bench_now_ns() - start;
+    if (s_frames != (long)frames * n) {
+        printf("%s: %ld frames, expected %ld\n", name, s_frames,
+               (long)frames * n);
+    }
+    bench_report(name, s_frames, ns);
+    printf("%-32s %10.1f MB/s\n", name, bytes * 1e3 / (ns > 0 ? ns : 1));
+}
+
+int main(int argc, char **argv) {
+    long n = bench_iterations(argc, argv, 5000);
+    static const int chunks[] = {1, 16, 64, 536, 1460};
+    int len = 0, frames = 0;
+
+    while (len + (int)strlen(FRAMES[frames % FRAME_NUM]) < STREAM_SIZE) {
+        const char *f = FRAMES[frames % FRAME_NUM];
+        memcpy(s_stream + len, f, strlen(f));
+        len += strlen(f);
+        frames++;
+    }
+    printf("%d frames, %d bytes per stream\n", frames, len);
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "prov_rx_process, recv %d", chunks[i]);
+        run(name, len, frames, chunks[i], chunks[i] == 1 ? n / 20 : n);
+    }
+    return 0;
+}
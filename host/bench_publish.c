@@ -0,0 +1,74 @@
+#include "bench_host.h"
+#include "host_shim.h"
+#include "sdkconfig.h"
+#include "user_publish.h"
+#include <string.h>
+
+// 发布队列的开销和吞吐：
+// 每条消息入队加发送的主机耗时（令牌充足），以及持续输入时实际发出的速率
+
+#define CLIENT ((esp_mqtt_client_handle_t)&host_mqtt)
+
+// 每次都把令牌桶补满，只测量队列本身
+static void bench_event_cost(long n) {
+    int64_t start = bench_now_ns();
+    for (long i = 0; i < n; i++) {
+        host_time_us += 1000000;
+        publish_message("roomlight/dev/0123456789ab/key", "key:1,press:short",
+                        PUB_CLASS_EVENT);
+        publish_service();
+    }
+    bench_report("event enqueue + publish", n, bench_now_ns() - start);
+}
+
+static void bench_field_cost(long n) {
+    int64_t start = bench_now_ns();
+    for (long i = 0; i < n; i++) {
+        host_time_us += 1000000;
+        publish_field("color", i & 1 ? "#102030" : "#302010");
+        publish_field("sw", i & 1 ? "1" : "0");
+        publish_service();
+    }
+    bench_report("state report (2 fields)", n, bench_now_ns() - start);
+}
+
+// 以 rate_hz 持续产生事件 seconds 秒，统计发出、丢弃和平均速率
+static void bench_sustained(int rate_hz, int seconds) {
+    pub_stats_t before, after;
+    publish_get_stats(&before);
+    uint32_t published = host_mqtt.published;
+    int posted = 0;
+
+    host_time_us += 10000000; // 先让令牌桶回满
+    int64_t start = host_time_us;
+    for (int ms = 0; ms < seconds * 1000; ms++) {
+        if (ms * rate_hz / 1000 != (ms + 1) * rate_hz / 1000) {
+            publish_message("roomlight/key", "key:1", PUB_CLASS_EVENT);
+            posted++;
+        }
+        host_time_us += 1000;
+        publish_service();
+    }
+    publish_get_stats(&after);
+    uint32_t sent = host_mqtt.published - published;
+    printf("events at %3d/s for %ds: %5d posted %5u sent %5u dropped "
+           "%6.2f msg/s\n",
+           rate_hz, seconds, posted, sent, after.dropped - before.dropped,
+           sent * 1e6 / (host_time_us - start));
+    // 排空队列，不影响下一组
+    host_time_us += 10000000;
+    publish_service();
+}
+
+int main(int argc, char **argv) {
+    long n = bench_iterations(argc, argv, 200000);
+
+    publish_init();
+    publish_set_connected(CLIENT);
+    bench_event_cost(n);
+    bench_field_cost(n);
+    bench_sustained(CONFIG_ROOMLIGHT_PUBLISH_RATE, 60);
+    bench_sustained(CONFIG_ROOMLIGHT_PUBLISH_RATE * 4, 60);
+    bench_sustained(50, 10);
+    return 0;
+}
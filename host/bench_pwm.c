@@ -0,0 +1,40 @@
+#include "bench_host.h"
+#include "host_shim.h"
+#include "sdkconfig.h"
+#include "user_pwm.h"
+
+// 每帧的颜色管线开销：gamma 插值、校准矩阵、暂存和提交。
+// 主机周期数只用于比较改动前后，设备上需要另外测量
+
+static void bench_frames(const char *name, long frames, int commit) {
+    uint64_t cycles = bench_cycles();
+    int64_t start = bench_now_ns();
+    for (long n = 0; n < frames; n++) {
+        if (commit) {
+            host_time_us += CONFIG_ROOMLIGHT_PWM_MIN_COMMIT_MS * 1000;
+        }
+        uint16_t level = (uint16_t)(n * 40503);
+        set_rgb48(level, level ^ 0x5555, ~level);
+    }
+    int64_t ns = bench_now_ns() - start;
+    cycles = bench_cycles() - cycles;
+    bench_report(name, frames, ns);
+    if (cycles != 0) {
+        printf("%-32s %10.1f cycles/frame\n", name, (double)cycles / frames);
+    }
+}
+
+int main(int argc, char **argv) {
+    static const uint32_t io[3] = {12, 13, 14};
+    static const uint32_t duty[3] = {0, 0, 0};
+    long frames = bench_iterations(argc, argv, 1000000);
+
+    int64_t start = bench_now_ns();
+    init_pwm(io, 3, 1000, duty);
+    bench_report("init_pwm (gamma LUT)", 1, bench_now_ns() - start);
+
+    bench_frames("set_rgb48, committed", frames, 1);
+    // 频率限制内的帧只暂存不提交
+    bench_frames("set_rgb48, coalesced", frames, 0);
+    return host_pwm.starts > 0 ? 0 : 1;
+}
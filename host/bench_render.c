@@ -0,0 +1,126 @@
+#include "bench_host.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "host_shim.h"
+#include "sim.h"
+#include "user_cmd.h"
+#include "user_config.h"
+#include "user_nvs.h"
+#include "user_pwm.h"
+#include <stdio.h>
+#include <string.h>
+
+// 命令到 PWM 输出的时延直方图：lightPeriod 交替闪烁中，在随机时刻发送
+// 新的 lightSwitch1/2，逐毫秒推进虚拟时间直到占空比变化。
+// 先测当前的 pwm_update_task，再换成改动前按 vTaskDelay 分段的循环
+
+#define NVS_FILE "bench_render.bin"
+#define SEC 1000000LL
+#define PERIOD_MS 1000
+#define TIMEOUT_MS (4 * PERIOD_MS)
+
+void app_main(void);
+
+static const uint32_t bucket_ms[] = {1,   2,   5,   10,   20,  50,
+                                     100, 200, 500, 1000, 2000};
+#define BUCKETS (sizeof(bucket_ms) / sizeof(bucket_ms[0]) + 1)
+
+static void provision(void) {
+    const char *packet = "ssid:home,pass:secret,user:u1,room:r1,"
+                         "lightPeriod:1000,lightSwitch1:#ff4000,"
+                         "lightSwitch2:#004000";
+    remove(NVS_FILE);
+    host_nvs_reset(NVS_FILE);
+    init_nvs();
+    nvs_read_data_from_flash();
+    parse_data_packet(packet, strlen(packet), &nvs_data);
+    nvs_flush();
+    host_nvs_reset(NVS_FILE);
+}
+
+// 改动前（bfdcbe4 之前）pwm_update_task 的 MQTT_CONNECTED 分支：
+// 每个半周期设置一次颜色后 vTaskDelay，期间不看新命令
+static void legacy_render_task(void *arg) {
+    while (1) {
+        uint32_t period = light_config.lightPeriod;
+        if (period >= 500) {
+            effect_rgb_t c = light_config.lightSwitch1;
+            set_rgb48(c.r, c.g, c.b);
+            vTaskDelay(pdMS_TO_TICKS(period));
+            c = light_config.lightSwitch2;
+            set_rgb48(c.r, c.g, c.b);
+            vTaskDelay(pdMS_TO_TICKS(period));
+        } else {
+            effect_rgb_t c = light_config.lightNormal;
+            set_rgb48(c.r, c.g, c.b);
+            vTaskDelay(pdMS_TO_TICKS(500));
+        }
+    }
+}
+
+// 两个颜色的绿色分量相同且每次命令都改变绿色，输出通道 2（绿）变化即已生效
+static void measure(const char *name, long n) {
+    uint32_t hist[BUCKETS] = {0};
+    uint32_t max_ms = 0, timeouts = 0;
+    uint64_t sum_ms = 0;
+    uint32_t seed = 1;
+
+    for (long k = 0; k < n; k++) {
+        char cmd[64];
+        uint32_t green = (k & 1) ? 0x40 : 0xc0;
+
+        seed = seed * 1103515245 + 12345;
+        sim_run_for((seed >> 8) % (2 * PERIOD_MS) * 1000 + 1000);
+        uint32_t before = host_pwm.duty[2];
+        snprintf(cmd, sizeof(cmd),
+                 "lightSwitch1:#ff%02x00,lightSwitch2:#00%02x00",
+                 (unsigned)green, (unsigned)green);
+        cmd_queue_post(CMD_SRC_LOCAL, cmd, strlen(cmd));
+
+        uint32_t ms = 0;
+        while (host_pwm.duty[2] == before && ms < TIMEOUT_MS) {
+            sim_run_for(1000);
+            ms++;
+        }
+        if (ms == TIMEOUT_MS) {
+            timeouts++;
+        }
+        size_t b = 0;
+        while (b < BUCKETS - 1 && ms > bucket_ms[b]) {
+            b++;
+        }
+        hist[b]++;
+        sum_ms += ms;
+        max_ms = ms > max_ms ? ms : max_ms;
+    }
+
+    printf("%s: %ld commands, lightPeriod %d ms, mean %.1f ms, max %u ms, "
+           "%u timed out\n",
+           name, n, PERIOD_MS, (double)sum_ms / n, max_ms, timeouts);
+    for (size_t b = 0; b < BUCKETS; b++) {
+        if (b < BUCKETS - 1) {
+            printf("  <= %4u ms %6u\n", bucket_ms[b], hist[b]);
+        } else {
+            printf("   > %4u ms %6u\n", bucket_ms[b - 1], hist[b]);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    long n = bench_iterations(argc, argv, 200);
+
+    provision();
+    app_main();
+    sim_run_for(5 * SEC);
+    if (dev_state != DEV_MQTT_CONNECTED) {
+        printf("not connected (state %d)\n", dev_state);
+        return 1;
+    }
+    measure("event-driven render", n);
+
+    vTaskDelete(sim_find_task("PWM Update Task"));
+    xTaskCreate(legacy_render_task, "legacy render", 2048, NULL, 10, NULL);
+    measure("vTaskDelay render (before)", n);
+    remove(NVS_FILE);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "bench_host.h"
+#include "user_sched.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 满表（SCHED_RULE_NUM 条规则）时 sched_next 的耗时：从每次触发的时刻
+// 继续求下一次，分别走过普通的一周和夏令时切换的一周（含不存在和重复的 02:30）
+
+static const char *TABLE = "3e@0700=c#ffc080|41@0900=s2|7f@0230=c#000010|"
+                           "7f@2300=e500/000000|15@1230=s1|2a@1815=c#102030|"
+                           "7f@0000=s3|40@0259=c#ffffff";
+
+static time_t local_time(int year, int mon, int day, int hour) {
+    struct tm tm = {
+        .tm_year = year - 1900,
+        .tm_mon = mon - 1,
+        .tm_mday = day,
+        .tm_hour = hour,
+        .tm_isdst = -1,
+    };
+    return mktime(&tm);
+}
+
+// 从 start 起连续求 n 次下一触发时刻，每次从上一次触发之后继续
+static void walk(const char *name, const sched_table_t *table, time_t start,
+                 long n) {
+    time_t now = start;
+    long fired = 0;
+    uint8_t due;
+
+    int64_t begin = bench_now_ns();
+    for (long i = 0; i < n; i++) {
+        time_t at = sched_next(table, now, &due);
+        if (at < 0) {
+            break;
+        }
+        fired += __builtin_popcount(due);
+        // 一周之后回到起点，始终在同一段日期里测量
+        now = at + 1 - start >= 7 * 86400 ? start : at + 1;
+    }
+    bench_report(name, n, bench_now_ns() - begin);
+    if (fired == 0) {
+        printf("%s: no rule fired\n", name);
+    }
+}
+
+int main(int argc, char **argv) {
+    long n = bench_iterations(argc, argv, 50000);
+    sched_table_t table;
+
+    if (sched_parse(TABLE, strlen(TABLE), &table) != SCHED_RULE_NUM) {
+        printf("table parse failed\n");
+        return 1;
+    }
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+    walk("sched_next, 8 rules, plain week", &table,
+         local_time(2024, 6, 10, 12), n);
+    walk("sched_next, 8 rules, spring DST", &table,
+         local_time(2024, 3, 28, 12), n);
+    walk("sched_next, 8 rules, autumn DST", &table,
+         local_time(2024, 10, 24, 12), n);
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    walk("sched_next, 8 rules, UTC", &table, local_time(2024, 3, 28, 12), n);
+    return 0;
+}
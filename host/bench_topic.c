@@ -0,0 +1,80 @@
+#include "bench_host.h"
+#include "user_mqtt.h"
+#include "user_topic.h"
+#include <string.h>
+
+// 一条房间主题消息的扇出：房间内 N 盏灯各自按 mqtt_build_routes 的顺序
+// 建立路由表，测每盏灯 topic_route_find 找到处理函数的耗时。
+// 各灯并行处理，扇出时延取决于单灯耗时的最大值；对比后端逐个发布的 N 条消息
+
+#define ROOM "r1"
+#define REPEAT 1000 // 每盏灯重复查找的次数，减小计时开销的影响
+
+static volatile int s_sink;
+
+static void handle_ctrl(esp_mqtt_event_handle_t event) {
+}
+
+static void handle_get(esp_mqtt_event_handle_t event) {
+}
+
+// 与 mqtt_build_routes 相同的路由：设备 ctrl/get、旧版主题、房间、用户
+static void build_routes(int device) {
+    char sn[13];
+    char topic[TOPIC_SIZE];
+
+    snprintf(sn, sizeof(sn), "a4cf12%06x", device);
+    topic_route_clear();
+    topic_build(topic, sizeof(topic), TOPIC_SCOPE_DEVICE, sn, "ctrl");
+    topic_route_add(topic, handle_ctrl);
+    topic_build(topic, sizeof(topic), TOPIC_SCOPE_DEVICE, sn, "get");
+    topic_route_add(topic, handle_get);
+    topic_route_add(MQTT_SubscribeTopic, handle_ctrl);
+    topic_build(topic, sizeof(topic), TOPIC_SCOPE_ROOM, ROOM, "ctrl");
+    topic_route_add(topic, handle_ctrl);
+    topic_build(topic, sizeof(topic), TOPIC_SCOPE_USER, "u1", "ctrl");
+    topic_route_add(topic, handle_ctrl);
+}
+
+static void fanout(int devices, int print) {
+    char topic[TOPIC_SIZE];
+    int len = topic_build(topic, sizeof(topic), TOPIC_SCOPE_ROOM, ROOM, "ctrl");
+    int64_t total_ns = 0, max_ns = 0, build_ns = 0;
+    int routed = 0;
+
+    for (int d = 0; d < devices; d++) {
+        int64_t start = bench_now_ns();
+        build_routes(d);
+        int64_t mid = bench_now_ns();
+        for (int i = 0; i < REPEAT; i++) {
+            topic_handler_t handler = topic_route_find(topic, len);
+            s_sink += handler != NULL;
+            if (i == 0 && handler == handle_ctrl) {
+                routed++;
+            }
+        }
+        int64_t ns = (bench_now_ns() - mid) / REPEAT;
+        build_ns += mid - start;
+        total_ns += ns;
+        max_ns = ns > max_ns ? ns : max_ns;
+    }
+    if (!print) {
+        return;
+    }
+    printf("%7d %7d %9.1f %8lld %10lld %10.1f\n", devices, routed,
+           (double)total_ns / devices, (long long)max_ns, (long long)total_ns,
+           (double)build_ns / devices);
+}
+
+int main(int argc, char **argv) {
+    long n = bench_iterations(argc, argv, 256);
+
+    fanout(16, 0); // 预热
+    printf("one room message, 5 routes per device; the backend publishes once "
+           "instead of once per device\n");
+    printf("devices  routed  ns/route  max(ns)  serial(ns)  build(ns)\n");
+    for (long devices = 1; devices <= n; devices *= 4) {
+        fanout(devices, 1);
+    }
+    return 0;
+}
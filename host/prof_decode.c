@@ -0,0 +1,114 @@
+#include "user_prof.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// 设备上报的启动耗时统计：从文件或标准输入逐行读取，每行中 "prof:" 开始的部分
+// 是一条 prof_format 记录（可以带主题等前缀，例如订阅工具的输出）。
+// 按阶段输出到达时间（开机后毫秒数）和本阶段耗时（距上一个已到达阶段）的分位数。
+// 用法：prof_decode [文件]
+
+static const char *const PHASE_NAMES[PROF_PHASE_MAX] = {
+    [PROF_BOOT] = "boot",
+    [PROF_NVS_READY] = "nvs_ready",
+    [PROF_WIFI_START] = "wifi_start",
+    [PROF_WIFI_CONNECTED] = "wifi_connected",
+    [PROF_GOT_IP] = "got_ip",
+    [PROF_SNTP_DONE] = "sntp_done",
+    [PROF_MQTT_START] = "mqtt_start",
+    [PROF_MQTT_CONNECTING] = "mqtt_connecting",
+    [PROF_MQTT_CONNECTED] = "mqtt_connected",
+};
+
+typedef struct
+{
+    uint32_t *v;
+    int n;
+    int cap;
+} samples_t;
+
+static void samples_add(samples_t *s, uint32_t v) {
+    if (s->n == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 64;
+        s->v = realloc(s->v, s->cap * sizeof(s->v[0]));
+        if (s->v == NULL) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    s->v[s->n++] = v;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// 最近秩法，要求已排序
+static uint32_t percentile(const samples_t *s, int p) {
+    int rank = (s->n * p + 99) / 100;
+    return s->v[rank > 0 ? rank - 1 : 0];
+}
+
+static void print_row(const char *name, samples_t *s) {
+    if (s->n == 0) {
+        printf("  %-16s %6d %8s %8s %8s %8s\n", name, 0, "-", "-", "-", "-");
+        return;
+    }
+    qsort(s->v, s->n, sizeof(s->v[0]), cmp_u32);
+    printf("  %-16s %6d %8u %8u %8u %8u\n", name, s->n, percentile(s, 50),
+           percentile(s, 90), percentile(s, 99), s->v[s->n - 1]);
+}
+
+int main(int argc, char **argv) {
+    FILE *in = stdin;
+    char line[512];
+    samples_t at[PROF_PHASE_MAX] = {{0}}, step[PROF_PHASE_MAX] = {{0}};
+    int records = 0, skipped = 0;
+
+    if (argc > 1 && (in = fopen(argv[1], "r")) == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+    while (fgets(line, sizeof(line), in) != NULL) {
+        const char *start = strstr(line, "prof:");
+        prof_record_t rec;
+        if (start == NULL) {
+            continue;
+        }
+        if (prof_parse(start, &rec) != 0) {
+            skipped++;
+            continue;
+        }
+        records++;
+        uint32_t last = 0;
+        for (int i = 0; i < PROF_PHASE_MAX; i++) {
+            if (rec.marks[i] == 0) {
+                continue;
+            }
+            samples_add(&at[i], rec.marks[i]);
+            if (i > 0 && last != 0 && rec.marks[i] >= last) {
+                samples_add(&step[i], rec.marks[i] - last);
+            }
+            last = rec.marks[i];
+        }
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    printf("%d records, %d skipped\n", records, skipped);
+    printf("time since boot (ms)\n");
+    printf("  %-16s %6s %8s %8s %8s %8s\n", "phase", "n", "p50", "p90", "p99",
+           "max");
+    for (int i = 0; i < PROF_PHASE_MAX; i++) {
+        print_row(PHASE_NAMES[i], &at[i]);
+    }
+    printf("time in phase, since the previous reached phase (ms)\n");
+    printf("  %-16s %6s %8s %8s %8s %8s\n", "phase", "n", "p50", "p90", "p99",
+           "max");
+    for (int i = 1; i < PROF_PHASE_MAX; i++) {
+        print_row(PHASE_NAMES[i], &step[i]);
+    }
+    return records > 0 ? 0 : 1;
+}
@@ -0,0 +1,29 @@
+#ifndef HOST_DRIVER_GPIO_H
+#define HOST_DRIVER_GPIO_H
+
+#include "esp_err.h"
+#include <stdint.h>
+
+typedef enum
+{
+    GPIO_INTR_DISABLE = 0,
+} gpio_int_type_t;
+
+typedef enum
+{
+    GPIO_MODE_INPUT = 1,
+} gpio_mode_t;
+
+typedef struct
+{
+    uint32_t pin_bit_mask;
+    gpio_mode_t mode;
+    int pull_up_en;
+    int pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+esp_err_t gpio_config(const gpio_config_t *conf);
+int gpio_get_level(int gpio_num);
+
+#endif // HOST_DRIVER_GPIO_H
@@ -0,0 +1,13 @@
+#ifndef HOST_DRIVER_PWM_H
+#define HOST_DRIVER_PWM_H
+
+#include "esp_err.h"
+
+// 与 ESP8266_RTOS_SDK 的 driver/pwm.h 签名一致，占空比记录在 host_pwm 中
+esp_err_t pwm_init(uint32_t period, uint32_t *duties, uint8_t channel_num,
+                   const uint32_t *pin_num);
+esp_err_t pwm_set_duty(uint8_t channel_num, uint32_t duty);
+esp_err_t pwm_set_phases(float *phases);
+esp_err_t pwm_start(void);
+
+#endif // HOST_DRIVER_PWM_H
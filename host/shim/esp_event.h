@@ -0,0 +1,8 @@
+#ifndef HOST_ESP_EVENT_H
+#define HOST_ESP_EVENT_H
+
+#include "esp_err.h"
+
+typedef const char *esp_event_base_t;
+
+#endif // HOST_ESP_EVENT_H
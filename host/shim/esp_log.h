@@ -0,0 +1,20 @@
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include "esp_err.h"
+#include <stdio.h>
+
+// 只输出错误和警告，保持测试输出简洁；其余级别仍检查格式和参数
+#define ESP_LOGE(tag, fmt, ...) printf("E (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) printf("W (%s) " fmt "\n", tag, ##__VA_ARGS__)
+#define HOST_LOG_NONE(tag, fmt, ...)                                           \
+    do {                                                                       \
+        if (0) {                                                               \
+            printf("%s " fmt, tag, ##__VA_ARGS__);                             \
+        }                                                                      \
+    } while (0)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG_NONE(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) HOST_LOG_NONE(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) HOST_LOG_NONE(tag, fmt, ##__VA_ARGS__)
+
+#endif // HOST_ESP_LOG_H
@@ -0,0 +1,11 @@
+#ifndef HOST_ESP_OTA_OPS_H
+#define HOST_ESP_OTA_OPS_H
+
+typedef struct
+{
+    char version[32];
+} esp_app_desc_t;
+
+const esp_app_desc_t *esp_ota_get_app_description(void);
+
+#endif // HOST_ESP_OTA_OPS_H
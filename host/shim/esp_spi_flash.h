@@ -0,0 +1,8 @@
+#ifndef HOST_ESP_SPI_FLASH_H
+#define HOST_ESP_SPI_FLASH_H
+
+#include <stddef.h>
+
+size_t spi_flash_get_chip_size(void);
+
+#endif // HOST_ESP_SPI_FLASH_H
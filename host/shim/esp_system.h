@@ -0,0 +1,9 @@
+#ifndef HOST_ESP_SYSTEM_H
+#define HOST_ESP_SYSTEM_H
+
+#include <stdint.h>
+
+// 固定序列，测试结果可重复
+uint32_t esp_random(void);
+
+#endif // HOST_ESP_SYSTEM_H
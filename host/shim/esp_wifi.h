@@ -0,0 +1,19 @@
+#ifndef HOST_ESP_WIFI_H
+#define HOST_ESP_WIFI_H
+
+#include "esp_err.h"
+
+typedef enum
+{
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+} wifi_mode_t;
+
+// 只提供 user_nvs.c 和 main 用到的系统接口
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac);
+// 主机上不会重启，只计数后返回
+void esp_restart(void);
+
+#endif // HOST_ESP_WIFI_H
@@ -0,0 +1,24 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include "sdkconfig.h"
+#include <stdint.h>
+
+// 主机测试单线程运行：临界区为空操作，节拍由 host_time_us 换算
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS (1000 / CONFIG_FREERTOS_HZ)
+#define pdMS_TO_TICKS(ms)                                                      \
+    ((TickType_t)((uint64_t)(ms) * CONFIG_FREERTOS_HZ / 1000))
+
+#define portENTER_CRITICAL() ((void)0)
+#define portEXIT_CRITICAL() ((void)0)
+
+#endif // HOST_FREERTOS_H
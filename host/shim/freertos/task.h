@@ -0,0 +1,33 @@
+#ifndef HOST_FREERTOS_TASK_H
+#define HOST_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+// 任务只是一个通知值，测试直接检查其中的位
+typedef struct
+{
+    uint32_t notify;
+    uint32_t notify_calls; // 收到的通知次数
+} host_task_t;
+typedef host_task_t *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+typedef enum
+{
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+} eNotifyAction;
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+TickType_t xTaskGetTickCount(void);
+// 只分配句柄，不运行任务函数；测试直接调用模块的处理函数
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack,
+                       void *arg, UBaseType_t prio, TaskHandle_t *handle);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+// 不等待，只推进 host_time_us
+void vTaskDelay(TickType_t ticks);
+
+#endif // HOST_FREERTOS_TASK_H
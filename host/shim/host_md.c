@@ -0,0 +1,150 @@
+#include "mbedtls/md.h"
+#include <string.h>
+
+static const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const mbedtls_md_info_t s_sha256 = {MBEDTLS_MD_SHA256};
+
+#define ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_block(host_sha256_t *sha) {
+    uint32_t w[64], s[8];
+
+    for (int i = 0; i < 16; i++) {
+        const uint8_t *p = sha->block + 4 * i;
+        w[i] = (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROR(w[i - 15], 7) ^ ROR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROR(w[i - 2], 17) ^ ROR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    memcpy(s, sha->state, sizeof(s));
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = s[7] + (ROR(s[4], 6) ^ ROR(s[4], 11) ^ ROR(s[4], 25)) +
+                      ((s[4] & s[5]) ^ (~s[4] & s[6])) + K[i] + w[i];
+        uint32_t t2 = (ROR(s[0], 2) ^ ROR(s[0], 13) ^ ROR(s[0], 22)) +
+                      ((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+        memmove(s + 1, s, 7 * sizeof(s[0]));
+        s[4] += t1;
+        s[0] = t1 + t2;
+    }
+    for (int i = 0; i < 8; i++) {
+        sha->state[i] += s[i];
+    }
+}
+
+static void sha256_start(host_sha256_t *sha) {
+    static const uint32_t H[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    memcpy(sha->state, H, sizeof(H));
+    sha->total = 0;
+}
+
+static void sha256_update(host_sha256_t *sha, const uint8_t *p, size_t len) {
+    while (len > 0) {
+        size_t used = sha->total % 64;
+        size_t n = 64 - used < len ? 64 - used : len;
+        memcpy(sha->block + used, p, n);
+        sha->total += n;
+        p += n;
+        len -= n;
+        if (sha->total % 64 == 0) {
+            sha256_block(sha);
+        }
+    }
+}
+
+static void sha256_finish(host_sha256_t *sha, uint8_t out[32]) {
+    uint64_t bits = sha->total * 8;
+    uint8_t pad = 0x80;
+    uint8_t len[8];
+
+    sha256_update(sha, &pad, 1);
+    pad = 0;
+    while (sha->total % 64 != 56) {
+        sha256_update(sha, &pad, 1);
+    }
+    for (int i = 0; i < 8; i++) {
+        len[i] = bits >> (56 - 8 * i);
+    }
+    sha256_update(sha, len, 8);
+    for (int i = 0; i < 32; i++) {
+        out[i] = sha->state[i / 4] >> (24 - 8 * (i % 4));
+    }
+}
+
+const mbedtls_md_info_t *mbedtls_md_info_from_type(mbedtls_md_type_t type) {
+    return type == MBEDTLS_MD_SHA256 ? &s_sha256 : NULL;
+}
+
+void mbedtls_md_init(mbedtls_md_context_t *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void mbedtls_md_free(mbedtls_md_context_t *ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+int mbedtls_md_setup(mbedtls_md_context_t *ctx, const mbedtls_md_info_t *info,
+                     int hmac) {
+    if (info == NULL || !hmac) {
+        return -1;
+    }
+    ctx->md_info = info;
+    return 0;
+}
+
+int mbedtls_md_hmac_starts(mbedtls_md_context_t *ctx, const unsigned char *key,
+                           size_t keylen) {
+    uint8_t k[64] = {0};
+    uint8_t ipad[64];
+
+    if (keylen > sizeof(k)) {
+        sha256_start(&ctx->sha);
+        sha256_update(&ctx->sha, key, keylen);
+        sha256_finish(&ctx->sha, k);
+    } else {
+        memcpy(k, key, keylen);
+    }
+    for (int i = 0; i < 64; i++) {
+        ipad[i] = k[i] ^ 0x36;
+        ctx->sha.opad[i] = k[i] ^ 0x5c;
+    }
+    sha256_start(&ctx->sha);
+    sha256_update(&ctx->sha, ipad, sizeof(ipad));
+    return 0;
+}
+
+int mbedtls_md_hmac_update(mbedtls_md_context_t *ctx,
+                           const unsigned char *input, size_t ilen) {
+    sha256_update(&ctx->sha, input, ilen);
+    return 0;
+}
+
+int mbedtls_md_hmac_finish(mbedtls_md_context_t *ctx, unsigned char *output) {
+    uint8_t inner[32];
+    uint8_t opad[64];
+
+    sha256_finish(&ctx->sha, inner);
+    memcpy(opad, ctx->sha.opad, sizeof(opad));
+    sha256_start(&ctx->sha);
+    sha256_update(&ctx->sha, opad, sizeof(opad));
+    sha256_update(&ctx->sha, inner, sizeof(inner));
+    sha256_finish(&ctx->sha, output);
+    return 0;
+}
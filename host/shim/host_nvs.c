@@ -0,0 +1,216 @@
+#include "host_shim.h"
+#include "nvs_flash.h"
+#include <stdio.h>
+#include <string.h>
+
+// 文件后备的 NVS 模拟：条目保存在内存中，commit 时整体写入 s_path，
+// nvs_flash_init 从 s_path 载入，用于模拟断电重启后的启动读取
+
+#define HOST_NVS_ENTRIES 32
+#define HOST_NVS_NAMESPACES 4
+#define HOST_NVS_KEY_MAX 16
+#define HOST_NVS_VALUE_MAX 512
+
+typedef enum
+{
+    ENTRY_FREE = 0,
+    ENTRY_U32,
+    ENTRY_STR,
+    ENTRY_BLOB,
+} entry_type_t;
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t ns;
+    char key[HOST_NVS_KEY_MAX];
+    uint32_t len;
+    uint8_t data[HOST_NVS_VALUE_MAX];
+} entry_t;
+
+static entry_t s_entries[HOST_NVS_ENTRIES];
+static char s_namespaces[HOST_NVS_NAMESPACES][HOST_NVS_KEY_MAX];
+static char s_path[256];
+static int s_initialized;
+
+host_nvs_stats_t host_nvs;
+
+void host_nvs_reset(const char *path) {
+    memset(s_entries, 0, sizeof(s_entries));
+    memset(s_namespaces, 0, sizeof(s_namespaces));
+    memset(&host_nvs, 0, sizeof(host_nvs));
+    s_initialized = 0;
+    s_path[0] = '\0';
+    if (path != NULL) {
+        snprintf(s_path, sizeof(s_path), "%s", path);
+    }
+}
+
+static void nvs_save_file(void) {
+    if (s_path[0] == '\0') {
+        return;
+    }
+    FILE *f = fopen(s_path, "wb");
+    if (f != NULL) {
+        fwrite(s_namespaces, sizeof(s_namespaces), 1, f);
+        fwrite(s_entries, sizeof(s_entries), 1, f);
+        fclose(f);
+    }
+}
+
+esp_err_t nvs_flash_init(void) {
+    memset(s_entries, 0, sizeof(s_entries));
+    memset(s_namespaces, 0, sizeof(s_namespaces));
+    FILE *f = s_path[0] != '\0' ? fopen(s_path, "rb") : NULL;
+    if (f != NULL) {
+        if (fread(s_namespaces, sizeof(s_namespaces), 1, f) != 1 ||
+            fread(s_entries, sizeof(s_entries), 1, f) != 1) {
+            memset(s_entries, 0, sizeof(s_entries));
+            memset(s_namespaces, 0, sizeof(s_namespaces));
+        }
+        fclose(f);
+    }
+    s_initialized = 1;
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    memset(s_entries, 0, sizeof(s_entries));
+    memset(s_namespaces, 0, sizeof(s_namespaces));
+    nvs_save_file();
+    return ESP_OK;
+}
+
+// 句柄即命名空间下标加 1
+esp_err_t nvs_open(const char *name, nvs_open_mode mode, nvs_handle *handle) {
+    if (!s_initialized) {
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    host_nvs.opens++;
+    for (int i = 0; i < HOST_NVS_NAMESPACES; i++) {
+        if (strcmp(s_namespaces[i], name) == 0) {
+            *handle = i + 1;
+            return ESP_OK;
+        }
+    }
+    if (mode == NVS_READONLY) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    for (int i = 0; i < HOST_NVS_NAMESPACES; i++) {
+        if (s_namespaces[i][0] == '\0') {
+            snprintf(s_namespaces[i], HOST_NVS_KEY_MAX, "%s", name);
+            *handle = i + 1;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+}
+
+void nvs_close(nvs_handle handle) {
+}
+
+esp_err_t nvs_commit(nvs_handle handle) {
+    if (host_nvs.fail_commits > 0) {
+        host_nvs.fail_commits--;
+        return ESP_FAIL;
+    }
+    host_nvs.commits++;
+    nvs_save_file();
+    return ESP_OK;
+}
+
+static entry_t *entry_find(nvs_handle handle, const char *key) {
+    for (int i = 0; i < HOST_NVS_ENTRIES; i++) {
+        if (s_entries[i].type != ENTRY_FREE && s_entries[i].ns == handle &&
+            strcmp(s_entries[i].key, key) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t entry_set(nvs_handle handle, const char *key,
+                           entry_type_t type, const void *value, size_t len) {
+    entry_t *e = entry_find(handle, key);
+    if (len > HOST_NVS_VALUE_MAX || strlen(key) >= HOST_NVS_KEY_MAX) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    for (int i = 0; e == NULL && i < HOST_NVS_ENTRIES; i++) {
+        if (s_entries[i].type == ENTRY_FREE) {
+            e = &s_entries[i];
+        }
+    }
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+    }
+    e->type = type;
+    e->ns = handle;
+    strcpy(e->key, key);
+    e->len = len;
+    memcpy(e->data, value, len);
+    host_nvs.writes++;
+    host_nvs.bytes_written += len;
+    return ESP_OK;
+}
+
+// length 为 NULL 时要求长度正好为 4（u32）
+static esp_err_t entry_get(nvs_handle handle, const char *key,
+                           entry_type_t type, void *value, size_t *length) {
+    entry_t *e = entry_find(handle, key);
+    host_nvs.reads++;
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    if (e->type != type) {
+        return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    if (value == NULL) {
+        *length = e->len;
+        return ESP_OK;
+    }
+    if (*length < e->len) {
+        return ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    memcpy(value, e->data, e->len);
+    *length = e->len;
+    host_nvs.bytes_read += e->len;
+    return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle handle, const char *key) {
+    entry_t *e = entry_find(handle, key);
+    if (e == NULL) {
+        return ESP_ERR_NVS_NOT_FOUND;
+    }
+    e->type = ENTRY_FREE;
+    host_nvs.writes++;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_u32(nvs_handle handle, const char *key, uint32_t value) {
+    return entry_set(handle, key, ENTRY_U32, &value, sizeof(value));
+}
+
+esp_err_t nvs_get_u32(nvs_handle handle, const char *key, uint32_t *value) {
+    size_t len = sizeof(*value);
+    return entry_get(handle, key, ENTRY_U32, value, &len);
+}
+
+esp_err_t nvs_set_str(nvs_handle handle, const char *key, const char *value) {
+    return entry_set(handle, key, ENTRY_STR, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle handle, const char *key, char *value,
+                      size_t *length) {
+    return entry_get(handle, key, ENTRY_STR, value, length);
+}
+
+esp_err_t nvs_set_blob(nvs_handle handle, const char *key, const void *value,
+                       size_t length) {
+    return entry_set(handle, key, ENTRY_BLOB, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle handle, const char *key, void *value,
+                       size_t *length) {
+    return entry_get(handle, key, ENTRY_BLOB, value, length);
+}
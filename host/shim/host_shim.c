@@ -0,0 +1,167 @@
+#include "host_shim.h"
+#include "driver/pwm.h"
+#include "esp_err.h"
+#include "esp_ota_ops.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "mqtt_client.h"
+#include <stdio.h>
+#include <string.h>
+
+int64_t host_time_us;
+host_pwm_t host_pwm;
+int host_failures;
+int host_restarts;
+host_mqtt_t host_mqtt;
+
+#define HOST_TIMERS 8
+
+struct host_timer
+{
+    esp_timer_create_args_t args;
+    int64_t expiry; // 0 表示未启动
+};
+
+static struct host_timer s_timers[HOST_TIMERS];
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK:
+        return "ESP_OK";
+    case ESP_ERR_NO_MEM:
+        return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+        return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_NOT_FOUND:
+        return "ESP_ERR_NOT_FOUND";
+    default:
+        return "ESP_FAIL";
+    }
+}
+
+int64_t esp_timer_get_time(void) {
+    return host_time_us;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args,
+                           esp_timer_handle_t *handle) {
+    for (int i = 0; i < HOST_TIMERS; i++) {
+        if (s_timers[i].args.callback == NULL) {
+            s_timers[i].args = *args;
+            s_timers[i].expiry = 0;
+            *handle = &s_timers[i];
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (timer->expiry != 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->expiry = host_time_us + timeout_us + 1;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (timer->expiry == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->expiry = 0;
+    return ESP_OK;
+}
+
+void host_advance_us(int64_t us) {
+    int64_t target = host_time_us + us;
+    while (1) {
+        struct host_timer *next = NULL;
+        for (int i = 0; i < HOST_TIMERS; i++) {
+            if (s_timers[i].expiry != 0 && s_timers[i].expiry - 1 <= target &&
+                (next == NULL || s_timers[i].expiry < next->expiry)) {
+                next = &s_timers[i];
+            }
+        }
+        if (next == NULL) {
+            break;
+        }
+        host_time_us = next->expiry - 1;
+        next->expiry = 0;
+        next->args.callback(next->args.arg);
+    }
+    host_time_us = target;
+}
+
+int64_t host_next_timer_us(void) {
+    int64_t next = INT64_MAX;
+    for (int i = 0; i < HOST_TIMERS; i++) {
+        if (s_timers[i].expiry != 0 && s_timers[i].expiry - 1 < next) {
+            next = s_timers[i].expiry - 1;
+        }
+    }
+    return next;
+}
+
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac) {
+    static const uint8_t MAC[6] = {0x30, 0xae, 0xa4, 0x80, 0x45, 0x69};
+    memcpy(mac, MAC, sizeof(MAC));
+    return ESP_OK;
+}
+
+void esp_restart(void) {
+    host_restarts++;
+}
+
+uint32_t esp_random(void) {
+    static uint32_t s_state = 1;
+    s_state = s_state * 1664525 + 1013904223;
+    return s_state;
+}
+
+const esp_app_desc_t *esp_ota_get_app_description(void) {
+    static const esp_app_desc_t desc = {"host"};
+    return &desc;
+}
+
+esp_err_t pwm_init(uint32_t period, uint32_t *duties, uint8_t channel_num,
+                   const uint32_t *pin_num) {
+    if (channel_num > HOST_PWM_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(&host_pwm, 0, sizeof(host_pwm));
+    host_pwm.period = period;
+    host_pwm.channel_num = channel_num;
+    memcpy(host_pwm.pending, duties, channel_num * sizeof(duties[0]));
+    return ESP_OK;
+}
+
+esp_err_t pwm_set_duty(uint8_t channel_num, uint32_t duty) {
+    if (channel_num >= host_pwm.channel_num) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_pwm.pending[channel_num] = duty;
+    return ESP_OK;
+}
+
+esp_err_t pwm_set_phases(float *phases) {
+    return ESP_OK;
+}
+
+esp_err_t pwm_start(void) {
+    memcpy(host_pwm.duty, host_pwm.pending, sizeof(host_pwm.duty));
+    host_pwm.starts++;
+    return ESP_OK;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain) {
+    if (host_mqtt.fail) {
+        return -1;
+    }
+    host_mqtt.published++;
+    host_mqtt.last_qos = qos;
+    snprintf(host_mqtt.last_topic, sizeof(host_mqtt.last_topic), "%s", topic);
+    snprintf(host_mqtt.last_data, sizeof(host_mqtt.last_data), "%s", data);
+    return (int)host_mqtt.published;
+}
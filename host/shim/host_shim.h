@@ -0,0 +1,52 @@
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+#include <stdint.h>
+
+#define HOST_PWM_CHANNELS 8
+
+typedef struct
+{
+    uint32_t period;
+    uint32_t channel_num;
+    uint32_t duty[HOST_PWM_CHANNELS]; // 最近一次 pwm_start 生效的占空比
+    uint32_t pending[HOST_PWM_CHANNELS];
+    uint32_t starts;
+} host_pwm_t;
+
+// 文件后备的 NVS 模拟：操作计数供测试统计写放大
+typedef struct
+{
+    uint32_t opens;
+    uint32_t reads;  // get 调用次数
+    uint32_t writes; // set/erase 调用次数
+    uint32_t commits;
+    uint32_t bytes_read;
+    uint32_t bytes_written;
+    int fail_commits; // 大于 0 时接下来的这么多次 commit 返回失败
+} host_nvs_stats_t;
+
+// MQTT 客户端：记录发布次数和最近一条消息
+typedef struct
+{
+    uint32_t published;
+    int fail;                 // 非 0 时 publish 返回 -1
+    int last_qos;
+    char last_topic[64];
+    char last_data[256];
+} host_mqtt_t;
+
+extern int64_t host_time_us;
+extern host_pwm_t host_pwm;
+extern host_nvs_stats_t host_nvs;
+extern int host_restarts;
+extern host_mqtt_t host_mqtt;
+
+// 推进 host_time_us，途中按到期顺序执行 esp_timer 回调
+void host_advance_us(int64_t us);
+// 最早到期的 esp_timer 的时刻，没有运行中的定时器时返回 INT64_MAX
+int64_t host_next_timer_us(void);
+// 清空内存中的 NVS；path 非空时之后的 commit 写入该文件，nvs_flash_init 从中载入
+void host_nvs_reset(const char *path);
+
+#endif // HOST_SHIM_H
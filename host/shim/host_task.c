@@ -0,0 +1,71 @@
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "host_shim.h"
+#include <stddef.h>
+
+// 单线程测试用的任务接口：任务函数不运行，通知只记录在 host_task_t 中。
+// 需要真正运行任务循环的程序链接 sim/sim_rtos.c
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    task->notify_calls++;
+    switch (action) {
+    case eSetBits:
+        task->notify |= value;
+        break;
+    case eIncrement:
+        task->notify++;
+        break;
+    case eSetValueWithOverwrite:
+        task->notify = value;
+        break;
+    default:
+        break;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(host_time_us / 1000 / portTICK_PERIOD_MS);
+}
+
+#define HOST_TASKS 8
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack,
+                       void *arg, UBaseType_t prio, TaskHandle_t *handle) {
+    static host_task_t tasks[HOST_TASKS];
+    static int count;
+    if (count == HOST_TASKS) {
+        return pdFAIL;
+    }
+    if (handle != NULL) {
+        *handle = &tasks[count];
+    }
+    count++;
+    return pdPASS;
+}
+
+// 任务函数不会在主机上运行，这里只为链接
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    return 0;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    host_advance_us((int64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    static int mutex;
+    return &mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return pdTRUE;
+}
@@ -0,0 +1,44 @@
+#ifndef HOST_MBEDTLS_MD_H
+#define HOST_MBEDTLS_MD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 只提供 HMAC-SHA256，实现在 shim/host_md.c
+typedef enum
+{
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_SHA256 = 6,
+} mbedtls_md_type_t;
+
+typedef struct
+{
+    mbedtls_md_type_t type;
+} mbedtls_md_info_t;
+
+typedef struct
+{
+    uint32_t state[8];
+    uint64_t total;
+    uint8_t block[64];
+    uint8_t opad[64];
+} host_sha256_t;
+
+typedef struct
+{
+    const mbedtls_md_info_t *md_info;
+    host_sha256_t sha;
+} mbedtls_md_context_t;
+
+const mbedtls_md_info_t *mbedtls_md_info_from_type(mbedtls_md_type_t type);
+void mbedtls_md_init(mbedtls_md_context_t *ctx);
+void mbedtls_md_free(mbedtls_md_context_t *ctx);
+int mbedtls_md_setup(mbedtls_md_context_t *ctx, const mbedtls_md_info_t *info,
+                     int hmac);
+int mbedtls_md_hmac_starts(mbedtls_md_context_t *ctx, const unsigned char *key,
+                           size_t keylen);
+int mbedtls_md_hmac_update(mbedtls_md_context_t *ctx,
+                           const unsigned char *input, size_t ilen);
+int mbedtls_md_hmac_finish(mbedtls_md_context_t *ctx, unsigned char *output);
+
+#endif // HOST_MBEDTLS_MD_H
@@ -0,0 +1,22 @@
+#ifndef HOST_MQTT_CLIENT_H
+#define HOST_MQTT_CLIENT_H
+
+// 事件供 user_topic.h 和 user_mqtt_session.c 使用；客户端只记录发布的消息
+typedef struct
+{
+    int msg_id;
+    char *topic;
+    int topic_len;
+    char *data;
+    int data_len;
+    int total_data_len;
+    int current_data_offset;
+} esp_mqtt_event_t;
+
+typedef esp_mqtt_event_t *esp_mqtt_event_handle_t;
+typedef struct host_mqtt_client *esp_mqtt_client_handle_t;
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain);
+
+#endif // HOST_MQTT_CLIENT_H
@@ -0,0 +1,33 @@
+#ifndef SIM_FREERTOS_TASK_H
+#define SIM_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+// 模拟器的任务接口：每个任务是一个线程，同一时刻只运行一个，
+// 阻塞时把 CPU 交还给 sim_run_until，节拍由 host_time_us 换算
+typedef struct sim_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+typedef enum
+{
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+} eNotifyAction;
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack,
+                       void *arg, UBaseType_t prio, TaskHandle_t *handle);
+void vTaskDelete(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+// 固件以 ULONG_MAX 清除全部位，主机上 long 为 64 位，参数按 unsigned long 接收
+BaseType_t xTaskNotifyWait(unsigned long clear_on_entry,
+                           unsigned long clear_on_exit, uint32_t *value,
+                           TickType_t ticks);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+
+#endif // SIM_FREERTOS_TASK_H
@@ -0,0 +1,46 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "freertos/task.h"
+#include <stdint.h>
+
+/*
+ * 固件模拟器
+ * main/ 和各组件的任务循环原样运行在 sim_rtos.c 上：每个任务一个线程，
+ * 同一时刻只有一个在运行，所有任务都阻塞后才推进虚拟时间 host_time_us。
+ * 任务运行本身不消耗虚拟时间，CPU 占用取各线程的主机 CPU 时间。
+ * Wi-Fi、MQTT 等网络部分由 sim_port.c 代替，按 sim_net 中的时延产生事件。
+ */
+
+#define SIM_TASKS 16
+
+typedef struct
+{
+    const char *name;
+    uint32_t wakeups; // 从阻塞中恢复运行的次数
+    int64_t cpu_ns;   // 主机线程 CPU 时间
+} sim_task_stats_t;
+
+// 网络模拟参数，单位毫秒
+typedef struct
+{
+    uint32_t wifi_connect_ms; // 开始连接到获得 IP
+    uint32_t mqtt_connect_ms; // 启动 MQTT 客户端到连上
+    int wifi_fail;            // 非 0 时 STA 连接一直失败
+    uint32_t key_events;      // 上报的按键事件数
+} sim_net_t;
+
+extern sim_net_t sim_net;
+extern int sim_gpio_level; // GPIO16 电平，1 表示按下
+
+// 运行所有就绪的任务，然后按到期顺序推进虚拟时间到 end_us
+void sim_run_until(int64_t end_us);
+void sim_run_for(int64_t us);
+// 按创建时的名称查找任务，找不到返回 NULL
+TaskHandle_t sim_find_task(const char *name);
+// 复制各任务的统计，返回任务数；reset 非 0 时清零计数
+int sim_get_stats(sim_task_stats_t *stats, int max, int reset);
+// 打印上次打印以来每个任务的唤醒次数/秒和每秒 CPU 时间
+void sim_report(const char *title);
+
+#endif // SIM_H
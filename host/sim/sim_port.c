@@ -0,0 +1,114 @@
+#include "driver/gpio.h"
+#include "esp_spi_flash.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "host_shim.h"
+#include "sim.h"
+#include "user_alarm.h"
+#include "user_lan.h"
+#include "user_mqtt.h"
+#include "user_net.h"
+#include "user_prof.h"
+#include "user_publish.h"
+#include "user_sync.h"
+#include "user_test.h"
+#include "user_time.h"
+
+// main 用到、但依赖 Wi-Fi/lwip/esp-mqtt 的部分：连接过程按 sim_net 的时延
+// 用 esp_timer 产生与固件相同的联网事件，其余只保留接口
+
+sim_net_t sim_net = {
+    .wifi_connect_ms = 2500,
+    .mqtt_connect_ms = 800,
+};
+int sim_gpio_level;
+
+static esp_timer_handle_t s_wifi_timer;
+static esp_timer_handle_t s_mqtt_timer;
+
+static void wifi_timer_cb(void *arg) {
+    if (sim_net.wifi_fail) {
+        net_post_event(NET_EVT_STA_DISCONNECTED);
+        return;
+    }
+    prof_mark(PROF_WIFI_CONNECTED);
+    prof_mark(PROF_GOT_IP);
+    net_post_event(NET_EVT_GOT_IP);
+}
+
+static void mqtt_timer_cb(void *arg) {
+    prof_mark(PROF_MQTT_CONNECTED);
+    publish_set_connected((esp_mqtt_client_handle_t)&host_mqtt);
+    net_post_event(NET_EVT_MQTT_CONNECTED);
+}
+
+static void sim_timer(esp_timer_handle_t *timer, esp_timer_cb_t cb,
+                      uint32_t delay_ms) {
+    if (*timer == NULL) {
+        const esp_timer_create_args_t args = {.callback = cb, .name = "sim"};
+        esp_timer_create(&args, timer);
+    }
+    esp_timer_stop(*timer);
+    esp_timer_start_once(*timer, delay_ms * 1000ULL);
+}
+
+size_t spi_flash_get_chip_size(void) {
+    return 4 * 1024 * 1024;
+}
+
+esp_err_t gpio_config(const gpio_config_t *conf) {
+    return ESP_OK;
+}
+
+int gpio_get_level(int gpio_num) {
+    return sim_gpio_level;
+}
+
+void user_wifi_init(void) {
+}
+
+void wifiSwitch(int mode) {
+    if (mode == WIFI_MODE_STA) {
+        prof_mark(PROF_WIFI_START);
+        sim_timer(&s_wifi_timer, wifi_timer_cb, sim_net.wifi_connect_ms);
+    }
+}
+
+void wifi_reconnect(void) {
+    sim_timer(&s_wifi_timer, wifi_timer_cb, sim_net.wifi_connect_ms);
+}
+
+void mqtt_app_start(void) {
+    prof_mark(PROF_MQTT_START);
+    sim_timer(&s_mqtt_timer, mqtt_timer_cb, sim_net.mqtt_connect_ms);
+}
+
+void publish_roomlight_update(const char *topic, const char *data) {
+    sim_net.key_events++;
+    publish_message(topic, data, PUB_CLASS_EVENT);
+}
+
+void time_start(void) {
+}
+
+void lan_start(void) {
+}
+
+void alarm_start(void) {
+}
+
+// 单灯：共享时钟即本地时钟，不会跳变
+void sync_start(void) {
+}
+
+uint32_t sync_now_ms(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+uint32_t sync_align_ms(uint32_t now_ms) {
+    return (now_ms / SYNC_ALIGN_MS + 1) * SYNC_ALIGN_MS;
+}
+
+int32_t sync_take_step_ms(void) {
+    return 0;
+}
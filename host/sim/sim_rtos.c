@@ -0,0 +1,429 @@
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "host_shim.h"
+#include "sim.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 单核 FreeRTOS 的最小模型：任务只在阻塞点切换，不模拟抢占。
+// 所有共享状态由 s_lock 保护；s_current 为持有 CPU 的任务，NULL 表示驱动线程
+
+typedef enum
+{
+    TASK_READY = 0,
+    TASK_RUNNING,
+    TASK_BLOCKED,
+    TASK_DELETED,
+} task_state_t;
+
+typedef enum
+{
+    WAIT_DELAY = 0,
+    WAIT_NOTIFY,
+    WAIT_QUEUE,
+} wait_kind_t;
+
+struct sim_task
+{
+    const char *name;
+    TaskFunction_t fn;
+    void *arg;
+    UBaseType_t prio;
+    pthread_t thread;
+    pthread_cond_t cond;
+    task_state_t state;
+    wait_kind_t wait_kind;
+    QueueHandle_t wait_queue;
+    int64_t wake_us; // 阻塞超时的时刻，-1 表示一直等待
+    int timed_out;
+    uint64_t ready_seq; // 同优先级按就绪先后运行
+    uint32_t notify;
+    int notified;
+    uint32_t wakeups;
+    int64_t cpu_ns;
+    int64_t cpu_start;
+};
+
+struct sim_queue
+{
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t *buf;
+};
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_driver_cond = PTHREAD_COND_INITIALIZER;
+static struct sim_task s_tasks[SIM_TASKS];
+static int s_task_count;
+static struct sim_task *s_current;
+static uint64_t s_ready_seq;
+static __thread struct sim_task *s_self;
+
+static int64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// 调用者持有 s_lock
+static void make_ready(struct sim_task *t, int timed_out) {
+    t->state = TASK_READY;
+    t->timed_out = timed_out;
+    t->ready_seq = ++s_ready_seq;
+}
+
+// 调用者持有 s_lock。交出 CPU 并等到被重新调度，返回 0 表示超时
+static int block(struct sim_task *self, wait_kind_t kind, TickType_t ticks) {
+    self->state = TASK_BLOCKED;
+    self->wait_kind = kind;
+    self->wake_us = -1;
+    if (ticks != portMAX_DELAY) {
+        // 与 FreeRTOS 相同，超时在节拍边界到期
+        self->wake_us = (int64_t)(xTaskGetTickCount() + ticks) *
+                        portTICK_PERIOD_MS * 1000;
+    }
+    self->cpu_ns += thread_cpu_ns() - self->cpu_start;
+    s_current = NULL;
+    pthread_cond_signal(&s_driver_cond);
+    while (s_current != self) {
+        pthread_cond_wait(&self->cond, &s_lock);
+    }
+    self->cpu_start = thread_cpu_ns();
+    self->wakeups++;
+    return !self->timed_out;
+}
+
+static void *task_main(void *arg) {
+    struct sim_task *self = arg;
+
+    s_self = self;
+    pthread_mutex_lock(&s_lock);
+    while (s_current != self) {
+        pthread_cond_wait(&self->cond, &s_lock);
+    }
+    self->cpu_start = thread_cpu_ns();
+    pthread_mutex_unlock(&s_lock);
+
+    self->fn(self->arg);
+    vTaskDelete(NULL);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack,
+                       void *arg, UBaseType_t prio, TaskHandle_t *handle) {
+    pthread_mutex_lock(&s_lock);
+    if (s_task_count == SIM_TASKS) {
+        pthread_mutex_unlock(&s_lock);
+        return pdFAIL;
+    }
+    struct sim_task *t = &s_tasks[s_task_count++];
+    t->name = name;
+    t->fn = fn;
+    t->arg = arg;
+    t->prio = prio;
+    pthread_cond_init(&t->cond, NULL);
+    make_ready(t, 0);
+    pthread_mutex_unlock(&s_lock);
+
+    pthread_create(&t->thread, NULL, task_main, t);
+    if (handle != NULL) {
+        *handle = t;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    pthread_mutex_lock(&s_lock);
+    if (task == NULL || task == s_self) {
+        struct sim_task *self = s_self;
+        self->state = TASK_DELETED;
+        self->cpu_ns += thread_cpu_ns() - self->cpu_start;
+        s_current = NULL;
+        pthread_cond_signal(&s_driver_cond);
+        pthread_mutex_unlock(&s_lock);
+        pthread_exit(NULL);
+    }
+    // 其他任务停在阻塞点，不再调度即可
+    task->state = TASK_DELETED;
+    pthread_mutex_unlock(&s_lock);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return s_self;
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(host_time_us / 1000 / portTICK_PERIOD_MS);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (s_self == NULL) {
+        sim_run_for((int64_t)ticks * portTICK_PERIOD_MS * 1000);
+        return;
+    }
+    pthread_mutex_lock(&s_lock);
+    block(s_self, WAIT_DELAY, ticks);
+    pthread_mutex_unlock(&s_lock);
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    pthread_mutex_lock(&s_lock);
+    switch (action) {
+    case eSetBits:
+        task->notify |= value;
+        break;
+    case eIncrement:
+        task->notify++;
+        break;
+    case eSetValueWithOverwrite:
+        task->notify = value;
+        break;
+    default:
+        break;
+    }
+    task->notified = 1;
+    if (task->state == TASK_BLOCKED && task->wait_kind == WAIT_NOTIFY) {
+        make_ready(task, 0);
+    }
+    pthread_mutex_unlock(&s_lock);
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    return xTaskNotify(task, 0, eIncrement);
+}
+
+BaseType_t xTaskNotifyWait(unsigned long clear_on_entry,
+                           unsigned long clear_on_exit, uint32_t *value,
+                           TickType_t ticks) {
+    struct sim_task *self = s_self;
+    BaseType_t ret = pdFALSE;
+
+    pthread_mutex_lock(&s_lock);
+    if (!self->notified) {
+        self->notify &= ~clear_on_entry;
+        if (ticks != 0) {
+            block(self, WAIT_NOTIFY, ticks);
+        }
+    }
+    if (value != NULL) {
+        *value = self->notify;
+    }
+    if (self->notified) {
+        self->notify &= ~clear_on_exit;
+        self->notified = 0;
+        ret = pdTRUE;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ret;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    struct sim_task *self = s_self;
+
+    pthread_mutex_lock(&s_lock);
+    if (self->notify == 0 && ticks != 0) {
+        block(self, WAIT_NOTIFY, ticks);
+    }
+    uint32_t value = self->notify;
+    if (value != 0) {
+        self->notify = clear ? 0 : value - 1;
+    }
+    self->notified = 0;
+    pthread_mutex_unlock(&s_lock);
+    return value;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct sim_queue *q = calloc(1, sizeof(*q));
+    q->length = length;
+    q->item_size = item_size;
+    q->buf = calloc(length, item_size);
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) {
+    pthread_mutex_lock(&s_lock);
+    if (q->count == q->length) {
+        pthread_mutex_unlock(&s_lock);
+        return pdFALSE;
+    }
+    UBaseType_t tail = (q->head + q->count) % q->length;
+    memcpy(q->buf + tail * q->item_size, item, q->item_size);
+    q->count++;
+    for (int i = 0; i < s_task_count; i++) {
+        struct sim_task *t = &s_tasks[i];
+        if (t->state == TASK_BLOCKED && t->wait_kind == WAIT_QUEUE &&
+            t->wait_queue == q) {
+            make_ready(t, 0);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) {
+    struct sim_task *self = s_self;
+
+    pthread_mutex_lock(&s_lock);
+    while (q->count == 0) {
+        if (ticks == 0 || self == NULL) {
+            pthread_mutex_unlock(&s_lock);
+            return pdFALSE;
+        }
+        self->wait_queue = q;
+        if (!block(self, WAIT_QUEUE, ticks)) {
+            pthread_mutex_unlock(&s_lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(item, q->buf + q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    pthread_mutex_unlock(&s_lock);
+    return pdTRUE;
+}
+
+// 任务只在阻塞点切换，持有互斥量期间不会有其他任务运行
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    static int mutex;
+    return &mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return pdTRUE;
+}
+
+// 调用者持有 s_lock。优先级最高、就绪最早的任务
+static struct sim_task *pick_ready(void) {
+    struct sim_task *best = NULL;
+    for (int i = 0; i < s_task_count; i++) {
+        struct sim_task *t = &s_tasks[i];
+        if (t->state == TASK_READY &&
+            (best == NULL || t->prio > best->prio ||
+             (t->prio == best->prio && t->ready_seq < best->ready_seq))) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+static void run_ready(void) {
+    struct sim_task *t;
+
+    pthread_mutex_lock(&s_lock);
+    while ((t = pick_ready()) != NULL) {
+        t->state = TASK_RUNNING;
+        s_current = t;
+        pthread_cond_signal(&t->cond);
+        while (s_current != NULL) {
+            pthread_cond_wait(&s_driver_cond, &s_lock);
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+static int64_t next_deadline(void) {
+    int64_t next = host_next_timer_us();
+
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < s_task_count; i++) {
+        struct sim_task *t = &s_tasks[i];
+        if (t->state == TASK_BLOCKED && t->wake_us >= 0 && t->wake_us < next) {
+            next = t->wake_us;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return next;
+}
+
+static void wake_due(void) {
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < s_task_count; i++) {
+        struct sim_task *t = &s_tasks[i];
+        if (t->state == TASK_BLOCKED && t->wake_us >= 0 &&
+            t->wake_us <= host_time_us) {
+            make_ready(t, 1);
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+void sim_run_until(int64_t end_us) {
+    while (1) {
+        run_ready();
+        int64_t next = next_deadline();
+        if (next > end_us) {
+            break;
+        }
+        // 定时器回调在驱动线程中执行，可能通知任务
+        host_advance_us(next > host_time_us ? next - host_time_us : 0);
+        wake_due();
+    }
+    if (end_us > host_time_us) {
+        host_advance_us(end_us - host_time_us);
+    }
+}
+
+void sim_run_for(int64_t us) {
+    sim_run_until(host_time_us + us);
+}
+
+TaskHandle_t sim_find_task(const char *name) {
+    struct sim_task *found = NULL;
+
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < s_task_count && found == NULL; i++) {
+        if (s_tasks[i].state != TASK_DELETED &&
+            strcmp(s_tasks[i].name, name) == 0) {
+            found = &s_tasks[i];
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return found;
+}
+
+int sim_get_stats(sim_task_stats_t *stats, int max, int reset) {
+    int n;
+
+    pthread_mutex_lock(&s_lock);
+    for (n = 0; n < s_task_count && n < max; n++) {
+        stats[n].name = s_tasks[n].name;
+        stats[n].wakeups = s_tasks[n].wakeups;
+        stats[n].cpu_ns = s_tasks[n].cpu_ns;
+        if (reset) {
+            s_tasks[n].wakeups = 0;
+            s_tasks[n].cpu_ns = 0;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return n;
+}
+
+void sim_report(const char *title) {
+    static int64_t s_last_us;
+    sim_task_stats_t stats[SIM_TASKS];
+    int n = sim_get_stats(stats, SIM_TASKS, 1);
+    double seconds = (host_time_us - s_last_us) / 1e6;
+
+    s_last_us = host_time_us;
+    if (seconds <= 0) {
+        return;
+    }
+    printf("%s (%.0f s simulated)\n", title, seconds);
+    for (int i = 0; i < n; i++) {
+        printf("  %-20s %8.2f wakeups/s %10.1f us cpu/s\n", stats[i].name,
+               stats[i].wakeups / seconds, stats[i].cpu_ns / 1e3 / seconds);
+    }
+}
@@ -0,0 +1,85 @@
+#include "host_shim.h"
+#include "sim.h"
+#include "test_host.h"
+#include "user_cmd.h"
+#include "user_nvs.h"
+#include <stdio.h>
+#include <string.h>
+
+// 在模拟器上运行 app_main：启动、联网、执行命令、空闲，
+// 检查灯光输出并打印各任务的唤醒次数和 CPU 时间
+
+#define NVS_FILE "sim_boot.bin"
+#define SEC 1000000LL
+
+void app_main(void);
+
+// 写入配网信息，之后 app_main 从文件中读出
+static void provision(void) {
+    const char *packet = "ssid:home,pass:secret,user:u1,room:r1,"
+                         "lightNormal:#ff8000";
+    remove(NVS_FILE);
+    host_nvs_reset(NVS_FILE);
+    init_nvs();
+    nvs_read_data_from_flash();
+    parse_data_packet(packet, strlen(packet), &nvs_data);
+    nvs_flush();
+    host_nvs_reset(NVS_FILE);
+}
+
+static void test_boot(void) {
+    app_main();
+    sim_run_for(SEC);
+    CHECK_INT(dev_state, DEV_STA_CONNECTING);
+    sim_run_for(4 * SEC);
+    CHECK_INT(dev_state, DEV_MQTT_CONNECTED);
+    // #ff8000：红最亮，蓝为 0。硬件通道顺序为 R、B、G
+    CHECK(host_pwm.duty[0] > host_pwm.duty[2]);
+    CHECK(host_pwm.duty[2] > 0);
+    CHECK_INT(host_pwm.duty[1], 0);
+    sim_report("boot");
+}
+
+// 静态颜色时灯光任务不应被唤醒
+static void test_idle(void) {
+    sim_task_stats_t stats[SIM_TASKS];
+    uint32_t starts = host_pwm.starts;
+
+    sim_get_stats(stats, SIM_TASKS, 1);
+    sim_run_for(60 * SEC);
+    int n = sim_get_stats(stats, SIM_TASKS, 0);
+    for (int i = 0; i < n; i++) {
+        if (strcmp(stats[i].name, "PWM Update Task") == 0) {
+            CHECK_INT(stats[i].wakeups, 0);
+        }
+    }
+    CHECK_INT(host_pwm.starts, starts);
+    sim_report("idle");
+}
+
+static void test_command(void) {
+    const char *cmd = "lightNormal:#0000ff";
+    CHECK_INT(cmd_queue_post(CMD_SRC_LOCAL, cmd, strlen(cmd)), ESP_OK);
+    sim_run_for(1000);
+    CHECK_INT(host_pwm.duty[0], 0);
+    CHECK(host_pwm.duty[1] > 0);
+}
+
+static void test_key(void) {
+    sim_gpio_level = 1;
+    sim_run_for(SEC);
+    sim_gpio_level = 0;
+    sim_run_for(SEC);
+    CHECK_INT(sim_net.key_events, 1);
+    sim_report("key press");
+}
+
+int main(void) {
+    provision();
+    RUN_TEST(test_boot);
+    RUN_TEST(test_idle);
+    RUN_TEST(test_command);
+    RUN_TEST(test_key);
+    remove(NVS_FILE);
+    return TEST_RESULT();
+}
@@ -0,0 +1,191 @@
+#include "host_shim.h"
+#include "sdkconfig.h"
+#include "test_host.h"
+#include "user_cmd.h"
+#include "user_nvs.h"
+#include <stdio.h>
+#include <string.h>
+
+#define NVS_FILE "test_cmd.bin"
+
+static esp_err_t post(const char *s) {
+    return cmd_queue_post(CMD_SRC_LOCAL, s, strlen(s));
+}
+
+// 后到的控制命令不能被先到的颜色命令覆盖
+static void test_seq_order(void) {
+    CHECK_INT(post("{\"lightNormal\":\"#111111\"}"), ESP_OK);
+    CHECK_INT(post("{\"room\":\"r1\",\"lightNormal\":\"#222222\"}"), ESP_OK);
+    cmd_queue_dispatch();
+    CHECK(strcmp(nvs_data.lightNormal, "#222222") == 0);
+    CHECK(strcmp(nvs_data.roomID, "r1") == 0);
+}
+
+static void test_supersede(void) {
+    cmd_stats_t before, after;
+    cmd_queue_get_stats(&before);
+    post("{\"lightSwitch1\":\"#000001\"}");
+    post("{\"lightSwitch1\":\"#000002\"}");
+    post("{\"lightSwitch1\":\"#000003\"}");
+    cmd_queue_dispatch();
+    cmd_queue_get_stats(&after);
+    CHECK_INT(after.posted, before.posted + 3);
+    CHECK_INT(after.superseded, before.superseded + 2);
+    CHECK_INT(after.dispatched, before.dispatched + 1);
+    CHECK(strcmp(nvs_data.lightSwitch1, "#000003") == 0);
+}
+
+// 分片可以乱序到达，收齐后才提交
+static void test_fragments_out_of_order(void) {
+    const char *msg = "{\"lightSwitch2\":\"#abcdef\"}";
+    int len = strlen(msg), half = len / 2;
+    int handle = cmd_queue_begin(CMD_SRC_MQTT, len, msg, half);
+    CHECK(handle >= 0);
+    CHECK_INT(cmd_queue_append(handle, half, msg + half, len - half), ESP_OK);
+    CHECK_INT(cmd_queue_append(handle, 0, msg, half), ESP_OK);
+    CHECK_INT(cmd_queue_commit(handle), ESP_OK);
+    cmd_queue_dispatch();
+    CHECK(strcmp(nvs_data.lightSwitch2, "#abcdef") == 0);
+}
+
+static void test_overlong(void) {
+    cmd_stats_t before, after;
+    cmd_queue_get_stats(&before);
+    CHECK_INT(cmd_queue_begin(CMD_SRC_MQTT, CONFIG_ROOMLIGHT_CMD_MAX_SIZE + 1,
+                              NULL, 0),
+              -1);
+    CHECK_INT(cmd_queue_begin(CMD_SRC_MQTT, 0, NULL, 0), -1);
+
+    // 越过声明总长度的分片被拒绝
+    int handle = cmd_queue_begin(CMD_SRC_MQTT, 8, NULL, 0);
+    CHECK(handle >= 0);
+    CHECK_INT(cmd_queue_append(handle, 4, "12345", 5), ESP_ERR_INVALID_SIZE);
+    CHECK_INT(cmd_queue_append(handle, -1, "1", 1), ESP_ERR_INVALID_SIZE);
+    cmd_queue_abort(handle);
+
+    cmd_queue_get_stats(&after);
+    CHECK_INT(after.invalid, before.invalid + 2);
+}
+
+static void test_abort(void) {
+    cmd_stats_t before, after;
+    cmd_queue_get_stats(&before);
+    int handle = cmd_queue_begin(CMD_SRC_MQTT, 16, NULL, 0);
+    CHECK(handle >= 0);
+    CHECK_INT(cmd_queue_append(handle, 0, "{\"room\"", 7), ESP_OK);
+    cmd_queue_abort(handle);
+    CHECK_INT(cmd_queue_append(handle, 7, ":\"x\"}", 5), ESP_ERR_INVALID_SIZE);
+    CHECK_INT(cmd_queue_commit(handle), ESP_ERR_INVALID_STATE);
+    // 重复放弃不重复计数
+    cmd_queue_abort(handle);
+    cmd_queue_get_stats(&after);
+    CHECK_INT(after.incomplete, before.incomplete + 1);
+
+    // 放弃的槽位可以全部重新申请
+    int handles[CMD_SLOT_NUM];
+    for (int i = 0; i < CMD_SLOT_NUM; i++) {
+        handles[i] = cmd_queue_begin(CMD_SRC_MQTT, 16, NULL, 0);
+        CHECK(handles[i] >= 0);
+    }
+    for (int i = 0; i < CMD_SLOT_NUM; i++) {
+        cmd_queue_abort(handles[i]);
+    }
+}
+
+// 队列满时颜色命令被丢弃，控制命令挤掉最旧的颜色命令
+static void test_evict_when_full(void) {
+    static const char *const colors[CMD_SLOT_NUM] = {
+        "{\"lightNormal\":\"#000010\"}",  "{\"lightPeriod\":\"7\"}",
+        "{\"lightSwitch1\":\"#000011\"}", "{\"lightSwitch2\":\"#000012\"}",
+        "{\"lightSwitch3\":\"#000013\"}", "{\"hsv\":\"0/0/1000\"}",
+    };
+    cmd_stats_t before, after;
+    char normal[NVS_STORAGE_MAX];
+
+    strcpy(normal, nvs_data.lightNormal);
+    cmd_queue_get_stats(&before);
+    for (int i = 0; i < CMD_SLOT_NUM; i++) {
+        CHECK_INT(post(colors[i]), ESP_OK);
+    }
+    CHECK_INT(post("{\"lightSwitch3\":\"#000014\"}"), ESP_ERR_NO_MEM);
+    CHECK_INT(post("{\"room\":\"full\"}"), ESP_OK);
+    cmd_queue_get_stats(&after);
+    CHECK_INT(after.dropped, before.dropped + 1);
+    CHECK_INT(after.evicted, before.evicted + 1);
+
+    cmd_queue_dispatch();
+    cmd_queue_get_stats(&after);
+    CHECK_INT(after.dispatched, before.dispatched + CMD_SLOT_NUM);
+    CHECK(strcmp(nvs_data.roomID, "full") == 0);
+    CHECK(strcmp(nvs_data.lightSwitch3, "#000013") == 0);
+    // 被挤掉的是最早的 lightNormal，随后的 hsv 仍然生效
+    CHECK(strcmp(nvs_data.lightNormal, "#000010") != 0);
+    CHECK(strcmp(nvs_data.lightNormal, normal) != 0);
+}
+
+// 分片的控制命令按第一片中的键分类，队列满时同样能挤掉颜色命令
+static void test_evict_fragmented(void) {
+    static const char *const colors[CMD_SLOT_NUM] = {
+        "{\"lightNormal\":\"#000020\"}",  "{\"lightPeriod\":\"8\"}",
+        "{\"lightSwitch1\":\"#000021\"}", "{\"lightSwitch2\":\"#000022\"}",
+        "{\"lightSwitch3\":\"#000023\"}", "{\"hsv\":\"0/0/900\"}",
+    };
+    const char *msg = "{\"room\":\"frag\",\"lightNormal\":\"#000024\"}";
+    int len = strlen(msg), half = len / 2;
+    cmd_stats_t before, after;
+
+    cmd_queue_get_stats(&before);
+    for (int i = 0; i < CMD_SLOT_NUM; i++) {
+        CHECK_INT(post(colors[i]), ESP_OK);
+    }
+    int handle = cmd_queue_begin(CMD_SRC_MQTT, len, msg, half);
+    CHECK(handle >= 0);
+    CHECK_INT(cmd_queue_append(handle, 0, msg, half), ESP_OK);
+    CHECK_INT(cmd_queue_append(handle, half, msg + half, len - half), ESP_OK);
+    CHECK_INT(cmd_queue_commit(handle), ESP_OK);
+    cmd_queue_get_stats(&after);
+    CHECK_INT(after.evicted, before.evicted + 1);
+
+    cmd_queue_dispatch();
+    CHECK(strcmp(nvs_data.roomID, "frag") == 0);
+}
+
+// 大消息借用的缓冲区用完时，即使还有空槽位也丢弃
+static void test_large_buffers(void) {
+    int large = CMD_SLOT_SIZE + 1;
+    int handles[CMD_LARGE_NUM];
+    for (int i = 0; i < CMD_LARGE_NUM; i++) {
+        handles[i] = cmd_queue_begin(CMD_SRC_MQTT, large, NULL, 0);
+        CHECK(handles[i] >= 0);
+    }
+    CHECK_INT(cmd_queue_begin(CMD_SRC_MQTT, large, NULL, 0), -1);
+    int small = cmd_queue_begin(CMD_SRC_MQTT, CMD_SLOT_SIZE, NULL, 0);
+    CHECK(small >= 0);
+    cmd_queue_abort(small);
+
+    cmd_queue_abort(handles[0]);
+    handles[0] = cmd_queue_begin(CMD_SRC_MQTT, large, NULL, 0);
+    CHECK(handles[0] >= 0);
+    for (int i = 0; i < CMD_LARGE_NUM; i++) {
+        cmd_queue_abort(handles[i]);
+    }
+}
+
+int main(void) {
+    remove(NVS_FILE);
+    host_nvs_reset(NVS_FILE);
+    init_nvs();
+    nvs_read_data_from_flash();
+    cmd_queue_init();
+
+    RUN_TEST(test_seq_order);
+    RUN_TEST(test_supersede);
+    RUN_TEST(test_fragments_out_of_order);
+    RUN_TEST(test_overlong);
+    RUN_TEST(test_abort);
+    RUN_TEST(test_evict_when_full);
+    RUN_TEST(test_evict_fragmented);
+    RUN_TEST(test_large_buffers);
+    remove(NVS_FILE);
+    return TEST_RESULT();
+}
@@ -0,0 +1,64 @@
+#include "test_host.h"
+#include "user_pwm.h"
+#include <stdlib.h>
+
+static void test_hsv(void) {
+    uint16_t r, g, b;
+    pwm_hsv_to_rgb48(0, 1000, 1000, &r, &g, &b);
+    CHECK_INT(r, 0xffff);
+    CHECK_INT(g, 0);
+    CHECK_INT(b, 0);
+    pwm_hsv_to_rgb48(120, 1000, 1000, &r, &g, &b);
+    CHECK_INT(r, 0);
+    CHECK_INT(g, 0xffff);
+    pwm_hsv_to_rgb48(240, 1000, 500, &r, &g, &b);
+    CHECK_INT(b, 0xffff / 2);
+    pwm_hsv_to_rgb48(200, 0, 1000, &r, &g, &b);
+    CHECK(r == 0xffff && g == 0xffff && b == 0xffff);
+    pwm_hsv_to_rgb48(60, 1000, 1000, &r, &g, &b);
+    CHECK(r == 0xffff && g == 0xffff && b == 0);
+}
+
+// 饱和度按 1/1000 量化，每度最多跳一个量化步长
+#define STEP_MAX (0xffff * 17 / 1000 + 1)
+
+// 色相连续变化时各通道不跳变
+static void test_hsv_continuous(void) {
+    uint16_t r0, g0, b0, r, g, b;
+    pwm_hsv_to_rgb48(0, 1000, 1000, &r0, &g0, &b0);
+    for (uint16_t hue = 1; hue <= 360; hue++) {
+        pwm_hsv_to_rgb48(hue, 1000, 1000, &r, &g, &b);
+        CHECK(abs((int)r - r0) <= STEP_MAX);
+        CHECK(abs((int)g - g0) <= STEP_MAX);
+        CHECK(abs((int)b - b0) <= STEP_MAX);
+        r0 = r, g0 = g, b0 = b;
+    }
+}
+
+static void test_cct(void) {
+    uint16_t r, g, b;
+    pwm_cct_to_rgb48(6500, 1000, &r, &g, &b);
+    CHECK_INT(r, 255 * 257);
+    CHECK_INT(g, 254 * 257);
+    CHECK_INT(b, 250 * 257);
+    // 暖光蓝色为 0，超出范围取端点
+    pwm_cct_to_rgb48(500, 1000, &r, &g, &b);
+    CHECK_INT(g, 68 * 257);
+    CHECK_INT(b, 0);
+    pwm_cct_to_rgb48(2250, 500, &r, &g, &b);
+    CHECK(g > 147 * 128 && g < 149 * 128);
+    // 最低亮度也要有输出
+    pwm_cct_to_rgb48(6500, 1, &r, &g, &b);
+    CHECK(r > 0 && r < 128);
+    pwm_cct_to_rgb48(4000, 0, &r, &g, &b);
+    CHECK(r == 0 && g == 0 && b == 0);
+    pwm_cct_to_rgb48(20000, 1000, &r, &g, &b);
+    CHECK_INT(r, 202 * 257);
+}
+
+int main(void) {
+    RUN_TEST(test_hsv);
+    RUN_TEST(test_hsv_continuous);
+    RUN_TEST(test_cct);
+    return TEST_RESULT();
+}
@@ -0,0 +1,164 @@
+#include "test_host.h"
+#include "user_effect.h"
+#include <string.h>
+
+static const effect_rgb_t BLACK = {0, 0, 0};
+static const effect_rgb_t WHITE = {0xffff, 0xffff, 0xffff};
+
+static int parse(const char *s, effect_timeline_t *tl) {
+    return effect_parse(s, strlen(s), tl);
+}
+
+static void test_parse(void) {
+    effect_timeline_t tl;
+    CHECK_INT(parse("*500/ff0000/3;250/00ff00", &tl), 2);
+    CHECK_INT(tl.loop, 1);
+    CHECK_INT(tl.frames[0].duration_ms, 500);
+    CHECK_INT(tl.frames[0].ease, EASE_IN_OUT);
+    CHECK_INT(tl.frames[0].color.r, 0xffff);
+    CHECK_INT(tl.frames[0].color.g, 0);
+    CHECK_INT(tl.frames[1].ease, EASE_LINEAR);
+    CHECK_INT(tl.frames[1].color.g, 0xffff);
+
+    CHECK_INT(parse("100/123456789abc", &tl), 1);
+    CHECK_INT(tl.frames[0].color.r, 0x1234);
+    CHECK_INT(tl.frames[0].color.b, 0x9abc);
+}
+
+static void test_parse_rejects(void) {
+    effect_timeline_t tl;
+    CHECK_INT(parse("", &tl), -1);
+    CHECK_INT(parse("500", &tl), -1);
+    CHECK_INT(parse("500/ff00", &tl), -1);
+    CHECK_INT(parse("500/gg0000", &tl), -1);
+    CHECK_INT(parse("70000/ff0000", &tl), -1);
+    // 2^32 + 1 回绕后是 1，不能当作合法时长
+    CHECK_INT(parse("4294967297/ff0000", &tl), -1);
+    CHECK_INT(parse("500/ff0000/4294967297", &tl), -1);
+    CHECK_INT(parse("500/ff0000/9", &tl), -1);
+    CHECK_INT(parse("500/ff0000/1/2", &tl), -1);
+    CHECK_INT(parse("1/000000;1/000000;1/000000;1/000000;1/000000;1/000000;"
+                    "1/000000;1/000000;1/000000;1/000000;1/000000;1/000000;"
+                    "1/000000;1/000000;1/000000;1/000000;1/000000",
+                    &tl),
+              -1);
+}
+
+static void test_crossfade(void) {
+    effect_engine_t e;
+    effect_rgb_t out;
+    effect_init(&e, BLACK);
+    CHECK_INT(effect_crossfade(&e, WHITE, 1000, EASE_LINEAR, 100), 0);
+
+    CHECK_INT(effect_render(&e, 100, &out), EFFECT_FRAME_MS);
+    CHECK_INT(out.r, 0);
+    effect_render(&e, 600, &out);
+    CHECK(out.r > 0x7f00 && out.r < 0x8100);
+    // 最后一帧之前只等到段末
+    CHECK_INT(effect_render(&e, 1090, &out), 10);
+    CHECK_INT(effect_render(&e, 1100, &out), 0);
+    CHECK_INT(out.r, 0xffff);
+    CHECK_INT(e.state, EFFECT_HOLD);
+}
+
+static void test_future_start(void) {
+    effect_engine_t e;
+    effect_rgb_t out;
+    effect_init(&e, BLACK);
+    effect_crossfade(&e, WHITE, 1000, EASE_LINEAR, 5000);
+    // 对齐到未来的网格时刻之前保持原色
+    CHECK_INT(effect_render(&e, 4750, &out), 250);
+    CHECK_INT(out.r, 0);
+}
+
+static void test_loop(void) {
+    effect_timeline_t tl;
+    effect_engine_t e;
+    effect_rgb_t out;
+    parse("*1000/ffffff/5;1000/000000/5", &tl);
+    effect_init(&e, BLACK);
+    CHECK_INT(effect_start(&e, &tl, 0), 0);
+
+    effect_render(&e, 1000, &out);
+    CHECK_INT(out.r, 0xffff);
+    // 跳过多个周期后相位不变
+    effect_render(&e, 10 * 2000 + 1000, &out);
+    CHECK_INT(out.r, 0xffff);
+    effect_render(&e, 10 * 2000 + 2000, &out);
+    CHECK_INT(out.r, 0);
+    CHECK_INT(e.state, EFFECT_RUNNING);
+
+    // 循环效果总时长不能为 0
+    parse("*0/ffffff", &tl);
+    CHECK_INT(effect_start(&e, &tl, 0), -1);
+}
+
+// 长时间没有渲染的循环效果，恢复时按整圈跳过
+static void test_loop_resume(void) {
+    effect_timeline_t tl;
+    effect_engine_t e, ref;
+    effect_rgb_t out, expected;
+    parse("*1/ff0000;1/000000;3/00ff00/1", &tl);
+    effect_init(&e, BLACK);
+    effect_start(&e, &tl, 0);
+    effect_render(&e, 3, &out);
+
+    // 约 21 天，逐帧追赶需要数亿次循环
+    uint32_t now = 0x70000000u + 3;
+    effect_render(&e, now, &out);
+    effect_init(&ref, BLACK);
+    effect_start(&ref, &tl, 0);
+    effect_render(&ref, 5, &out);
+    effect_render(&ref, 5 + now % 5, &expected);
+    CHECK_INT(out.r, expected.r);
+    CHECK_INT(out.g, expected.g);
+    CHECK_INT(e.index, ref.index);
+    CHECK(now - e.start_ms < e.loop_ms);
+
+    // 毫秒计数回绕后仍按整圈跳过
+    now += 0x70000000u + 0x70000000u;
+    effect_render(&e, now - 0x70000000u, &out);
+    effect_render(&e, now, &out);
+    CHECK(now - e.start_ms < e.loop_ms);
+    CHECK_INT(e.state, EFFECT_RUNNING);
+}
+
+static void test_hold_segment(void) {
+    effect_timeline_t tl;
+    effect_engine_t e;
+    effect_rgb_t out;
+    parse("0/ff0000;2000/ff0000;100/0000ff/5", &tl);
+    effect_init(&e, BLACK);
+    effect_start(&e, &tl, 0);
+    // 颜色不变的段直接等到段末，不逐帧刷新
+    CHECK_INT(effect_render(&e, 500, &out), 1500);
+    CHECK_INT(out.r, 0xffff);
+    // 阶跃：段内保持起始颜色
+    CHECK_INT(effect_render(&e, 2050, &out), 50);
+    CHECK_INT(out.r, 0xffff);
+    CHECK_INT(out.b, 0);
+    effect_render(&e, 2100, &out);
+    CHECK_INT(out.b, 0xffff);
+}
+
+static void test_rgb565(void) {
+    effect_rgb_t c = effect_rgb_from565(0xffff);
+    CHECK_INT(c.r, 0xffff);
+    CHECK_INT(c.g, 0xffff);
+    CHECK_INT(c.b, 0xffff);
+    c = effect_rgb_from565(0x07e0);
+    CHECK_INT(c.r, 0);
+    CHECK_INT(c.g, 0xffff);
+}
+
+int main(void) {
+    RUN_TEST(test_parse);
+    RUN_TEST(test_parse_rejects);
+    RUN_TEST(test_crossfade);
+    RUN_TEST(test_future_start);
+    RUN_TEST(test_loop);
+    RUN_TEST(test_loop_resume);
+    RUN_TEST(test_hold_segment);
+    RUN_TEST(test_rgb565);
+    return TEST_RESULT();
+}
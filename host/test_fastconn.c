@@ -0,0 +1,115 @@
+#include "test_host.h"
+#include "user_fastconn.h"
+#include <string.h>
+
+static const uint8_t BSSID_A[6] = {0x30, 0xae, 0xa4, 0x80, 0x45, 0x69};
+static const uint8_t BSSID_B[6] = {0x70, 0xef, 0x00, 0x43, 0x96, 0x67};
+static const uint32_t DNS[FASTCONN_DNS_NUM] = {0x0101a8c0, 0x08080808};
+
+// 用一次完整的连接生成缓存
+static fastconn_cache_t connected_cache(const char *ssid, const char *pass) {
+    fastconn_t fc;
+    fastconn_init(&fc, NULL, ssid, pass, 1);
+    fastconn_on_connected(&fc, BSSID_A, 6);
+    fastconn_on_got_ip(&fc, 0x0a01a8c0, 0x00ffffff, 0x0101a8c0, DNS);
+    return fc.cache;
+}
+
+static void test_no_cache_scans(void) {
+    fastconn_t fc;
+    fastconn_plan_t plan;
+    fastconn_init(&fc, NULL, "home", "secret", 1);
+    fastconn_plan(&fc, &plan);
+    CHECK_INT(plan.mode, FASTCONN_SCAN);
+    CHECK_INT(plan.static_ip, 0);
+    CHECK_INT(fastconn_on_fail(&fc), 0);
+}
+
+static void test_cached_plan(void) {
+    fastconn_cache_t cache = connected_cache("home", "secret");
+    fastconn_t fc;
+    fastconn_plan_t plan;
+
+    fastconn_init(&fc, &cache, "home", "secret", 1);
+    fastconn_plan(&fc, &plan);
+    CHECK_INT(plan.mode, FASTCONN_CACHED);
+    CHECK_INT(plan.channel, 6);
+    CHECK(memcmp(plan.bssid, BSSID_A, 6) == 0);
+    CHECK_INT(plan.static_ip, 1);
+    CHECK_INT(plan.ip, 0x0a01a8c0);
+    CHECK_INT(plan.gw, 0x0101a8c0);
+    CHECK_INT(plan.dns[0], DNS[0]);
+    CHECK_INT(plan.dns[1], DNS[1]);
+
+    // 租约没有下发 DNS 时用网关
+    cache.dns[0] = cache.dns[1] = 0;
+    fastconn_init(&fc, &cache, "home", "secret", 1);
+    fastconn_plan(&fc, &plan);
+    CHECK_INT(plan.dns[0], cache.gw);
+    CHECK_INT(plan.dns[1], 0);
+
+    // 未开启复用租约时仍走 DHCP
+    fastconn_init(&fc, &cache, "home", "secret", 0);
+    fastconn_plan(&fc, &plan);
+    CHECK_INT(plan.mode, FASTCONN_CACHED);
+    CHECK_INT(plan.static_ip, 0);
+}
+
+static void test_credentials_change(void) {
+    fastconn_cache_t cache = connected_cache("home", "secret");
+    fastconn_t fc;
+    fastconn_init(&fc, &cache, "home", "changed", 1);
+    CHECK_INT(fc.mode, FASTCONN_SCAN);
+    // 拼接相同的不同凭据
+    cache = connected_cache("ab", "c");
+    fastconn_init(&fc, &cache, "a", "bc", 1);
+    CHECK_INT(fc.mode, FASTCONN_SCAN);
+
+    cache = connected_cache("home", "secret");
+    cache.version = FASTCONN_VERSION + 1;
+    fastconn_init(&fc, &cache, "home", "secret", 1);
+    CHECK_INT(fc.mode, FASTCONN_SCAN);
+}
+
+static void test_fail_fallback(void) {
+    fastconn_cache_t cache = connected_cache("home", "secret");
+    fastconn_t fc;
+    fastconn_plan_t plan;
+    fastconn_init(&fc, &cache, "home", "secret", 1);
+
+    // 第一次失败：放弃复用租约，仍指定 BSSID
+    CHECK_INT(fastconn_on_fail(&fc), 1);
+    fastconn_plan(&fc, &plan);
+    CHECK_INT(plan.mode, FASTCONN_CACHED);
+    CHECK_INT(plan.static_ip, 0);
+    // 再失败：回退到扫描
+    CHECK_INT(fastconn_on_fail(&fc), 1);
+    fastconn_plan(&fc, &plan);
+    CHECK_INT(plan.mode, FASTCONN_SCAN);
+}
+
+static void test_save_on_change(void) {
+    fastconn_cache_t cache = connected_cache("home", "secret");
+    fastconn_t fc;
+    fastconn_init(&fc, &cache, "home", "secret", 1);
+
+    CHECK_INT(fastconn_on_connected(&fc, BSSID_A, 6), 0);
+    CHECK_INT(fastconn_on_got_ip(&fc, cache.ip, cache.netmask, cache.gw, DNS), 0);
+    // 续租时 DNS 变化也要保存
+    const uint32_t dns2[FASTCONN_DNS_NUM] = {0x01010101, 0};
+    CHECK_INT(fastconn_on_got_ip(&fc, cache.ip, cache.netmask, cache.gw, dns2), 1);
+    // 换了 AP，旧租约作废
+    CHECK_INT(fastconn_on_connected(&fc, BSSID_B, 11), 1);
+    CHECK_INT(fc.cache.ip, 0);
+    CHECK_INT(fc.cache.channel, 11);
+    CHECK_INT(fastconn_on_got_ip(&fc, 0x0b01a8c0, 0x00ffffff, 0x0101a8c0, DNS), 1);
+}
+
+int main(void) {
+    RUN_TEST(test_no_cache_scans);
+    RUN_TEST(test_cached_plan);
+    RUN_TEST(test_credentials_change);
+    RUN_TEST(test_fail_fallback);
+    RUN_TEST(test_save_on_change);
+    return TEST_RESULT();
+}
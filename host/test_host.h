@@ -0,0 +1,36 @@
+#ifndef TEST_HOST_H
+#define TEST_HOST_H
+
+#include <stdio.h>
+
+// 失败时打印位置并继续执行，main 返回失败数
+extern int host_failures;
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);  \
+            host_failures++;                                                 \
+        }                                                                    \
+    } while (0)
+
+#define CHECK_INT(actual, expected)                                          \
+    do {                                                                     \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);      \
+        if (a_ != e_) {                                                      \
+            printf("%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, \
+                   #actual, a_, e_);                                         \
+            host_failures++;                                                 \
+        }                                                                    \
+    } while (0)
+
+#define RUN_TEST(fn)                                                         \
+    do {                                                                     \
+        int before_ = host_failures;                                         \
+        fn();                                                                \
+        printf("%s %s\n", host_failures == before_ ? "PASS" : "FAIL", #fn);  \
+    } while (0)
+
+#define TEST_RESULT() (host_failures == 0 ? 0 : 1)
+
+#endif // TEST_HOST_H
@@ -0,0 +1,99 @@
+#include "host_shim.h"
+#include "test_host.h"
+#include "user_mqtt.h"
+#include "user_mqtt_session.h"
+#include <limits.h>
+#include <string.h>
+
+static int s_fired;
+
+static int duplicate(int msg_id, const char *topic, const char *data) {
+    esp_mqtt_event_t event = {
+        .msg_id = msg_id,
+        .topic = (char *)topic,
+        .topic_len = strlen(topic),
+        .data = (char *)data,
+        .data_len = strlen(data),
+        .total_data_len = strlen(data),
+    };
+    return mqtt_is_duplicate(&event);
+}
+
+// 同一报文 ID 且内容相同才是重发；ID 被复用但内容不同的是新消息
+static void test_duplicate(void) {
+    uint32_t before = mqtt_duplicate_count();
+    CHECK_INT(duplicate(1, "roomlight/dev/a/ctrl", "lightNormal:#ff0000"), 0);
+    CHECK_INT(duplicate(1, "roomlight/dev/a/ctrl", "lightNormal:#ff0000"), 1);
+    CHECK_INT(duplicate(1, "roomlight/dev/a/ctrl", "lightNormal:#00ff00"), 0);
+    CHECK_INT(duplicate(1, "roomlight/room/r/ctrl", "lightNormal:#00ff00"), 0);
+    // QoS 0 没有报文 ID，不去重
+    CHECK_INT(duplicate(0, "roomlight/dev/a/ctrl", "x:1"), 0);
+    CHECK_INT(duplicate(0, "roomlight/dev/a/ctrl", "x:1"), 0);
+    CHECK_INT(mqtt_duplicate_count(), before + 1);
+}
+
+// 只记住最近 MQTT_DEDUP_NUM 条，更早的重发不再被识别
+static void test_ring_wrap(void) {
+    for (int i = 0; i < MQTT_DEDUP_NUM; i++) {
+        CHECK_INT(duplicate(100 + i, "t", "d"), 0);
+    }
+    CHECK_INT(duplicate(100, "t", "d"), 1);
+    CHECK_INT(duplicate(200, "t", "d"), 0); // 挤掉 100
+    CHECK_INT(duplicate(100, "t", "d"), 0);
+    CHECK_INT(duplicate(100 + MQTT_DEDUP_NUM - 1, "t", "d"), 1);
+}
+
+// 每次尝试的等待在 [d/2, d] 内，d 按 2 倍增长并封顶
+static void test_backoff_jitter(void) {
+    for (int attempt = 0; attempt < 40; attempt++) {
+        uint32_t d = attempt < 16 ? MQTT_BACKOFF_MIN_MS << attempt : UINT32_MAX;
+        if (d > MQTT_BACKOFF_MAX_MS) {
+            d = MQTT_BACKOFF_MAX_MS;
+        }
+        uint32_t lo = UINT32_MAX, hi = 0;
+        for (int i = 0; i < 200; i++) {
+            uint32_t delay = mqtt_backoff_ms(attempt);
+            lo = delay < lo ? delay : lo;
+            hi = delay > hi ? delay : hi;
+        }
+        CHECK(lo >= d / 2);
+        CHECK(hi <= d);
+        // 抖动确实分散了重连时刻
+        CHECK(hi - lo > d / 4);
+    }
+}
+
+static void test_backoff_cap(void) {
+    CHECK(mqtt_backoff_ms(1000) <= MQTT_BACKOFF_MAX_MS);
+    CHECK(mqtt_backoff_ms(1000) >= MQTT_BACKOFF_MAX_MS / 2);
+    CHECK(mqtt_backoff_ms(INT_MAX) <= MQTT_BACKOFF_MAX_MS);
+}
+
+static void reconnect_cb(void *arg) {
+    s_fired++;
+}
+
+// 定时器按返回的等待时间到期；连上后退避从初始值重新开始
+static void test_schedule(void) {
+    CHECK_INT(mqtt_reconnect_init(reconnect_cb), ESP_OK);
+    uint32_t delay = 0;
+    for (int i = 0; i < 10; i++) {
+        delay = mqtt_schedule_reconnect();
+        host_advance_us(delay * 1000LL - 1);
+        CHECK_INT(s_fired, i);
+        host_advance_us(1);
+        CHECK_INT(s_fired, i + 1);
+    }
+    CHECK(delay >= MQTT_BACKOFF_MAX_MS / 2);
+    mqtt_reconnect_reset();
+    CHECK(mqtt_schedule_reconnect() <= MQTT_BACKOFF_MIN_MS);
+}
+
+int main(void) {
+    RUN_TEST(test_duplicate);
+    RUN_TEST(test_ring_wrap);
+    RUN_TEST(test_backoff_jitter);
+    RUN_TEST(test_backoff_cap);
+    RUN_TEST(test_schedule);
+    return TEST_RESULT();
+}
@@ -0,0 +1,126 @@
+#include "test_host.h"
+#include "user_net_fsm.h"
+
+static net_step_t step(net_fsm_t *fsm, net_event_t event) {
+    return net_fsm_step(fsm, event);
+}
+
+static void test_happy_path(void) {
+    net_fsm_t fsm;
+    net_step_t s;
+    net_fsm_init(&fsm);
+
+    s = step(&fsm, NET_EVT_START);
+    CHECK_INT(fsm.state, NET_STATE_STA_CONNECTING);
+    CHECK_INT(s.action, NET_ACT_START_STA);
+    CHECK_INT(s.timer_ms, NET_STA_CONNECT_TIMEOUT_MS);
+
+    s = step(&fsm, NET_EVT_GOT_IP);
+    CHECK_INT(fsm.state, NET_STATE_MQTT_CONNECTING);
+    CHECK_INT(s.action, NET_ACT_START_MQTT);
+    CHECK_INT(s.timer_ms, 0);
+
+    step(&fsm, NET_EVT_MQTT_CONNECTED);
+    CHECK_INT(fsm.state, NET_STATE_MQTT_CONNECTED);
+    step(&fsm, NET_EVT_MQTT_DISCONNECTED);
+    CHECK_INT(fsm.state, NET_STATE_MQTT_CONNECTING);
+}
+
+static void test_retry_then_softap(void) {
+    net_fsm_t fsm;
+    net_step_t s;
+    net_fsm_init(&fsm);
+    step(&fsm, NET_EVT_START);
+
+    for (int i = 1; i < NET_STA_MAX_FAILURES; i++) {
+        s = step(&fsm, NET_EVT_TIMEOUT);
+        CHECK_INT(s.action, NET_ACT_RETRY_STA);
+        CHECK_INT(fsm.sta_failures, i);
+    }
+    // 断开后按失败次数指数退避，不超过上限
+    s = step(&fsm, NET_EVT_STA_DISCONNECTED);
+    CHECK_INT(s.timer_ms, NET_STA_RETRY_MAX_MS);
+
+    s = step(&fsm, NET_EVT_TIMEOUT);
+    CHECK_INT(fsm.state, NET_STATE_SOFTAP);
+    CHECK_INT(s.action, NET_ACT_START_AP);
+    CHECK_INT(s.timer_ms, NET_AP_WINDOW_MS);
+
+    // 已配网：有人操作时延长窗口，超时后回到 STA
+    s = step(&fsm, NET_EVT_AP_ACTIVITY);
+    CHECK_INT(s.timer_ms, NET_AP_WINDOW_MS);
+    s = step(&fsm, NET_EVT_TIMEOUT);
+    CHECK_INT(fsm.state, NET_STATE_STA_CONNECTING);
+    CHECK_INT(s.action, NET_ACT_START_STA);
+    CHECK_INT(fsm.sta_failures, 0);
+}
+
+static void test_unprovisioned_stays_ap(void) {
+    net_fsm_t fsm;
+    net_step_t s;
+    net_fsm_init(&fsm);
+    s = step(&fsm, NET_EVT_PROVISION);
+    CHECK_INT(fsm.state, NET_STATE_SOFTAP);
+    CHECK_INT(s.action, NET_ACT_START_AP);
+    CHECK_INT(s.timer_ms, 0);
+
+    s = step(&fsm, NET_EVT_TIMEOUT);
+    CHECK_INT(fsm.state, NET_STATE_SOFTAP);
+    CHECK_INT(s.action, NET_ACT_NONE);
+}
+
+static void test_link_loss(void) {
+    net_fsm_t fsm;
+    net_step_t s;
+    net_fsm_init(&fsm);
+    step(&fsm, NET_EVT_START);
+    step(&fsm, NET_EVT_GOT_IP);
+    step(&fsm, NET_EVT_MQTT_CONNECTED);
+
+    s = step(&fsm, NET_EVT_STA_DISCONNECTED);
+    CHECK_INT(fsm.state, NET_STATE_STA_CONNECTING);
+    CHECK_INT(s.timer_ms, NET_STA_RETRY_MIN_MS);
+}
+
+// Wi-Fi 断开后以同一租约重连，MQTT 会话没断：不会再有 MQTT 连接事件，
+// 状态机不能停在 mqtt_connecting
+static void test_reassociate_mqtt_alive(void) {
+    net_fsm_t fsm;
+    net_step_t s;
+    net_fsm_init(&fsm);
+    step(&fsm, NET_EVT_START);
+    step(&fsm, NET_EVT_GOT_IP);
+    step(&fsm, NET_EVT_MQTT_CONNECTED);
+
+    step(&fsm, NET_EVT_STA_DISCONNECTED);
+    CHECK_INT(fsm.state, NET_STATE_STA_CONNECTING);
+    s = step(&fsm, NET_EVT_GOT_IP);
+    CHECK_INT(fsm.state, NET_STATE_MQTT_CONNECTED);
+    CHECK_INT(s.action, NET_ACT_START_MQTT);
+    CHECK_INT(s.timer_ms, 0);
+
+    // 会话在 Wi-Fi 断开期间掉线，重连后等待 MQTT 重新连接
+    step(&fsm, NET_EVT_STA_DISCONNECTED);
+    step(&fsm, NET_EVT_MQTT_DISCONNECTED);
+    CHECK_INT(fsm.state, NET_STATE_STA_CONNECTING);
+    step(&fsm, NET_EVT_GOT_IP);
+    CHECK_INT(fsm.state, NET_STATE_MQTT_CONNECTING);
+    step(&fsm, NET_EVT_MQTT_CONNECTED);
+    CHECK_INT(fsm.state, NET_STATE_MQTT_CONNECTED);
+}
+
+static void test_names(void) {
+    CHECK(net_state_name(NET_STATE_MAX)[0] == '?');
+    CHECK(net_event_name(NET_EVT_MAX)[0] == '?');
+    CHECK(net_state_name(NET_STATE_SOFTAP)[0] == 's');
+}
+
+int main(void) {
+    RUN_TEST(test_happy_path);
+    RUN_TEST(test_retry_then_softap);
+    RUN_TEST(test_unprovisioned_stays_ap);
+    RUN_TEST(test_link_loss);
+    RUN_TEST(test_reassociate_mqtt_alive);
+    RUN_TEST(test_names);
+    return TEST_RESULT();
+}
@@ -0,0 +1,218 @@
+#include "host_shim.h"
+#include "test_host.h"
+#include "user_config.h"
+#include "user_nvs.h"
+#include <stdio.h>
+#include <string.h>
+
+#define NVS_FILE "test_nvs.bin"
+
+static void packet(const char *s) {
+    parse_data_packet(s, strlen(s), &nvs_data);
+}
+
+// 模拟重启：内存清空后从文件重新载入
+static void reboot(void) {
+    nvs_flush_and_restart();
+    memset(&nvs_data, 0, sizeof(nvs_data));
+    nvs_flash_init();
+    nvs_read_data_from_flash();
+}
+
+static void test_debounce(void) {
+    host_nvs_stats_t before = host_nvs;
+    packet("{\"lightNormal\":\"#102030\"}");
+    host_advance_us((NVS_FLUSH_DELAY_MS - 1) * 1000LL);
+    CHECK_INT(host_nvs.commits, before.commits);
+    host_advance_us(2000);
+    CHECK_INT(host_nvs.commits, before.commits + 1);
+}
+
+static void test_unchanged_skipped(void) {
+    nvs_stats_t stats;
+    nvs_get_stats(&stats);
+    uint32_t skipped = stats.skipped;
+    host_nvs_stats_t before = host_nvs;
+
+    packet("{\"lightNormal\":\"#102030\"}");
+    host_advance_us(NVS_FLUSH_MAX_DELAY_MS * 1000LL);
+    nvs_get_stats(&stats);
+    CHECK_INT(stats.skipped, skipped + 1);
+    CHECK_INT(host_nvs.commits, before.commits);
+}
+
+// 连续修改不断推迟落盘，但脏数据最长保留 NVS_FLUSH_MAX_DELAY_MS
+static void test_max_delay(void) {
+    host_nvs_stats_t before = host_nvs;
+    char buf[48];
+    int64_t start = host_time_us;
+    for (int i = 0; host_nvs.commits == before.commits && i < 100; i++) {
+        sprintf(buf, "{\"lightPeriod\":\"%d\"}", i + 1);
+        packet(buf);
+        host_advance_us(500 * 1000LL);
+    }
+    CHECK_INT(host_nvs.commits, before.commits + 1);
+    CHECK(host_time_us - start <= (NVS_FLUSH_MAX_DELAY_MS + 500) * 1000LL);
+    host_advance_us(NVS_FLUSH_MAX_DELAY_MS * 1000LL);
+}
+
+// 落盘失败后重新计时，不等下一次修改
+static void test_flush_retry(void) {
+    host_nvs_stats_t before = host_nvs;
+    host_nvs.fail_commits = 1;
+    packet("{\"lightSwitch1\":\"#ff0000\"}");
+    host_advance_us(NVS_FLUSH_DELAY_MS * 1000LL + 1000);
+    CHECK_INT(host_nvs.commits, before.commits);
+    host_advance_us(NVS_FLUSH_RETRY_MS * 1000LL);
+    CHECK_INT(host_nvs.commits, before.commits + 1);
+}
+
+static void test_persist_across_reboot(void) {
+    packet("{\"room\":\"r42\",\"lightSwitch2\":\"#00ff00\"}");
+    reboot();
+    CHECK_INT(host_restarts, 1);
+    CHECK(strcmp(nvs_data.roomID, "r42") == 0);
+    CHECK(strcmp(nvs_data.lightSwitch2, "#00ff00") == 0);
+    CHECK(strcmp(nvs_data.lightSwitch1, "#ff0000") == 0);
+}
+
+// 重启指令先落盘再重启
+static void test_reboot_flushes(void) {
+    host_nvs_stats_t before = host_nvs;
+    int restarts = host_restarts;
+    packet("{\"lightSwitch3\":\"#0000ff\",\"reboot\":\"1\"}");
+    CHECK_INT(host_restarts, restarts + 1);
+    CHECK_INT(host_nvs.commits, before.commits + 1);
+}
+
+// 写放大：1000 条颜色命令，每 50 ms 一条
+static void test_commits_per_1000(void) {
+    host_nvs_stats_t before = host_nvs;
+    char buf[48], color[8];
+
+    for (int i = 0; i < 1000; i++) {
+        sprintf(color, "#%06x", i * 7919 & 0xffffff);
+        sprintf(buf, "{\"lightNormal\":\"%s\"}", color);
+        packet(buf);
+        host_advance_us(50 * 1000LL);
+    }
+    host_advance_us(NVS_FLUSH_MAX_DELAY_MS * 1000LL);
+
+    uint32_t commits = host_nvs.commits - before.commits;
+    uint32_t bytes = host_nvs.bytes_written - before.bytes_written;
+    printf("1000 commands over 50 s: %u commits, %u bytes written\n", commits,
+           bytes);
+    // 每 NVS_FLUSH_MAX_DELAY_MS 最多一次，逐条提交则为 1000 次
+    CHECK(commits <= 50000 / NVS_FLUSH_MAX_DELAY_MS + 1);
+    CHECK(commits >= 1);
+    // 最后一条命令已落盘
+    reboot();
+    CHECK(strcmp(nvs_data.lightNormal, color) == 0);
+}
+
+static void load_from_flash(void) {
+    memset(&nvs_data, 0, sizeof(nvs_data));
+    nvs_flash_init();
+    nvs_read_data_from_flash();
+}
+
+// 直接改写 flash 中的配置 blob
+static void patch_blob(int offset, uint8_t xor) {
+    uint8_t blob[512];
+    size_t len = sizeof(blob);
+    nvs_handle handle;
+    nvs_open("customer_data", NVS_READWRITE, &handle);
+    CHECK_INT(nvs_get_blob(handle, "cfg", blob, &len), ESP_OK);
+    blob[offset] ^= xor;
+    nvs_set_blob(handle, "cfg", blob, len);
+    nvs_commit(handle);
+}
+
+// 启动时配置只读一次 blob，不再逐个字段读取
+static void test_boot_single_read(void) {
+    packet("{\"ssid\":\"HomeNet\",\"pass\":\"secret\",\"ver\":7}");
+    nvs_flush();
+    host_nvs_stats_t before = host_nvs;
+    load_from_flash();
+    // 期望状态版本号 + 配置 blob，其余 4 次为校准、密钥、定时规则和时区
+    CHECK_INT(host_nvs.reads - before.reads, 2 + 4);
+    CHECK_INT(host_nvs.writes, before.writes);
+    CHECK(strcmp(nvs_data.ssid, "HomeNet") == 0);
+    CHECK_INT(nvs_desired_version(), 7);
+}
+
+static void test_blob_crc_mismatch(void) {
+    patch_blob(4, 0x01); // ssid 的第一个字节
+    load_from_flash();
+    CHECK(strcmp(nvs_data.ssid, "default") == 0);
+    CHECK(strcmp(nvs_data.lightNormal, "default") == 0);
+}
+
+static void test_blob_version_mismatch(void) {
+    packet("{\"ssid\":\"HomeNet\"}");
+    nvs_flush();
+    patch_blob(0, 0x02); // version
+    load_from_flash();
+    CHECK(strcmp(nvs_data.ssid, "default") == 0);
+}
+
+// 旧版固件逐个键保存的字符串迁移到 blob，迁移成功后删除旧键
+static void test_legacy_migration(void) {
+    nvs_handle handle;
+    char value[NVS_STORAGE_MAX];
+    size_t len = sizeof(value);
+
+    nvs_flash_erase();
+    nvs_open("customer_data", NVS_READWRITE, &handle);
+    nvs_set_str(handle, NVS_SSID, "OldNet");
+    nvs_set_str(handle, NVS_LightNormal, "63488");
+    nvs_commit(handle);
+
+    load_from_flash();
+    CHECK(strcmp(nvs_data.ssid, "OldNet") == 0);
+    CHECK(strcmp(nvs_data.lightNormal, "63488") == 0);
+    CHECK(strcmp(nvs_data.pass, "default") == 0);
+    CHECK_INT(nvs_get_str(handle, NVS_SSID, value, &len), ESP_ERR_NVS_NOT_FOUND);
+
+    load_from_flash();
+    CHECK(strcmp(nvs_data.ssid, "OldNet") == 0);
+}
+
+// 无法使用的 ver 或字段值与语法错误一样，整个包都不应用
+static void test_reject_invalid_packet(void) {
+    packet("{\"room\":\"keep\",\"lightPeriod\":\"3\",\"ver\":100}");
+    packet("{\"room\":\"changed\",\"ver\":\"4294967296\"}");
+    packet("{\"room\":\"changed\",\"ver\":\"12a\"}");
+    packet("{\"room\":\"changed\",\"ver\":\"\"}");
+    packet("{\"room\":\"changed\","
+           "\"pass\":\"0123456789012345678901234567890\"}");
+    packet("{\"room\":\"changed\",\"user\":\"\\ud83d\"}");
+    CHECK(strcmp(nvs_data.roomID, "keep") == 0);
+    CHECK_INT(nvs_desired_version(), 100);
+
+    packet("{\"room\":\"\\u5ba2\",\"ver\":4294967295}");
+    CHECK(strcmp(nvs_data.roomID, "\xe5\xae\xa2") == 0);
+    CHECK_INT(nvs_desired_version(), 4294967295u);
+}
+
+int main(void) {
+    remove(NVS_FILE);
+    host_nvs_reset(NVS_FILE);
+    init_nvs();
+    nvs_read_data_from_flash();
+
+    RUN_TEST(test_debounce);
+    RUN_TEST(test_unchanged_skipped);
+    RUN_TEST(test_max_delay);
+    RUN_TEST(test_flush_retry);
+    RUN_TEST(test_persist_across_reboot);
+    RUN_TEST(test_reboot_flushes);
+    RUN_TEST(test_commits_per_1000);
+    RUN_TEST(test_boot_single_read);
+    RUN_TEST(test_blob_crc_mismatch);
+    RUN_TEST(test_blob_version_mismatch);
+    RUN_TEST(test_legacy_migration);
+    RUN_TEST(test_reject_invalid_packet);
+    remove(NVS_FILE);
+    return TEST_RESULT();
+}
@@ -0,0 +1,131 @@
+#include "test_host.h"
+#include "user_parser.h"
+#include <string.h>
+
+typedef struct
+{
+    int count;
+    char keys[8][16];
+    char values[8][64];
+} pairs_t;
+
+static void collect(const char *key, int key_len, const char *value,
+                    int value_len, void *arg) {
+    pairs_t *p = arg;
+    if (p->count < 8) {
+        memcpy(p->keys[p->count], key, key_len);
+        p->keys[p->count][key_len] = '\0';
+        memcpy(p->values[p->count], value, value_len);
+        p->values[p->count][value_len] = '\0';
+    }
+    p->count++;
+}
+
+static int scan(const char *s, pairs_t *p) {
+    memset(p, 0, sizeof(*p));
+    return parser_scan(s, strlen(s), collect, p);
+}
+
+static void test_json(void) {
+    pairs_t p;
+    CHECK_INT(scan("{\"lightNormal\":\"#ff0000\", \"ver\" : 12 }", &p), 2);
+    CHECK(strcmp(p.keys[0], "lightNormal") == 0);
+    CHECK(strcmp(p.values[0], "#ff0000") == 0);
+    CHECK(strcmp(p.keys[1], "ver") == 0);
+    CHECK(strcmp(p.values[1], "12") == 0);
+    CHECK_INT(scan("{}", &p), 0);
+}
+
+static void test_shorthand(void) {
+    pairs_t p;
+    CHECK_INT(scan("hsv:120/500/1000,lightPeriod:5", &p), 2);
+    CHECK(strcmp(p.keys[0], "hsv") == 0);
+    CHECK(strcmp(p.values[0], "120/500/1000") == 0);
+    CHECK(strcmp(p.values[1], "5") == 0);
+}
+
+static void test_nested_skipped(void) {
+    pairs_t p;
+    CHECK_INT(scan("{\"a\":{\"b\":\"}\"},\"c\":[1,2],\"d\":\"x\"}", &p), 1);
+    CHECK(strcmp(p.keys[0], "d") == 0);
+}
+
+static void test_errors(void) {
+    pairs_t p;
+    CHECK_INT(scan("{\"a\":\"unterminated}", &p), -1);
+    CHECK_INT(scan("{\"a\":1", &p), -1);
+    CHECK_INT(scan("{\"a\" 1}", &p), -1);
+    CHECK_INT(scan("{\"a\":1} trailing", &p), -1);
+    CHECK_INT(scan(":1", &p), -1);
+    CHECK_INT(parser_scan(NULL, 4, collect, &p), -1);
+}
+
+static void test_explicit_length(void) {
+    // 不依赖 '\0'，长度之外的内容不应被读取
+    const char buf[] = "{\"a\":1}GARBAGE";
+    pairs_t p = {0};
+    CHECK_INT(parser_scan(buf, 7, collect, &p), 1);
+    // 长度包含结尾符也接受
+    CHECK_INT(parser_scan("{\"a\":1}", 8, NULL, NULL), 1);
+}
+
+static void test_copy_value(void) {
+    char dst[8];
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "a\\\"b\\n", 6), 4);
+    CHECK(strcmp(dst, "a\"b\n") == 0);
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "12345678", 8), -1);
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "1234567", 7), 7);
+}
+
+static void test_copy_escapes(void) {
+    char dst[16];
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "a\\bb\\fc\\/", 9), 6);
+    CHECK(strcmp(dst, "a\bb\fc/") == 0);
+}
+
+static void test_copy_unicode(void) {
+    char dst[16];
+    // Python json.dumps 默认输出的 ASCII 转义
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "\\u5ba2\\u5385", 12), 6);
+    CHECK(strcmp(dst, "\xe5\xae\xa2\xe5\x8e\x85") == 0);
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "A\\u0041\\u00e9", 13), 4);
+    CHECK(strcmp(dst, "AA\xc3\xa9") == 0);
+    // 代理对解码为 4 字节 UTF-8
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "\\uD83D\\uDCA1", 12), 4);
+    CHECK(strcmp(dst, "\xf0\x9f\x92\xa1") == 0);
+    // 多字节字符放不下时整体失败，不截断半个字符
+    CHECK_INT(parser_copy_value(dst, 4, "ab\\u00e9", 8), -1);
+    CHECK_INT(parser_copy_value(dst, 5, "ab\\u00e9", 8), 4);
+}
+
+static void test_copy_unicode_invalid(void) {
+    char dst[16];
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "\\u12", 4), -1);
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "\\u12g4", 6), -1);
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "\\u0000", 6), -1);
+    // 孤立的高位或低位代理
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "\\ud83dx", 7), -1);
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "\\ud83d\\u0041", 12), -1);
+    CHECK_INT(parser_copy_value(dst, sizeof(dst), "\\udca1", 6), -1);
+}
+
+static void test_scan_unicode(void) {
+    // 扫描阶段保留原始片段，\" 不结束字符串
+    pairs_t p;
+    CHECK_INT(scan("{\"room\":\"\\u5ba2\\\"\",\"ver\":3}", &p), 2);
+    CHECK(strcmp(p.values[0], "\\u5ba2\\\"") == 0);
+}
+
+int main(void) {
+    RUN_TEST(test_json);
+    RUN_TEST(test_shorthand);
+    RUN_TEST(test_nested_skipped);
+    RUN_TEST(test_errors);
+    RUN_TEST(test_explicit_length);
+    RUN_TEST(test_copy_value);
+    RUN_TEST(test_copy_escapes);
+    RUN_TEST(test_copy_unicode);
+    RUN_TEST(test_copy_unicode_invalid);
+    RUN_TEST(test_scan_unicode);
+    return TEST_RESULT();
+}
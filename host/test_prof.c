@@ -0,0 +1,85 @@
+#include "host_shim.h"
+#include "test_host.h"
+#include "user_prof.h"
+#include <string.h>
+
+// 格式化后再解析，得到相同的阶段时间
+static void test_round_trip(void) {
+    char buf[128];
+    prof_record_t rec;
+
+    for (int i = 0; i < PROF_PHASE_MAX; i++) {
+        host_time_us = (i + 1) * 123456LL;
+        if (i != PROF_SNTP_DONE) {
+            prof_mark(i);
+        }
+    }
+    // 重复到达不覆盖第一次的时间
+    host_time_us = 99000000;
+    prof_mark(PROF_GOT_IP);
+
+    CHECK(prof_format(buf, sizeof(buf), 4) > 0);
+    CHECK_INT(prof_parse(buf, &rec), 0);
+    CHECK_INT(rec.version, PROF_RECORD_VERSION);
+    CHECK_INT(rec.reset_reason, 4);
+    for (int i = 0; i < PROF_PHASE_MAX; i++) {
+        uint32_t ms = (i + 1) * 123456 / 1000;
+        CHECK_INT(rec.marks[i], i == PROF_SNTP_DONE ? 0 : ms);
+    }
+}
+
+static void test_truncated(void) {
+    char buf[128];
+    prof_record_t rec;
+    CHECK_INT(prof_format(buf, 24, 1), -1);
+    CHECK(prof_format(buf, sizeof(buf), 1) > 0);
+    *strrchr(buf, '/') = '\0';
+    CHECK_INT(prof_parse(buf, &rec), -1);
+}
+
+static void test_parse_invalid(void) {
+    prof_record_t rec;
+    CHECK_INT(prof_parse("prof:99,reset:1,boot:1/2/3/4/5/6/7/8/9", &rec), -1);
+    CHECK_INT(prof_parse("prof:1,reset:1,boot:1/2/3/x/5/6/7/8/9", &rec), -1);
+    CHECK_INT(prof_parse("prof:1,reset:1,boot:1/2/3", &rec), -1);
+    CHECK_INT(prof_parse("wake:100,render:1.00", &rec), -1);
+    CHECK_INT(prof_parse("prof:1,reset:2,boot:-/-/-/-/-/-/-/-/-", &rec), 0);
+    CHECK_INT(rec.marks[PROF_BOOT], 0);
+}
+
+// 唤醒率按两次查询之间的时长平均，每次查询后重新计数
+static void test_wakeup_rate(void) {
+    char buf[160];
+
+    host_time_us = 200000000;
+    CHECK(prof_format_wakeups(buf, sizeof(buf)) > 0);
+    for (int i = 0; i < 5; i++) {
+        prof_wakeup(PROF_TASK_RENDER);
+    }
+    for (int i = 0; i < 3; i++) {
+        prof_wakeup(PROF_TASK_INPUT);
+    }
+    prof_wakeup(PROF_TASK_MAX); // 越界的任务不计数
+    host_time_us += 2000000;
+    CHECK(prof_format_wakeups(buf, sizeof(buf)) > 0);
+    CHECK(strncmp(buf, "wake:2000,", 10) == 0);
+    CHECK(strstr(buf, ",render:2.50") != NULL);
+    CHECK(strstr(buf, ",input:1.50") != NULL);
+    CHECK(strstr(buf, ",net:0.00") != NULL);
+
+    // 上次查询之后没有唤醒
+    host_time_us += 1000000;
+    prof_wakeup(PROF_TASK_SYNC);
+    CHECK(prof_format_wakeups(buf, sizeof(buf)) > 0);
+    CHECK(strncmp(buf, "wake:1000,", 10) == 0);
+    CHECK(strstr(buf, ",render:0.00") != NULL);
+    CHECK(strstr(buf, ",sync:1.00") != NULL);
+}
+
+int main(void) {
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_truncated);
+    RUN_TEST(test_parse_invalid);
+    RUN_TEST(test_wakeup_rate);
+    return TEST_RESULT();
+}
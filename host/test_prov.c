@@ -0,0 +1,153 @@
+#include "test_host.h"
+#include "user_prov.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_FRAMES 32
+#define LOG_SIZE 2048
+
+// 记录切出的帧，超长帧用 "!" 标记
+typedef struct {
+    int count;
+    int pos;
+    char data[LOG_SIZE];
+} frame_log_t;
+
+static void on_frame(const char *frame, int len, void *arg) {
+    frame_log_t *log = arg;
+    if (log->count < MAX_FRAMES && log->pos + len + 1 < LOG_SIZE) {
+        memcpy(log->data + log->pos, frame, len);
+        log->pos += len;
+        log->data[log->pos++] = '\n';
+    }
+    log->count++;
+}
+
+static void feed(prov_rx_t *rx, frame_log_t *log, const char *s, int len) {
+    while (len > 0) {
+        int n = PROV_RX_SIZE - rx->len;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(rx->buf + rx->len, s, n);
+        rx->len += n;
+        s += n;
+        len -= n;
+        if (prov_rx_process(rx, 0, on_frame, log) < 0) {
+            on_frame("!", 1, log);
+        }
+    }
+}
+
+// 按 cuts 中给出的位置切成若干段依次送入，最后关闭连接
+static void run(const char *s, int len, const int *cuts, int ncuts,
+                frame_log_t *log) {
+    static prov_rx_t rx;
+    int pos = 0;
+
+    memset(&rx, 0, sizeof(rx));
+    memset(log, 0, sizeof(*log));
+    for (int i = 0; i <= ncuts; i++) {
+        int end = i < ncuts ? cuts[i] : len;
+        feed(&rx, log, s + pos, end - pos);
+        pos = end;
+    }
+    prov_rx_process(&rx, 1, on_frame, log);
+}
+
+static int same(const frame_log_t *a, const frame_log_t *b) {
+    return a->count == b->count && a->pos == b->pos &&
+           memcmp(a->data, b->data, a->pos) == 0;
+}
+
+// 每个位置切一刀、每两个位置切两刀，以及随机切分，结果都与整段送入相同
+static void fuzz(const char *s, const frame_log_t *expect) {
+    int len = strlen(s);
+    frame_log_t log;
+    int cuts[16];
+
+    for (int i = 0; i <= len; i++) {
+        cuts[0] = i;
+        run(s, len, cuts, 1, &log);
+        CHECK(same(&log, expect));
+    }
+    for (int i = 0; i <= len; i += 3) {
+        for (int j = i; j <= len; j += 5) {
+            cuts[0] = i;
+            cuts[1] = j;
+            run(s, len, cuts, 2, &log);
+            CHECK(same(&log, expect));
+        }
+    }
+    srand(1);
+    for (int k = 0; k < 500; k++) {
+        int n = rand() % 16;
+        for (int i = 0; i < n; i++) {
+            cuts[i] = rand() % (len + 1);
+        }
+        // 切点需要递增
+        for (int i = 1; i < n; i++) {
+            for (int j = i; j > 0 && cuts[j - 1] > cuts[j]; j--) {
+                int t = cuts[j];
+                cuts[j] = cuts[j - 1];
+                cuts[j - 1] = t;
+            }
+        }
+        run(s, len, cuts, n, &log);
+        CHECK(same(&log, expect));
+    }
+}
+
+static void test_lines(void) {
+    const char *s = "ssid:home\r\npass:a b\n\n  room:r1\nuser:u";
+    frame_log_t log;
+    run(s, strlen(s), NULL, 0, &log);
+    CHECK_INT(log.count, 4);
+    CHECK(strcmp(log.data, "ssid:home\npass:a b\nroom:r1\nuser:u\n") == 0);
+    fuzz(s, &log);
+}
+
+// JSON 帧按括号配平切分，字符串里的括号、转义的引号和换行不算
+static void test_json(void) {
+    const char *s = "{\"ssid\":\"a}b\",\"pass\":\"q\\\"{\\\\\",\"x\":{\"y\":1}}"
+                    "\r\n{\"room\":\"line\nbreak\"}"
+                    "ssid:plain\n"
+                    "{\"user\":\"u\"}";
+    frame_log_t log;
+    run(s, strlen(s), NULL, 0, &log);
+    CHECK_INT(log.count, 4);
+    CHECK(strncmp(log.data, "{\"ssid\":\"a}b\",\"pass\":\"q\\\"{\\\\\",", 30) ==
+          0);
+    CHECK(strstr(log.data, "\"x\":{\"y\":1}}\n{\"room\":\"line\nbreak\"}\n") !=
+          NULL);
+    fuzz(s, &log);
+}
+
+// 超长帧被丢弃并只报告一次，后面的帧照常处理
+static void test_overlong(void) {
+    static char s[PROV_RX_SIZE * 2 + 64];
+    int pos = 0;
+    frame_log_t log;
+
+    pos += sprintf(s + pos, "room:a\n");
+    memset(s + pos, 'x', PROV_RX_SIZE + 10);
+    pos += PROV_RX_SIZE + 10;
+    pos += sprintf(s + pos, "\nroom:b\n");
+    run(s, pos, NULL, 0, &log);
+    CHECK_INT(log.count, 3);
+    CHECK(strcmp(log.data, "room:a\n!\nroom:b\n") == 0);
+
+    // 同一超长帧跨越缓冲区边界的切分方式不影响结果
+    frame_log_t other;
+    int cuts[2] = {3, PROV_RX_SIZE + 5};
+    run(s, pos, cuts, 2, &other);
+    CHECK(same(&other, &log));
+}
+
+int main(void) {
+    RUN_TEST(test_lines);
+    RUN_TEST(test_json);
+    RUN_TEST(test_overlong);
+    return TEST_RESULT();
+}
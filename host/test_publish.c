@@ -0,0 +1,142 @@
+#include "host_shim.h"
+#include "sdkconfig.h"
+#include "test_host.h"
+#include "user_mqtt.h"
+#include "user_publish.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CLIENT ((esp_mqtt_client_handle_t)&host_mqtt)
+
+// 推进时间并让发送任务处理到期的消息
+static void run_ms(int ms) {
+    host_time_us += ms * 1000LL;
+    publish_service();
+}
+
+// 同主题的事件逐条按顺序发出，不互相覆盖
+static void test_events_fifo(void) {
+    char data[8];
+    uint32_t published = host_mqtt.published;
+
+    for (int i = 0; i < PUB_BUCKET_SIZE; i++) {
+        sprintf(data, "k%d", i);
+        CHECK_INT(publish_message("roomlight/key", data, PUB_CLASS_EVENT), ESP_OK);
+    }
+    // 在突发额度内立即全部发出，最后发出的是最后入队的
+    publish_service();
+    CHECK_INT(host_mqtt.published, published + PUB_BUCKET_SIZE);
+    CHECK(strcmp(host_mqtt.last_data, "k3") == 0);
+    CHECK_INT(host_mqtt.last_qos, 1);
+}
+
+// 令牌用完后余下的事件按速率补发，顺序不变
+static void test_events_throttled(void) {
+    pub_stats_t before, after;
+    char data[8];
+    publish_get_stats(&before);
+    uint32_t published = host_mqtt.published;
+
+    run_ms(10000); // 令牌桶回满
+    for (int i = 0; i < PUB_ENTRY_NUM; i++) {
+        sprintf(data, "e%d", i);
+        publish_message("roomlight/key", data, PUB_CLASS_EVENT);
+    }
+    CHECK_INT(publish_message("roomlight/key", "over", PUB_CLASS_EVENT),
+              ESP_ERR_NO_MEM);
+    publish_service();
+    CHECK_INT(host_mqtt.published, published + PUB_BUCKET_SIZE);
+    for (int i = PUB_BUCKET_SIZE; i < PUB_ENTRY_NUM; i++) {
+        run_ms(1000 / CONFIG_ROOMLIGHT_PUBLISH_RATE + 1);
+        sprintf(data, "e%d", i);
+        CHECK(strcmp(host_mqtt.last_data, data) == 0);
+    }
+    CHECK_INT(host_mqtt.published, published + PUB_ENTRY_NUM);
+
+    publish_get_stats(&after);
+    CHECK_INT(after.dropped, before.dropped + 1);
+    CHECK_INT(after.suppressed, before.suppressed);
+    CHECK(after.throttled > before.throttled);
+}
+
+// 状态字段在合并窗口内合成一条报告，同一字段只保留最新值
+static void test_fields_coalesced(void) {
+    pub_stats_t before, after;
+    run_ms(10000);
+    publish_get_stats(&before);
+    uint32_t published = host_mqtt.published;
+
+    publish_field("sw", "1");
+    publish_field("color", "#102030");
+    publish_field("sw", "0");
+    publish_service();
+    CHECK_INT(host_mqtt.published, published);
+    run_ms(CONFIG_ROOMLIGHT_PUBLISH_COALESCE_MS);
+    CHECK_INT(host_mqtt.published, published + 1);
+    CHECK(strcmp(host_mqtt.last_topic, MQTT_UpdateTopic) == 0);
+    CHECK(strstr(host_mqtt.last_data, "sw:0") != NULL);
+    CHECK(strstr(host_mqtt.last_data, "color:#102030") != NULL);
+    CHECK_INT(host_mqtt.last_qos, 0);
+
+    publish_get_stats(&after);
+    CHECK_INT(after.suppressed, before.suppressed + 1);
+}
+
+// 一条放不下时拆成多条，每一条都带设备标识
+static void test_report_id(void) {
+    char key[8], value[PUB_FIELD_VALUE_SIZE];
+    run_ms(10000);
+    uint32_t published = host_mqtt.published;
+
+    CHECK_INT(publish_set_report_id("sn", "0123456789ab"), ESP_OK);
+    memset(value, 'x', sizeof(value) - 1);
+    value[sizeof(value) - 1] = '\0';
+    for (int i = 0; i < PUB_FIELD_NUM - 2; i++) {
+        sprintf(key, "f%d", i);
+        publish_field(key, value);
+    }
+    run_ms(CONFIG_ROOMLIGHT_PUBLISH_COALESCE_MS);
+    CHECK_INT(host_mqtt.published, published + 2);
+    CHECK(strncmp(host_mqtt.last_data, "sn:0123456789ab,", 16) == 0);
+}
+
+// 只有本模块发出的 QoS 1 报文 ID 的 PUBACK 才计入，同一 ID 只计一次
+static void test_ack_matches_msg_id(void) {
+    pub_stats_t before, after;
+
+    run_ms(10000); // 补满令牌
+    publish_get_stats(&before);
+    CHECK_INT(publish_message("roomlight/key", "ack", PUB_CLASS_EVENT), ESP_OK);
+    publish_service();
+    int msg_id = (int)host_mqtt.published; // shim 以发布序号作为报文 ID
+
+    publish_on_ack(msg_id + 100);
+    publish_on_ack(0);
+    publish_get_stats(&after);
+    CHECK_INT(after.acked, before.acked);
+
+    publish_on_ack(msg_id);
+    publish_on_ack(msg_id);
+    publish_get_stats(&after);
+    CHECK_INT(after.acked, before.acked + 1);
+
+    // QoS 0 的状态报告不等待 PUBACK
+    publish_field("sw", "1");
+    run_ms(CONFIG_ROOMLIGHT_PUBLISH_COALESCE_MS + 1);
+    CHECK_INT(host_mqtt.last_qos, 0);
+    publish_on_ack((int)host_mqtt.published);
+    publish_get_stats(&after);
+    CHECK_INT(after.acked, before.acked + 1);
+}
+
+int main(void) {
+    publish_init();
+    publish_set_connected(CLIENT);
+
+    RUN_TEST(test_events_fifo);
+    RUN_TEST(test_events_throttled);
+    RUN_TEST(test_fields_coalesced);
+    RUN_TEST(test_report_id);
+    RUN_TEST(test_ack_matches_msg_id);
+    return TEST_RESULT();
+}
@@ -0,0 +1,173 @@
+#include "host_shim.h"
+#include "sdkconfig.h"
+#include "test_host.h"
+#include "user_pwm.h"
+#include <math.h>
+
+// 硬件通道顺序：R, B, G
+#define CH_R 0
+#define CH_B 1
+#define CH_G 2
+#define PERIOD_US 1000
+
+static void setup(void) {
+    static const uint32_t io[3] = {12, 13, 14};
+    static const uint32_t duty[3] = {0, 0, 0};
+    pwm_calibration_t cal;
+    CHECK_INT(init_pwm(io, 3, 1000, duty), ESP_OK);
+    pwm_calibration_default(&cal);
+    pwm_set_calibration(&cal);
+}
+
+// 每帧之间留出最小提交间隔，保证每帧都真正提交
+static void frame(uint16_t r, uint16_t g, uint16_t b) {
+    host_time_us += CONFIG_ROOMLIGHT_PWM_MIN_COMMIT_MS * 1000;
+    set_rgb48(r, g, b);
+}
+
+static void test_init(void) {
+    static const uint32_t io[3] = {12, 13, 14};
+    static const uint32_t duty[3] = {50, 0, 100};
+    CHECK_INT(init_pwm(io, 3, 0, duty), ESP_ERR_INVALID_ARG);
+    CHECK_INT(init_pwm(io, 4, 1000, duty), ESP_ERR_INVALID_ARG);
+    CHECK_INT(init_pwm(io, 3, 1000, duty), ESP_OK);
+    CHECK_INT(host_pwm.period, PERIOD_US);
+    CHECK_INT(host_pwm.duty[0], 500);
+    CHECK_INT(host_pwm.duty[2], 1000);
+}
+
+static void test_channel_order(void) {
+    setup();
+    frame(0xffff, 0, 0);
+    CHECK_INT(host_pwm.duty[CH_R], PERIOD_US);
+    CHECK_INT(host_pwm.duty[CH_G], 0);
+    CHECK_INT(host_pwm.duty[CH_B], 0);
+    frame(0, 0xffff, 0);
+    CHECK_INT(host_pwm.duty[CH_R], 0);
+    CHECK_INT(host_pwm.duty[CH_G], PERIOD_US);
+    frame(0, 0, 0xffff);
+    CHECK_INT(host_pwm.duty[CH_B], PERIOD_US);
+}
+
+// 只接了 R、B 两路时，未接线的 G 不能挡住后面的 B
+static void test_two_channels(void) {
+    static const uint32_t io[2] = {12, 13};
+    static const uint32_t duty[2] = {0, 0};
+    CHECK_INT(init_pwm(io, 2, 1000, duty), ESP_OK);
+    frame(0, 0xffff, 0xffff);
+    CHECK_INT(host_pwm.duty[CH_R], 0);
+    CHECK_INT(host_pwm.duty[CH_B], PERIOD_US);
+}
+
+// 查找表按 CONFIG_ROOMLIGHT_GAMMA_X10 生成，插值后与直接计算相差不超过 1 微秒
+static void test_gamma_lut(void) {
+    const double gamma = CONFIG_ROOMLIGHT_GAMMA_X10 / 10.0;
+    setup();
+    for (uint32_t level = 0; level <= 0xffff; level += 251) {
+        double expected = pow(level / 65535.0, gamma) * PERIOD_US;
+        frame(level, 0, 0);
+        CHECK(fabs(host_pwm.duty[CH_R] - expected) <= 1.0);
+    }
+    frame(0xffff, 0, 0);
+    CHECK_INT(host_pwm.duty[CH_R], PERIOD_US);
+}
+
+static void test_gamma_monotonic(void) {
+    uint32_t last = 0;
+    setup();
+    frame(0, 0, 0);
+    CHECK_INT(host_pwm.duty[CH_R], 0);
+    for (uint32_t level = 0; level <= 0xffff; level += 37) {
+        frame(level, 0, 0);
+        CHECK(host_pwm.duty[CH_R] >= last);
+        last = host_pwm.duty[CH_R];
+    }
+}
+
+// RGB565 兼容接口：绿色保留 6 位，低亮度不再只有 32 级
+static void test_rgb565(void) {
+    uint32_t last = 0;
+    int levels = 0;
+    setup();
+    for (uint16_t g = 0; g < 64; g++) {
+        host_time_us += CONFIG_ROOMLIGHT_PWM_MIN_COMMIT_MS * 1000;
+        set_rgb_color(g << 5);
+        levels += host_pwm.duty[CH_G] != last;
+        last = host_pwm.duty[CH_G];
+    }
+    CHECK_INT(last, PERIOD_US);
+    CHECK(levels > 32);
+}
+
+static void test_commit_rate(void) {
+    pwm_stats_t before, after;
+    setup();
+    frame(0xffff, 0, 0);
+    pwm_get_stats(&before);
+    uint32_t starts = host_pwm.starts;
+
+    // 相同的帧不提交
+    set_rgb48(0xffff, 0, 0);
+    CHECK_INT(host_pwm.starts, starts);
+    // 最小间隔内的帧只保留最新一帧
+    set_rgb48(0, 0xffff, 0);
+    set_rgb48(0, 0, 0xffff);
+    CHECK_INT(host_pwm.starts, starts);
+    CHECK(pwm_frame_pending_ms() > 0);
+    CHECK(pwm_frame_pending_ms() <= CONFIG_ROOMLIGHT_PWM_MIN_COMMIT_MS);
+
+    host_time_us += CONFIG_ROOMLIGHT_PWM_MIN_COMMIT_MS * 1000;
+    pwm_frame_commit();
+    CHECK_INT(host_pwm.starts, starts + 1);
+    CHECK_INT(host_pwm.duty[CH_B], PERIOD_US);
+    CHECK_INT(pwm_frame_pending_ms(), 0);
+
+    pwm_get_stats(&after);
+    CHECK_INT(after.commits, before.commits + 1);
+    CHECK_INT(after.skipped, before.skipped + 1);
+    CHECK_INT(after.coalesced, before.coalesced + 1);
+}
+
+// 一帧内所有通道一起生效，不会出现只改了一部分通道的中间状态
+static void test_atomic_frame(void) {
+    setup();
+    frame(0xffff, 0, 0);
+    uint32_t starts = host_pwm.starts;
+    pwm_frame_stage(CH_R, 0);
+    pwm_frame_stage(CH_G, PERIOD_US);
+    CHECK_INT(host_pwm.duty[CH_R], PERIOD_US);
+    CHECK_INT(host_pwm.duty[CH_G], 0);
+    host_time_us += CONFIG_ROOMLIGHT_PWM_MIN_COMMIT_MS * 1000;
+    pwm_frame_commit();
+    CHECK_INT(host_pwm.starts, starts + 1);
+    CHECK_INT(host_pwm.duty[CH_R], 0);
+    CHECK_INT(host_pwm.duty[CH_G], PERIOD_US);
+}
+
+static void test_calibration(void) {
+    pwm_calibration_t cal;
+    setup();
+    pwm_calibration_default(&cal);
+    cal.max_duty[0] = 500;
+    // 绿色混入一半红色
+    cal.matrix[0][1] = 2048;
+    pwm_set_calibration(&cal);
+    frame(0xffff, 0, 0);
+    CHECK_INT(host_pwm.duty[CH_R], PERIOD_US / 2);
+    frame(0, 0xffff, 0);
+    CHECK_INT(host_pwm.duty[CH_R], PERIOD_US / 4);
+    CHECK_INT(host_pwm.duty[CH_G], PERIOD_US);
+}
+
+int main(void) {
+    RUN_TEST(test_init);
+    RUN_TEST(test_channel_order);
+    RUN_TEST(test_two_channels);
+    RUN_TEST(test_gamma_lut);
+    RUN_TEST(test_gamma_monotonic);
+    RUN_TEST(test_rgb565);
+    RUN_TEST(test_calibration);
+    RUN_TEST(test_commit_rate);
+    RUN_TEST(test_atomic_frame);
+    return TEST_RESULT();
+}
@@ -0,0 +1,167 @@
+#include "test_host.h"
+#include "user_sched.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void set_tz(const char *tz) {
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+static time_t local_time(int year, int mon, int day, int hour, int min,
+                         int sec) {
+    struct tm tm = {
+        .tm_year = year - 1900,
+        .tm_mon = mon - 1,
+        .tm_mday = day,
+        .tm_hour = hour,
+        .tm_min = min,
+        .tm_sec = sec,
+        .tm_isdst = -1,
+    };
+    return mktime(&tm);
+}
+
+static int parse(const char *s, sched_table_t *t) {
+    return sched_parse(s, strlen(s), t);
+}
+
+static void test_parse(void) {
+    sched_table_t t;
+    CHECK_INT(parse("3e@0700=c#ffc080|7f@2300=e500/000000|41@0900=s2", &t), 3);
+    CHECK_INT(t.rules[0].days, 0x3e);
+    CHECK_INT(t.rules[0].minute, 7 * 60);
+    CHECK_INT(t.rules[0].action, SCHED_ACT_COLOR);
+    CHECK(strcmp(t.rules[0].arg, "#ffc080") == 0);
+    CHECK_INT(t.rules[2].action, SCHED_ACT_SCENE);
+    CHECK(strcmp(t.rules[2].arg, "2") == 0);
+
+    CHECK_INT(parse("0", &t), 0);
+    CHECK_INT(t.count, 0);
+    CHECK_INT(parse("", &t), 0);
+}
+
+static void test_parse_rejects(void) {
+    static const char *const bad[] = {
+        "80@0700=c1",       // 星期超出 7 位
+        "00@0700=c1",       // 没有星期
+        "3e@2460=c1",       // 时刻非法
+        "3e@0700=s4",       // 场景只有 1-3
+        "3e@0700=s12",
+        "3e0700=c1",        // 缺少 '@'
+        "3e@0700=x1",       // 未知动作
+        "3e@0700=c1,ver:9", // 参数不能注入其他键
+        "3e@0700=c\"1",
+        "7f@0100=c1|3e@0700=s9",
+    };
+    sched_table_t t;
+    for (int i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        CHECK_INT(parse(bad[i], &t), -1);
+        CHECK_INT(t.count, 0);
+    }
+    // 最多 SCHED_RULE_NUM 条
+    CHECK_INT(parse("7f@0000=c1|7f@0001=c1|7f@0002=c1|7f@0003=c1|"
+                    "7f@0004=c1|7f@0005=c1|7f@0006=c1|7f@0007=c1|7f@0008=c1",
+                    &t),
+              -1);
+}
+
+static void test_pack_roundtrip(void) {
+    sched_table_t t, u;
+    uint8_t buf[SCHED_BLOB_MAX];
+    CHECK_INT(parse("3e@0700=c#ffc080|7f@2300=e*500/ffc080/3;500/000000", &t), 2);
+    int n = sched_pack(&t, buf, sizeof(buf));
+    CHECK(n > 0);
+    CHECK_INT(sched_unpack(buf, n, &u), 2);
+    CHECK(memcmp(&t, &u, sizeof(t)) == 0);
+
+    // 截断或版本不符整体拒绝
+    CHECK_INT(sched_unpack(buf, n - 1, &u), -1);
+    CHECK_INT(u.count, 0);
+    buf[0] = SCHED_BLOB_VERSION + 1;
+    CHECK_INT(sched_unpack(buf, n, &u), -1);
+    CHECK_INT(sched_pack(&t, buf, 8), -1);
+}
+
+static void test_unpack_rejects(void) {
+    sched_table_t t, u;
+    uint8_t buf[SCHED_BLOB_MAX], bad[SCHED_BLOB_MAX];
+    CHECK_INT(parse("3e@0700=s2", &t), 1);
+    int n = sched_pack(&t, buf, sizeof(buf));
+    CHECK_INT(n, 2 + 5 + 1);
+    CHECK_INT(sched_unpack(buf, n, &u), 1);
+
+    // 损坏的 blob 中的字段与文本规则同样检查：场景、星期、时刻、动作、参数
+    static const struct {
+        int offset;
+        uint8_t value;
+    } corrupt[] = {
+        {7, '4'}, {7, '0'}, {7, '"'}, {2, 0}, {2, 0x80},
+        {4, 0x06}, {4, 0x05}, {5, 'x'},
+    };
+    for (int i = 0; i < sizeof(corrupt) / sizeof(corrupt[0]); i++) {
+        memcpy(bad, buf, n);
+        bad[corrupt[i].offset] = corrupt[i].value;
+        CHECK_INT(sched_unpack(bad, n, &u), -1);
+        CHECK_INT(u.count, 0);
+    }
+    // 参数不能为空
+    memcpy(bad, buf, n);
+    bad[6] = 0;
+    CHECK_INT(sched_unpack(bad, n - 1, &u), -1);
+}
+
+static void test_next(void) {
+    sched_table_t t;
+    uint8_t due;
+    set_tz("CST-8");
+    parse("3e@0700=c#ffc080|7f@2300=c0|41@0900=s2", &t);
+
+    // 2026-10-16 是星期五
+    time_t now = local_time(2026, 10, 16, 22, 59, 30);
+    time_t at = sched_next(&t, now, &due);
+    CHECK_INT(at - now, 30);
+    CHECK_INT(due, 0x02);
+    // 正好在触发时刻时取下一次
+    at = sched_next(&t, at, &due);
+    CHECK_INT(at, local_time(2026, 10, 17, 9, 0, 0));
+    CHECK_INT(due, 0x04);
+
+    // 同一时刻的多条规则一起触发
+    parse("7f@0800=c1|02@0800=s1", &t);
+    at = sched_next(&t, local_time(2026, 10, 19, 7, 0, 0), &due);
+    CHECK_INT(due, 0x03);
+
+    sched_table_t empty = {0};
+    CHECK_INT(sched_next(&empty, now, &due), -1);
+    CHECK_INT(due, 0);
+}
+
+static void test_next_dst(void) {
+    sched_table_t t;
+    uint8_t due;
+    set_tz("CET-1CEST,M3.5.0,M10.5.0/3");
+
+    // 02:30 在 2026-03-29 不存在，顺延到 03:30 CEST
+    parse("7f@0230=c1", &t);
+    time_t now = local_time(2026, 3, 29, 1, 0, 0);
+    time_t at = sched_next(&t, now, &due);
+    CHECK_INT(at - now, 90 * 60);
+
+    // 02:30 在 2026-10-25 出现两次，只触发一次
+    now = local_time(2026, 10, 24, 12, 0, 0);
+    at = sched_next(&t, now, &due);
+    time_t again = sched_next(&t, at, &due);
+    CHECK_INT(again - at, 25 * 3600);
+}
+
+int main(void) {
+    RUN_TEST(test_parse);
+    RUN_TEST(test_parse_rejects);
+    RUN_TEST(test_pack_roundtrip);
+    RUN_TEST(test_unpack_rejects);
+    RUN_TEST(test_next);
+    RUN_TEST(test_next_dst);
+    return TEST_RESULT();
+}
@@ -0,0 +1,195 @@
+#include "test_host.h"
+#include "user_sync_est.h"
+#include <math.h>
+#include <stdlib.h>
+
+// 固定种子的伪随机数，结果与平台无关
+static uint32_t s_seed = 1;
+
+static uint32_t next_rand(void) {
+    s_seed = s_seed * 1103515245u + 12345u;
+    return s_seed >> 8;
+}
+
+#define BEACON_US 102400 // AP 信标间隔 100 TU
+
+enum
+{
+    MODE_IDLE = 0,
+    MODE_SPIKES,
+    MODE_DTIM1,
+    MODE_DTIM3,
+};
+
+// 主节点在 t 时刻发出的组播帧到达跟随者的延迟，微秒。
+// 有节点省电时 AP 把组播帧缓存到下一个 DTIM 信标之后才发，
+// 延迟取决于发送时刻在 DTIM 周期中的相位，而不是随机抖动。
+static double delay_us(int mode, double t) {
+    double period;
+
+    switch (mode) {
+    case MODE_IDLE:
+        return 300 + next_rand() % 2000;
+    case MODE_SPIKES:
+        return 500 + next_rand() % 20000 + (next_rand() % 10 == 0 ? 80000 : 0);
+    case MODE_DTIM1:
+        period = BEACON_US;
+        break;
+    default:
+        period = 3 * BEACON_US;
+        break;
+    }
+    // 主节点到 AP 的上行时延之后等到下一个 DTIM，再加上空口时间
+    double at_ap = t + 300 + next_rand() % 2000;
+    double dtim = ceil(at_ap / period) * period;
+    return dtim - t + next_rand() % 500;
+}
+
+// 共享时钟与主节点时钟之差
+static double leader_error(const sync_est_t *est, double tt, double drift,
+                           double start) {
+    int64_t local = (int64_t)(tt * (1 + drift) + start);
+    return (double)(local + sync_est_offset(est, local)) - tt;
+}
+
+// 两个跟随者接收同一组帧，晶振分别快 35 ppm、慢 40 ppm。
+// 锁定后立即检查一次偏移误差，300 秒收敛后再检查共享时钟。
+// DTIM 缓存延迟下漂移估计有共模偏差，两个跟随者之间仍保持一致
+static void run_followers(int mode, double max_lock_ms, double max_leader_ms,
+                          int max_drift_err) {
+    const double drift[2] = {35e-6, -40e-6};
+    const double start[2] = {123456789.0, -98765432.0};
+    sync_est_t f[2];
+    double max_lock = 0, max_leader = 0, max_pair = 0;
+    int steps = 0;
+
+    s_seed = 1;
+    sync_est_init(&f[0]);
+    sync_est_init(&f[1]);
+    for (int k = 0; k < 1200; k++) {
+        double t = k * 1e6, d = delay_us(mode, t);
+        for (int i = 0; i < 2; i++) {
+            double arrive = t + d + next_rand() % 300;
+            int64_t local = (int64_t)(arrive * (1 + drift[i]) + start[i]);
+            if (sync_est_sample(&f[i], local, (int64_t)t) == SYNC_EST_STEPPED) {
+                steps++;
+                // 刚锁定时只有最少的样本，误差以其中最小的延迟为界
+                max_lock = fmax(max_lock,
+                                fabs(leader_error(&f[i], t, drift[i], start[i])));
+            }
+        }
+        if (k < 300) {
+            continue;
+        }
+        // 两次广播之间检查共享时钟
+        for (int q = 1; q < 10; q++) {
+            double tt = t + q * 1e5, err[2];
+            for (int i = 0; i < 2; i++) {
+                err[i] = leader_error(&f[i], tt, drift[i], start[i]);
+                max_leader = fmax(max_leader, fabs(err[i]));
+            }
+            max_pair = fmax(max_pair, fabs(err[0] - err[1]));
+        }
+    }
+    printf("mode %d: lock %.2f ms, leader %.2f ms, pair %.2f ms, "
+           "drift %d/%d ppb\n",
+           mode, max_lock / 1000, max_leader / 1000, max_pair / 1000,
+           f[0].drift_ppb, f[1].drift_ppb);
+    // 每个跟随者只在首次锁定时跳变一次
+    CHECK_INT(steps, 2);
+    CHECK(max_pair < 1000);
+    CHECK(max_lock < max_lock_ms * 1000);
+    CHECK(max_leader < max_leader_ms * 1000);
+    CHECK(abs(f[0].drift_ppb + 35000) < max_drift_err);
+    CHECK(abs(f[1].drift_ppb - 40000) < max_drift_err);
+}
+
+static void test_low_jitter(void) {
+    run_followers(MODE_IDLE, 5, 2, 5000);
+}
+
+static void test_wifi_spikes(void) {
+    run_followers(MODE_SPIKES, 25, 10, 10000);
+}
+
+static void test_dtim1(void) {
+    run_followers(MODE_DTIM1, 110, 25, 30000);
+}
+
+// DTIM 周期 307.2 ms 时每 4 次广播相位只前进 6.4 ms，32 个样本的包络
+// 窗口里不一定有低延迟的样本，包络按约 190 秒的锯齿变化，漂移估计随之偏离。
+// 偏差是共模的，而且漂移只用于广播之间的外推，两个跟随者之间仍然一致
+static void test_dtim3(void) {
+    run_followers(MODE_DTIM3, 110, 50, 80000);
+}
+
+static void test_leader_step(void) {
+    sync_est_t e;
+    int steps = 0;
+    sync_est_init(&e);
+    // 单个延迟尖峰不应造成跳变
+    for (int k = 0; k < 40; k++) {
+        int64_t t = k * 1000000LL;
+        if (sync_est_sample(&e, t, t + 5000000 - (k == 20 ? 90000 : 0)) ==
+            SYNC_EST_STEPPED) {
+            steps++;
+        }
+    }
+    CHECK_INT(steps, 1);
+    // 主节点时钟向前跳 4 秒
+    for (int k = 40; k < 60; k++) {
+        int64_t t = k * 1000000LL;
+        if (sync_est_sample(&e, t, t + 9000000) == SYNC_EST_STEPPED) {
+            steps++;
+        }
+    }
+    CHECK_INT(steps, 2);
+    CHECK(llabs(sync_est_offset(&e, 60000000) - 9000000) < 1000);
+}
+
+static void test_election(void) {
+    sync_elect_t a, b, c;
+    sync_elect_t *nodes[3] = {&a, &b, &c};
+    sync_elect_init(&a, 5, 0);
+    sync_elect_init(&b, 3, 1500000);
+    sync_elect_init(&c, 9, 0);
+
+    for (int64_t now = 0; now < 20000000; now += 100000) {
+        int online = now < 12000000 ? 3 : 2;
+        if (now == 12000000) {
+            nodes[1] = &c; // b 离线
+        }
+        for (int i = 0; i < online; i++) {
+            sync_elect_tick(nodes[i], now);
+        }
+        if (now % 1000000 == 0) {
+            for (int i = 0; i < online; i++) {
+                if (nodes[i]->role != SYNC_ROLE_LEADER) {
+                    continue;
+                }
+                for (int j = 0; j < online; j++) {
+                    sync_elect_on_beacon(nodes[j], nodes[i]->self_id, now);
+                }
+            }
+        }
+        if (now == 10000000) {
+            // ID 最小的节点成为主节点
+            CHECK_INT(b.role, SYNC_ROLE_LEADER);
+            CHECK_INT(a.role, SYNC_ROLE_FOLLOWER);
+            CHECK_INT(c.role, SYNC_ROLE_FOLLOWER);
+        }
+    }
+    CHECK_INT(a.role, SYNC_ROLE_LEADER);
+    CHECK_INT(c.role, SYNC_ROLE_FOLLOWER);
+    CHECK_INT(c.leader_id, 5);
+}
+
+int main(void) {
+    RUN_TEST(test_low_jitter);
+    RUN_TEST(test_wifi_spikes);
+    RUN_TEST(test_dtim1);
+    RUN_TEST(test_dtim3);
+    RUN_TEST(test_leader_step);
+    RUN_TEST(test_election);
+    return TEST_RESULT();
+}
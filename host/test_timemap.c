@@ -0,0 +1,65 @@
+#include "test_host.h"
+#include "user_timemap.h"
+#include <stdlib.h>
+
+#define HOUR_US (3600LL * 1000000)
+#define WALL0_US (1700000000LL * 1000000)
+
+// 墙上时间比单调时钟快 37 ppm
+static int64_t true_wall(int64_t mono_us) {
+    return WALL0_US + (int64_t)((mono_us - 5000000) * (1 + 37e-6));
+}
+
+static void test_unsynced(void) {
+    timemap_t map;
+    timemap_init(&map);
+    CHECK_INT(map.valid, 0);
+}
+
+static void test_drift(void) {
+    timemap_t map;
+    timemap_init(&map);
+
+    int64_t mono = 5000000;
+    CHECK_INT(timemap_sync(&map, mono, true_wall(mono)), 1);
+    CHECK_INT(timemap_wall(&map, mono), true_wall(mono));
+    CHECK_INT(map.drift_valid, 0);
+
+    for (int k = 1; k < 6; k++) {
+        mono = 5000000 + k * HOUR_US;
+        CHECK_INT(timemap_sync(&map, mono, true_wall(mono)), 0);
+        CHECK(map.drift_valid);
+        CHECK(abs(map.drift_ppb - 37000) < 100);
+        // 两次对时之间按漂移外推
+        int64_t probe = mono + HOUR_US / 2;
+        CHECK(llabs(timemap_wall(&map, probe) - true_wall(probe)) < 1000);
+    }
+}
+
+static void test_short_baseline(void) {
+    timemap_t map;
+    timemap_init(&map);
+    timemap_sync(&map, 0, WALL0_US);
+    // 间隔太短的样本不用于估计漂移
+    timemap_sync(&map, 60 * 1000000LL, WALL0_US + 60 * 1000000LL + 5000);
+    CHECK_INT(map.drift_valid, 0);
+}
+
+static void test_step(void) {
+    timemap_t map;
+    timemap_init(&map);
+    timemap_sync(&map, 5000000, true_wall(5000000));
+    timemap_sync(&map, 5000000 + HOUR_US, true_wall(5000000 + HOUR_US));
+    // 时间被调整 100 小时，按跳变处理，重新开始估计漂移
+    int64_t mono = 5000000 + 2 * HOUR_US;
+    CHECK_INT(timemap_sync(&map, mono, true_wall(mono) + 100 * HOUR_US), 1);
+    CHECK_INT(timemap_wall(&map, mono), true_wall(mono) + 100 * HOUR_US);
+}
+
+int main(void) {
+    RUN_TEST(test_unsynced);
+    RUN_TEST(test_drift);
+    RUN_TEST(test_short_baseline);
+    RUN_TEST(test_step);
+    return TEST_RESULT();
+}
@@ -0,0 +1,90 @@
+#include "test_host.h"
+#include "user_mqtt.h"
+#include "user_topic.h"
+#include <string.h>
+
+static int match(const char *filter, const char *topic) {
+    return topic_match(filter, topic, strlen(topic));
+}
+
+static void handler_a(esp_mqtt_event_handle_t event) {
+}
+
+static void handler_b(esp_mqtt_event_handle_t event) {
+}
+
+static void test_match(void) {
+    CHECK(match("roomlight/dev/abc/ctrl", "roomlight/dev/abc/ctrl"));
+    CHECK(!match("roomlight/dev/abc/ctrl", "roomlight/dev/abcd/ctrl"));
+    CHECK(!match("roomlight/dev/abc/ctrl", "roomlight/dev/abc"));
+    CHECK(match("roomlight/+/+/ctrl", "roomlight/room/1/ctrl"));
+    CHECK(!match("roomlight/+/+/ctrl", "roomlight/room/1/get"));
+    CHECK(match("roomlight/#", "roomlight/a/b/c"));
+    CHECK(match("roomlight/#", "roomlight"));
+    CHECK(!match("roomlight/#x", "roomlight/a"));
+    CHECK(match("+", "abc"));
+    CHECK(!match("+", "a/b"));
+}
+
+static void test_match_length(void) {
+    // 事件中的主题不以 '\0' 结尾
+    const char topic[] = "roomlight/dev/abc/ctrlXYZ";
+    CHECK(topic_match("roomlight/dev/abc/ctrl", topic, 22));
+    CHECK(!topic_match("roomlight/dev/abc/ctrl", topic, 21));
+}
+
+static void test_build(void) {
+    char buf[TOPIC_SIZE];
+    CHECK_INT(topic_build(buf, sizeof(buf), TOPIC_SCOPE_ROOM, "kitchen", "ctrl"),
+              strlen("roomlight/room/kitchen/ctrl"));
+    CHECK(strcmp(buf, "roomlight/room/kitchen/ctrl") == 0);
+    CHECK_INT(topic_build(buf, sizeof(buf), TOPIC_SCOPE_ROOM, "", "ctrl"), -1);
+    CHECK_INT(topic_build(buf, sizeof(buf), TOPIC_SCOPE_USER, "default", "ctrl"), -1);
+    CHECK_INT(topic_build(buf, sizeof(buf), TOPIC_SCOPE_USER, "a/b", "ctrl"), -1);
+    CHECK_INT(topic_build(buf, sizeof(buf), TOPIC_SCOPE_USER, "a+", "ctrl"), -1);
+    CHECK_INT(topic_build(buf, 16, TOPIC_SCOPE_DEVICE, "0123456789", "ctrl"), -1);
+}
+
+static void test_routes(void) {
+    const char *topic = "roomlight/dev/abc/get";
+    topic_route_clear();
+    CHECK_INT(topic_route_add("roomlight/dev/abc/get", handler_a), ESP_OK);
+    CHECK_INT(topic_route_add("roomlight/dev/+/get", handler_b), ESP_OK);
+    // 先添加的路由优先
+    CHECK(topic_route_find(topic, strlen(topic)) == handler_a);
+    topic = "roomlight/dev/xyz/get";
+    CHECK(topic_route_find(topic, strlen(topic)) == handler_b);
+    topic = "roomlight/room/xyz/get";
+    CHECK(topic_route_find(topic, strlen(topic)) == NULL);
+
+    for (int i = 2; i < TOPIC_ROUTE_NUM; i++) {
+        CHECK_INT(topic_route_add("x", handler_a), ESP_OK);
+    }
+    CHECK_INT(topic_route_add("x", handler_a), ESP_ERR_NO_MEM);
+    topic_route_clear();
+    CHECK(topic_route_find("x", 1) == NULL);
+}
+
+// 旧版控制主题不在设备主题层级下，需要单独订阅和路由
+static void test_legacy_ctrl(void) {
+    char filter[TOPIC_SIZE];
+    const char *topic = MQTT_SubscribeTopic;
+    topic_build(filter, sizeof(filter), TOPIC_SCOPE_DEVICE, "0123456789ab", "#");
+    CHECK(!match(filter, topic));
+    CHECK(!match("roomlight/+/+/ctrl", topic));
+
+    topic_route_clear();
+    CHECK_INT(topic_route_add("roomlight/dev/0123456789ab/get", handler_b), ESP_OK);
+    CHECK_INT(topic_route_add(MQTT_SubscribeTopic, handler_a), ESP_OK);
+    CHECK(topic_route_find(topic, strlen(topic)) == handler_a);
+    topic_route_clear();
+}
+
+int main(void) {
+    RUN_TEST(test_match);
+    RUN_TEST(test_match_length);
+    RUN_TEST(test_build);
+    RUN_TEST(test_routes);
+    RUN_TEST(test_legacy_ctrl);
+    return TEST_RESULT();
+}
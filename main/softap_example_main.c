@@ -1,178 +1,190 @@
+#include <limits.h>
 #include <string.h>
 #include "esp_event.h"
 #include "esp_log.h"
-#include "esp_sntp.h"
+#include "esp_spi_flash.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "nvs_flash.h"
+#include "user_alarm.h"
+#include "user_cmd.h"
+#include "user_config.h"
+#include "user_effect.h"
 #include "user_gpio.h"
+#include "user_lan.h"
 #include "user_mqtt.h"
+#include "user_net.h"
 #include "user_nvs.h"
 #include "user_ota.h"
+#include "user_publish.h"
+#include "user_prof.h"
 #include "user_pwm.h"
 #include "user_softap.h"
+#include "user_sync.h"
 #include "user_test.h"
+#include "user_time.h"
 #include "user_wifi.h"
 
 #define TAG "main"
 
 uint32_t io_pins[] = {12, 13, 14};
 
-void obtain_time(void) {
-    ESP_LOGI(TAG, "Initializing SNTP");
-    sntp_setoperatingmode(SNTP_OPMODE_POLL);
-    sntp_setservername(0, "pool.ntp.org");
-    sntp_init();
-
-    // Wait for time to be set
-    time_t now = 0;
-    struct tm timeinfo = {0};
-    int retry = 0;
-    const int retry_count = 10;
-    while (sntp_get_sync_status() == SNTP_SYNC_STATUS_RESET &&
-           ++retry < retry_count) {
-        ESP_LOGI(TAG, "Waiting for system time to be set... (%d/%d)", retry, retry_count);
-        vTaskDelay(2000 / portTICK_PERIOD_MS);
+#define STATUS_BLINK_MS 700
+
+static const uint16_t status_colors[] = {
+    [DEV_SOFTAP] = 0xf800,          // 红色
+    [DEV_STA_CONNECTING] = 0x07e0,  // 绿色
+    [DEV_MQTT_CONNECTING] = 0x001f, // 蓝色
+};
+
+// 根据进入当前状态以来的时间计算颜色，返回距离下一次切换的毫秒数，0 表示静止。
+// lightPeriod 交替按房间共享时钟计算相位，同一房间的灯同时切换。
+static uint32_t render_color(dev_state_t state, uint32_t elapsed_ms,
+                             uint32_t shared_ms, effect_rgb_t *color) {
+    uint32_t half;
+
+    switch (state) {
+    case DEV_SOFTAP:
+    case DEV_STA_CONNECTING:
+    case DEV_MQTT_CONNECTING:
+        half = STATUS_BLINK_MS;
+        *color = effect_rgb_from565(
+            ((elapsed_ms / half) & 1) ? 0x0000 : status_colors[state]);
+        return half - elapsed_ms % half;
+    case DEV_MQTT_CONNECTED:
+        if (light_config.lightPeriod >= 500) {
+            half = light_config.lightPeriod;
+            *color = ((shared_ms / half) & 1) ? light_config.lightSwitch2
+                                              : light_config.lightSwitch1;
+            return half - shared_ms % half;
+        }
+        *color = light_config.lightNormal;
+        return 0;
+    default:
+        ESP_LOGE(TAG, "Unhandled device state");
+        *color = effect_rgb_from565(0x0000);
+        return 0;
     }
-
-    time(&now);
-    localtime_r(&now, &timeinfo);
-
-    // 设置时区为东八区
-    setenv("TZ", "CST-8", 1);
-    tzset();
-
-    // 更新本地时间
-    localtime_r(&now, &timeinfo);
-
-    // Print the time to check if it's correct
-    ESP_LOGI(TAG, "Current date/time: %s", asctime(&timeinfo));
-
-    char time_str[64];
-    sprintf(time_str, "%s:%d", NVS_TimeStamp, (int)now);
-    nvs_write_data_to_flash(time_str);
-    ESP_LOGI(TAG, "Time stamp: %s", time_str);
 }
 
+// 由配置/状态通知驱动，状态指示闪烁以进入状态的时刻为基准，
+// 灯效和 lightPeriod 交替以房间共享时钟为基准，新命令不打断相位
 void pwm_update_task(void *pvParameters) {
-    static int lightness, period;
+    static effect_engine_t effect;
+    static effect_timeline_t timeline;
+    dev_state_t last_state = (dev_state_t)-1;
+    uint32_t epoch_ms = 0;
+    uint32_t notify = 0;
+
+    effect_init(&effect, effect_rgb_from565(0x0000));
+    config_subscribe(xTaskGetCurrentTaskHandle());
     while (1) {
-        switch (dev_state) {
-        case DEV_SOFTAP:
-            ESP_LOGI(TAG, "Device in SoftAP mode: Flashing red");
-            set_rgb_color(0xf800);
-            vTaskDelay(pdMS_TO_TICKS(700));
-            set_rgb_color(0x0000);
-            vTaskDelay(pdMS_TO_TICKS(700));
-            break;
-        case DEV_STA_CONNECTING:
-            ESP_LOGI(TAG, "Device connecting to WiFi: Flashing green");
-            set_rgb_color(0x07e0);
-            vTaskDelay(pdMS_TO_TICKS(700));
-            set_rgb_color(0x0000);
-            vTaskDelay(pdMS_TO_TICKS(700));
-            break;
-        case DEV_MQTT_CONNECTING:
-            ESP_LOGI(TAG, "Device connecting to MQTT: Flashing blue");
-            set_rgb_color(0x001f);
-            vTaskDelay(pdMS_TO_TICKS(700));
-            set_rgb_color(0x0000);
-            vTaskDelay(pdMS_TO_TICKS(700));
-            break;
-        case DEV_MQTT_CONNECTED:
-            ESP_LOGI(TAG, "MQTT Connected: Adjusting light brightness and period");
-            period = atoi(nvs_data.lightPeriod);
-            if (period >= 500) {
-                lightness = atoi(nvs_data.lightSwitch1);
-                set_rgb_color(lightness);
-                vTaskDelay(pdMS_TO_TICKS(period)); // 延时 period 毫秒
-                lightness = atoi(nvs_data.lightSwitch2);
-                set_rgb_color(lightness);
-                vTaskDelay(pdMS_TO_TICKS(period)); // 延时 period 毫秒
+        uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+        uint32_t shared_ms = sync_now_ms();
+        dev_state_t state = dev_state;
+        if (state != last_state) {
+            ESP_LOGI(TAG, "Render state %d -> %d", last_state, state);
+            last_state = state;
+            epoch_ms = now_ms;
+        }
+
+        // 普通灯光命令结束当前效果，新效果从当前颜色开始过渡
+        if (notify & CONFIG_NOTIFY_LIGHT) {
+            effect_stop(&effect);
+        }
+        if (notify & CONFIG_NOTIFY_CAL) {
+            pwm_calibration_t cal;
+            config_get_calibration(&cal);
+            pwm_set_calibration(&cal);
+        }
+        // 共享时钟跳变时平移正在运行的灯效，保持已播放的进度
+        if (notify & CONFIG_NOTIFY_SYNC) {
+            effect.start_ms += sync_take_step_ms();
+        }
+        if (notify & CONFIG_NOTIFY_EFFECT) {
+            if (config_get_effect(&timeline) > 0) {
+                effect_start(&effect, &timeline, sync_align_ms(shared_ms));
             } else {
-                lightness = atoi(nvs_data.lightNormal);
-                set_rgb_color(lightness);
-                vTaskDelay(pdMS_TO_TICKS(500)); // 延时 500 毫秒
+                effect_stop(&effect);
             }
-            break;
-        default:
-            ESP_LOGE(TAG, "Unhandled device state");
-            break;
         }
+
+        effect_rgb_t color;
+        uint32_t wait_ms;
+        if (state == DEV_MQTT_CONNECTED && effect.state != EFFECT_IDLE) {
+            wait_ms = effect_render(&effect, shared_ms, &color);
+        } else {
+            wait_ms = render_color(state, now_ms - epoch_ms, shared_ms, &color);
+            effect.current = color;
+        }
+        set_rgb48(color.r, color.g, color.b);
+
+        uint32_t pending_ms = pwm_frame_pending_ms();
+        if (pending_ms && (wait_ms == 0 || pending_ms < wait_ms)) {
+            wait_ms = pending_ms;
+        }
+
+        TickType_t wait = portMAX_DELAY;
+        if (wait_ms) {
+            wait = (wait_ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+        }
+        notify = 0;
+        xTaskNotifyWait(0, ULONG_MAX, &notify, wait);
+        prof_wakeup(PROF_TASK_RENDER);
     }
 }
 
-void netState_check_task(void *pvParameters) {
-    static dev_state_t last_state = DEV_SOFTAP;
-    static int timeout_count, i;
+// 联网状态机的动作，在 net_state 任务中执行
+static void net_start_ap(void) {
+    wifiSwitch(WIFI_MODE_AP);
+}
+
+static void net_start_sta(void) {
+    wifiSwitch(WIFI_MODE_STA);
+}
+
+static void net_start_mqtt(void) {
     static int mqtt_init_flag = 0;
 
+    ESP_LOGI(TAG, "New IP acquired, initializing MQTT");
+    // 对时在后台进行，不阻塞 MQTT 启动
+    time_start();
+    // 之后的断线重连由 MQTT 客户端自己完成
+    if (!mqtt_init_flag) {
+        mqtt_init_flag = true;
+        mqtt_app_start();
+    }
+    lan_start();
+    sync_start();
+}
+
+static const net_actions_t net_actions = {
+    .start_ap = net_start_ap,
+    .start_sta = net_start_sta,
+    .retry_sta = wifi_reconnect,
+    .start_mqtt = net_start_mqtt,
+};
+
+static int net_provisioned(void) {
     if (strcmp(nvs_data.ssid, "default") == 0 ||
         strcmp(nvs_data.pass, "default") == 0 ||
         strcmp(nvs_data.roomID, "default") == 0 ||
         strcmp(nvs_data.userID, "default") == 0) {
         ESP_LOGW(TAG, "Default network settings found, switching to SoftAP mode");
-        wifiSwitch(WIFI_MODE_AP);
-        // Delete task
-        vTaskDelete(NULL);
-    }
-
-    wifiSwitch(WIFI_MODE_STA);
-
-    while (1) {
-        if (last_state != dev_state || user_softap_state.newDeviceConnect ||
-            user_softap_state.newDeviceBindTCP) {
-            last_state = dev_state;
-            user_softap_state.newDeviceConnect = false;
-            user_softap_state.newDeviceBindTCP = false;
-            timeout_count = 0;
-            ESP_LOGI(TAG, "State change detected, resetting timeout");
-        } else {
-            timeout_count++;
-        }
-
-        if (dev_state == DEV_STA_CONNECTING && user_wifi_state.getNewIP == true) {
-            user_wifi_state.getNewIP = false;
-            ESP_LOGI(TAG, "New IP acquired, obtaining time and initializing MQTT");
-            if (strcmp(nvs_data.timeStamp, "default") == 0) {
-                obtain_time();
-            }
-            if (!mqtt_init_flag) {
-                mqtt_init_flag = true;
-                mqtt_app_start();
-            }
-        }
-
-        switch (dev_state) {
-        case DEV_SOFTAP:
-            if (timeout_count > 200)
-                wifiSwitch(WIFI_MODE_STA);
-            break;
-        case DEV_STA_CONNECTING:
-            if (timeout_count > 60)
-                wifiSwitch(WIFI_MODE_AP);
-            break;
-        case DEV_MQTT_CONNECTING:
-            if (timeout_count > 30)
-                esp_restart();
-            break;
-        case DEV_MQTT_CONNECTED:
-            break;
-        default:
-            ESP_LOGE(TAG, "Error state detected");
-            break;
-        }
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        return 0;
     }
+    return 1;
 }
 
 void app_main() {
+    prof_mark(PROF_BOOT);
     ESP_LOGI(TAG, "Starting application");
     size_t flash_size = spi_flash_get_chip_size();
-    ESP_LOGI(TAG, "Flash size: %d bytes", flash_size);
+    ESP_LOGI(TAG, "Flash size: %u bytes", (unsigned)flash_size);
 
+    publish_init();
     gpio_init();
     uint32_t duty_cycle[] = {0, 0, 0};
     init_pwm(io_pins, 3, 1000, duty_cycle);
@@ -180,7 +192,10 @@ void app_main() {
 
     init_nvs();
     nvs_read_data_from_flash();
+    prof_mark(PROF_NVS_READY);
+    cmd_queue_init();
+    alarm_start();
 
     user_wifi_init();
-    xTaskCreate(netState_check_task, "Net State Check Task", 2048, NULL, 10, NULL);
+    net_start(&net_actions, net_provisioned());
 }